@@ -0,0 +1,50 @@
+#include "enum.h"
+#include "file.h"
+#include "printer.h"
+
+using namespace KODE;
+
+// Prints enums.h with string conversions, which tst_enum compiles and checks.
+
+static Enum conversionEnum(const QString &name, const QStringList &values,
+                           const QStringList &strings = QStringList(), bool combinable = false)
+{
+    Enum e(name, values, combinable);
+    e.setStringConversion();
+    e.setStringValues(strings);
+    return e;
+}
+
+int main(int argc, char **argv)
+{
+    if (argc != 2) {
+        qWarning("Usage: %s <output directory>", argv[0]);
+        return 1;
+    }
+
+    Class holder(QStringLiteral("EnumHolder"));
+    holder.addEnum(conversionEnum(
+            QStringLiteral("Color"),
+            { QStringLiteral("Red"), QStringLiteral("Green"), QStringLiteral("Blue"),
+              QStringLiteral("Tan") },
+            { QStringLiteral("red"), QStringLiteral("green"), QStringLiteral("blue"),
+              QStringLiteral("tan") }));
+    // The name of the string table of Color used to be ColorNames
+    holder.addEnum(conversionEnum(QStringLiteral("ColorNames"),
+                                  { QStringLiteral("Short"), QStringLiteral("Long") }));
+    holder.addEnum(conversionEnum(
+            QStringLiteral("Permission"),
+            { QStringLiteral("Read"), QStringLiteral("Write"), QStringLiteral("Execute") },
+            QStringList(), true));
+
+    File file;
+    file.setFilename(QStringLiteral("enums"));
+    file.addFileEnum(conversionEnum(QStringLiteral("Level"),
+                                    { QStringLiteral("Low"), QStringLiteral("High") }));
+    file.insertClass(holder);
+
+    Printer printer;
+    printer.setOutputDirectory(QString::fromLocal8Bit(argv[1]));
+    printer.printHeader(file);
+    return 0;
+}
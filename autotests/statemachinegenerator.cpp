@@ -0,0 +1,67 @@
+#include "teststatemachine.h"
+
+#include <QFile>
+
+using namespace KODE;
+
+// Prints the test machine in every emission mode as a struct with a run()
+// function, which tst_statemachine compiles and benchmarks.
+
+static Code machineStruct(const QString &name, StateMachine::EmissionMode mode)
+{
+    const StateMachine machine = createTestMachine(mode);
+
+    Code code;
+    code += QLatin1String("struct ") + name;
+    code += QLatin1Char('{');
+    code.indent();
+    if (mode == StateMachine::SwitchEmission)
+        code += QLatin1String("enum Event { Open, Text, Close };");
+    code.addBlock(machine.stateDefinition());
+    if (mode != StateMachine::SwitchEmission)
+        code.addBlock(machine.transitionTable());
+    code.newLine();
+    code += QLatin1String("void run(const QVector<int> &events, int *counts)");
+    code += QLatin1Char('{');
+    code.indent();
+    code += QLatin1String("for (const int event : events) {");
+    code.indent();
+    code.addBlock(machine.transitionLogic());
+    if (mode != StateMachine::SwitchEmission)
+        code.addBlock(machine.transition(QStringLiteral("static_cast<Event>(event)")));
+    code.unindent();
+    code += QLatin1Char('}');
+    code.unindent();
+    code += QLatin1Char('}');
+    code.unindent();
+    code += QLatin1String("};");
+    code.newLine();
+    return code;
+}
+
+int main(int argc, char **argv)
+{
+    if (argc != 2) {
+        qWarning("Usage: %s <output header>", argv[0]);
+        return 1;
+    }
+
+    Code code;
+    code += QLatin1String("// Generated by statemachinegenerator, do not edit");
+    code += QLatin1String("#pragma once");
+    code.newLine();
+    code += QLatin1String("#include <QVector>");
+    code.newLine();
+    code.addBlock(machineStruct(QStringLiteral("SwitchMachine"), StateMachine::SwitchEmission));
+    code.addBlock(machineStruct(QStringLiteral("TableMachine"), StateMachine::TableEmission));
+    code.addBlock(
+            machineStruct(QStringLiteral("DispatchMachine"), StateMachine::DispatchEmission));
+
+    QFile file(QString::fromLocal8Bit(argv[1]));
+    if (!file.open(QIODevice::WriteOnly)) {
+        qWarning("Can't open '%s' for writing.", argv[1]);
+        return 1;
+    }
+    file.write(code.text().toUtf8());
+    return 0;
+}
@@ -0,0 +1,53 @@
+#ifndef TESTSTATEMACHINE_H
+#define TESTSTATEMACHINE_H
+
+#include "statemachine.h"
+
+/**
+ * The state machine of tst_statemachine, counting the events seen in each state.
+ * The switch mode has no transition table, so there the state code takes the
+ * transitions itself, with the events of an enum Event declared next to it.
+ */
+inline KODE::StateMachine createTestMachine(KODE::StateMachine::EmissionMode mode)
+{
+    using KODE::Code;
+    using KODE::StateMachine;
+
+    const bool switchEmission = mode == StateMachine::SwitchEmission;
+    auto state = [&](const QString &count, const QString &transition) {
+        Code code;
+        code += QStringLiteral("++counts[%1];").arg(count);
+        if (switchEmission)
+            code += transition;
+        return code;
+    };
+
+    StateMachine machine;
+    machine.setEmissionMode(mode);
+    machine.setHandlerArguments(QStringLiteral("int *counts"), QStringLiteral("counts"));
+    machine.setState(
+            QStringLiteral("Content"),
+            state(QStringLiteral("0"),
+                  QStringLiteral("state = event == Open ? Element : (event == Close ? Idle : "
+                                 "Content);")));
+    machine.setState(QStringLiteral("Element"),
+                     state(QStringLiteral("1"),
+                           QStringLiteral("state = event == Open ? Element : Content;")));
+    machine.setState(QStringLiteral("Idle"),
+                     state(QStringLiteral("2"),
+                           QStringLiteral("state = event == Open ? Element : Idle;")));
+    machine.setInitialState(QStringLiteral("Idle"));
+    machine.addTransition(QStringLiteral("Content"), QStringLiteral("Open"),
+                          QStringLiteral("Element"));
+    machine.addTransition(QStringLiteral("Element"), QStringLiteral("Text"),
+                          QStringLiteral("Content"));
+    machine.addTransition(QStringLiteral("Element"), QStringLiteral("Close"),
+                          QStringLiteral("Content"));
+    machine.addTransition(QStringLiteral("Content"), QStringLiteral("Close"),
+                          QStringLiteral("Idle"));
+    machine.addTransition(QStringLiteral("Idle"), QStringLiteral("Open"),
+                          QStringLiteral("Element"));
+    return machine;
+}
+
+#endif
@@ -0,0 +1,132 @@
+#include "arena.h"
+#include "element.h"
+#include "parser.h"
+
+#include <QTest>
+#include <QThread>
+
+#include <common/messagehandler.h>
+#include <common/nsmanager.h>
+#include <common/parsercontext.h>
+
+#include <memory>
+
+using namespace XSD;
+
+class ArenaTest : public QObject
+{
+    Q_OBJECT
+private Q_SLOTS:
+    void allocation();
+    void parserRetention();
+};
+
+// Destroys an element in a thread of its own
+class DestroyingThread : public QThread
+{
+public:
+    explicit DestroyingThread(std::unique_ptr<Element> *element) : mElement(element) {}
+    void run() override { mElement->reset(); }
+
+private:
+    std::unique_ptr<Element> *mElement;
+};
+
+void ArenaTest::allocation()
+{
+    std::unique_ptr<Element> copy;
+    {
+        Arena arena;
+        {
+            Arena::Scope scope(&arena);
+            Element element("ns");
+            element.setName("value");
+            QVERIFY(arena.liveObjectCount() > 0);
+            QVERIFY(arena.allocatedBytes() > 0);
+            const int liveObjects = arena.liveObjectCount();
+            copy.reset(new Element(element));
+            QVERIFY(arena.liveObjectCount() > liveObjects);
+        }
+        QVERIFY(arena.liveObjectCount() > 0);
+
+        // Objects deleted while the arena is active are reused
+        {
+            Arena::Scope scope(&arena);
+            const qint64 allocatedBytes = arena.allocatedBytes();
+            const int liveObjects = arena.liveObjectCount();
+            for (int i = 0; i < 10000; ++i) {
+                Element temporary(*copy);
+                temporary.setName("temporary");
+            }
+            QCOMPARE(arena.allocatedBytes(), allocatedBytes);
+            QCOMPARE(arena.liveObjectCount(), liveObjects);
+        }
+
+        // Outside of the scope the heap is used
+        const int liveObjects = arena.liveObjectCount();
+        Element heapElement(*copy);
+        QCOMPARE(arena.liveObjectCount(), liveObjects);
+    }
+    // The arena handle is gone, its blocks are kept until the copy is destroyed,
+    // which may happen in another thread
+    QCOMPARE(copy->name(), QString("value"));
+    DestroyingThread thread(&copy);
+    thread.start();
+    QVERIFY(thread.wait());
+    QVERIFY(!copy);
+}
+
+static const char schema[] = "<xs:schema xmlns:xs=\"http://www.w3.org/2001/XMLSchema\""
+                             " xmlns:tns=\"urn:test\" targetNamespace=\"urn:test\">"
+                             "  <xs:element name=\"root\" type=\"tns:RootType\"/>"
+                             "  <xs:complexType name=\"RootType\">"
+                             "    <xs:sequence>"
+                             "      <xs:element ref=\"tns:item\"/>"
+                             "    </xs:sequence>"
+                             "    <xs:attribute name=\"code\" type=\"tns:Code\"/>"
+                             "  </xs:complexType>"
+                             "  <xs:element name=\"item\" type=\"xs:string\"/>"
+                             "  <xs:simpleType name=\"Code\">"
+                             "    <xs:restriction base=\"xs:string\"/>"
+                             "  </xs:simpleType>"
+                             "</xs:schema>";
+
+void ArenaTest::parserRetention()
+{
+    NSManager namespaceManager;
+    MessageHandler messageHandler;
+    ParserContext context;
+    context.setNamespaceManager(&namespaceManager);
+    context.setMessageHandler(&messageHandler);
+
+    Parser parser;
+    parser.setUseArena(true);
+    QVERIFY(parser.parseString(&context, QByteArray(schema)));
+    const Arena arena = parser.arena();
+    const int liveObjects = arena.liveObjectCount();
+    const qint64 allocatedBytes = arena.allocatedBytes();
+    QVERIFY(liveObjects > 0);
+    qDebug() << "The arena holds" << liveObjects << "objects in" << allocatedBytes << "bytes";
+
+    // Copies handed out by the parser and the model use the heap
+    for (int i = 0; i < 10; ++i) {
+        const Types types = parser.types();
+        const ComplexType rootType = types.complexType(QName("urn:test", "RootType"));
+        QCOMPARE(rootType.elements().count(), 1);
+        QVERIFY(!types.simpleType(QName("urn:test", "Code")).isNull());
+    }
+    QCOMPARE(arena.liveObjectCount(), liveObjects);
+    QCOMPARE(arena.allocatedBytes(), allocatedBytes);
+
+    // Resolving again replaces the complex types, in the memory of the old ones
+    QVERIFY(parser.resolveForwardDeclarations());
+    QCOMPARE(arena.liveObjectCount(), liveObjects);
+    QCOMPARE(arena.allocatedBytes(), allocatedBytes);
+
+    // Clearing the parser releases the objects of its arena
+    parser.clear();
+    QCOMPARE(arena.liveObjectCount(), 0);
+}
+
+QTEST_MAIN(ArenaTest)
+#include "tst_arena.moc"
@@ -0,0 +1,180 @@
+#include "builtintypes.h"
+
+#include <QTest>
+
+#include <limits>
+
+using namespace XSD;
+
+Q_DECLARE_METATYPE(XSD::BuiltinTypes::Type)
+
+class BuiltinTypesTest : public QObject
+{
+    Q_OBJECT
+private Q_SLOTS:
+    void lexicalSpace_data();
+    void lexicalSpace();
+    void conversions();
+    void benchmark_data();
+    void benchmark();
+};
+
+void BuiltinTypesTest::lexicalSpace_data()
+{
+    QTest::addColumn<BuiltinTypes::Type>("type");
+    QTest::addColumn<QString>("value");
+    QTest::addColumn<bool>("valid");
+
+    // Values longer than 16 characters go through the vectorized loops
+    QTest::newRow("int") << BuiltinTypes::Int << "-2147483648" << true;
+    QTest::newRow("int overflow") << BuiltinTypes::Int << "2147483648" << false;
+    QTest::newRow("int letters") << BuiltinTypes::Int << "12a" << false;
+    QTest::newRow("integer long") << BuiltinTypes::Integer << "123456789012345678901234567890"
+                                  << true;
+    QTest::newRow("integer long invalid")
+            << BuiltinTypes::Integer << "12345678901234567890123456789x" << false;
+    QTest::newRow("long max") << BuiltinTypes::Long << "9223372036854775807" << true;
+    QTest::newRow("long overflow") << BuiltinTypes::Long << "9223372036854775808" << false;
+    QTest::newRow("unsignedLong -0") << BuiltinTypes::UnsignedLong << "-0" << true;
+    QTest::newRow("unsignedLong -1") << BuiltinTypes::UnsignedLong << "-1" << false;
+    QTest::newRow("positiveInteger 0") << BuiltinTypes::PositiveInteger << "0" << false;
+    QTest::newRow("boolean") << BuiltinTypes::Boolean << "true" << true;
+    QTest::newRow("boolean case") << BuiltinTypes::Boolean << "True" << false;
+    QTest::newRow("decimal") << BuiltinTypes::Decimal << "-.5" << true;
+    QTest::newRow("decimal exponent") << BuiltinTypes::Decimal << "1e5" << false;
+    QTest::newRow("double") << BuiltinTypes::Double << "1.5E-3" << true;
+    QTest::newRow("double INF") << BuiltinTypes::Double << "-INF" << true;
+    QTest::newRow("double exponent") << BuiltinTypes::Double << "1e" << false;
+    QTest::newRow("hexBinary") << BuiltinTypes::HexBinary << "0FB7abcdef0123456789ABCDEF012345"
+                               << true;
+    QTest::newRow("hexBinary invalid")
+            << BuiltinTypes::HexBinary << "0FB7abcdef0123456789ABCDEF01234g" << false;
+    QTest::newRow("hexBinary odd") << BuiltinTypes::HexBinary << "0FB" << false;
+    QTest::newRow("base64Binary") << BuiltinTypes::Base64Binary
+                                  << "QUJDREVGR0hJSktMTU5PUFFSU1RVVldYWVo=" << true;
+    QTest::newRow("base64Binary spaces") << BuiltinTypes::Base64Binary << "QUJD RA==" << true;
+    QTest::newRow("base64Binary padding") << BuiltinTypes::Base64Binary << "QUJDRA=A" << false;
+    QTest::newRow("NCName") << BuiltinTypes::NCName << "_foo-bar.baz0123456789abcdefghij" << true;
+    QTest::newRow("NCName colon") << BuiltinTypes::NCName << "foo:bar" << false;
+    QTest::newRow("NCName digit") << BuiltinTypes::NCName << "1abc" << false;
+    QTest::newRow("NCName non-ASCII")
+            << BuiltinTypes::NCName << QString::fromUtf8("Gr\xc3\xb6\xc3\x9f" "e") << true;
+    QTest::newRow("QName") << BuiltinTypes::QualifiedName << "xs:string" << true;
+    QTest::newRow("QName two colons") << BuiltinTypes::QualifiedName << "a:b:c" << false;
+    QTest::newRow("NMTOKEN") << BuiltinTypes::NMToken << "1abc:def" << true;
+    QTest::newRow("token") << BuiltinTypes::Token << "a b c" << true;
+    QTest::newRow("token double space") << BuiltinTypes::Token << "a  b" << false;
+    QTest::newRow("token tab") << BuiltinTypes::Token << "aaaaaaaaaaaaaaaaaaaaaaaaa\tb" << false;
+    QTest::newRow("language") << BuiltinTypes::Language << "en-US" << true;
+    QTest::newRow("language too long") << BuiltinTypes::Language << "abcdefghi" << false;
+    QTest::newRow("date leap year") << BuiltinTypes::Date << "2024-02-29" << true;
+    QTest::newRow("date no leap year") << BuiltinTypes::Date << "1900-02-29" << false;
+    QTest::newRow("date time zone") << BuiltinTypes::Date << "-0044-03-15+01:00" << true;
+    QTest::newRow("time 24:00") << BuiltinTypes::Time << "24:00:00" << true;
+    QTest::newRow("time 24:00:01") << BuiltinTypes::Time << "24:00:01" << false;
+    QTest::newRow("dateTime") << BuiltinTypes::DateTime << "2002-10-10T12:00:00.5-05:00" << true;
+    QTest::newRow("dateTime space") << BuiltinTypes::DateTime << "2002-10-10 12:00:00" << false;
+    QTest::newRow("duration") << BuiltinTypes::Duration << "P1Y2M3DT10H30M1.5S" << true;
+    QTest::newRow("duration empty time") << BuiltinTypes::Duration << "P1YT" << false;
+    QTest::newRow("duration order") << BuiltinTypes::Duration << "P1M2Y" << false;
+}
+
+void BuiltinTypesTest::lexicalSpace()
+{
+    QFETCH(BuiltinTypes::Type, type);
+    QFETCH(QString, value);
+    QFETCH(bool, valid);
+
+    QCOMPARE(BuiltinTypes::isValid(type, value), valid);
+    QCOMPARE(BuiltinTypes::isValid(type, value.toUtf8()), valid);
+    QCOMPARE(BuiltinTypes::type(BuiltinTypes::name(type)), type);
+}
+
+void BuiltinTypesTest::conversions()
+{
+    qint64 number = 0;
+    QVERIFY(BuiltinTypes::toLongLong(QString("-1234567890123456789"), &number));
+    QCOMPARE(number, Q_INT64_C(-1234567890123456789));
+    QVERIFY(BuiltinTypes::toLongLong(QByteArray("-9223372036854775808"), &number));
+    QCOMPARE(number, std::numeric_limits<qint64>::min());
+    QVERIFY(!BuiltinTypes::toLongLong(QByteArray("9223372036854775808"), &number));
+
+    quint64 unsignedNumber = 0;
+    QVERIFY(BuiltinTypes::toULongLong(QString("18446744073709551615"), &unsignedNumber));
+    QCOMPARE(unsignedNumber, std::numeric_limits<quint64>::max());
+    QVERIFY(BuiltinTypes::toULongLong(QByteArray("+000987654321987654321"), &unsignedNumber));
+    QCOMPARE(unsignedNumber, Q_UINT64_C(987654321987654321));
+
+    bool boolean = false;
+    QVERIFY(BuiltinTypes::toBoolean(QString("1"), &boolean));
+    QVERIFY(boolean);
+    QVERIFY(!BuiltinTypes::toBoolean(QByteArray("yes"), &boolean));
+
+    double real = 0;
+    QVERIFY(BuiltinTypes::toDouble(QString("1.5e2"), &real));
+    QCOMPARE(real, 150.0);
+    QVERIFY(BuiltinTypes::toDouble(QByteArray("-INF"), &real));
+    QVERIFY(qIsInf(real) && real < 0);
+
+    QByteArray bytes;
+    QVERIFY(BuiltinTypes::fromHexBinary(QString("0aFF"), &bytes));
+    QCOMPARE(bytes, QByteArray("\x0a\xff"));
+    QVERIFY(BuiltinTypes::fromBase64Binary(QByteArray("QUJD RA=="), &bytes));
+    QCOMPARE(bytes, QByteArray("ABCD"));
+    QVERIFY(!BuiltinTypes::fromBase64Binary(QString("QUJDRA="), &bytes));
+}
+
+void BuiltinTypesTest::benchmark_data()
+{
+    QTest::addColumn<BuiltinTypes::Type>("type");
+    QTest::addColumn<QString>("value");
+    QTest::addColumn<bool>("utf8");
+
+    const QList<QPair<BuiltinTypes::Type, QString>> samples = {
+        { BuiltinTypes::Int, QStringLiteral("-1234567") },
+        { BuiltinTypes::Long, QStringLiteral("1234567890123456789") },
+        { BuiltinTypes::Decimal, QStringLiteral("12345.6789") },
+        { BuiltinTypes::Double, QStringLiteral("1.2345E-10") },
+        { BuiltinTypes::Boolean, QStringLiteral("false") },
+        { BuiltinTypes::DateTime, QStringLiteral("2002-10-10T12:00:00.123-05:00") },
+        { BuiltinTypes::Date, QStringLiteral("2002-10-10") },
+        { BuiltinTypes::Time, QStringLiteral("12:00:00") },
+        { BuiltinTypes::Base64Binary, QStringLiteral("QUJDREVGR0hJSktMTU5PUFFSU1RV").repeated(40) },
+        { BuiltinTypes::HexBinary, QStringLiteral("0123456789abcdef").repeated(64) },
+        { BuiltinTypes::NCName, QStringLiteral("someLongElementName_with.dots-and-dashes") },
+        { BuiltinTypes::Token, QStringLiteral("a token with several words in it") },
+        { BuiltinTypes::AnyURI, QStringLiteral("http://www.w3.org/2001/XMLSchema-instance") },
+    };
+    for (const auto &sample : samples) {
+        const QByteArray name = BuiltinTypes::name(sample.first).toLatin1();
+        QTest::newRow((name + " UTF-16").constData()) << sample.first << sample.second << false;
+        QTest::newRow((name + " UTF-8").constData()) << sample.first << sample.second << true;
+    }
+}
+
+void BuiltinTypesTest::benchmark()
+{
+    QFETCH(BuiltinTypes::Type, type);
+    QFETCH(QString, value);
+    QFETCH(bool, utf8);
+
+    // Throughput is the value length times the iterations over the time
+    const int iterations = 1000;
+    const QByteArray utf8Value = value.toUtf8();
+    bool valid = true;
+    if (utf8) {
+        QBENCHMARK {
+            for (int i = 0; i < iterations; ++i)
+                valid &= BuiltinTypes::isValid(type, utf8Value);
+        }
+    } else {
+        QBENCHMARK {
+            for (int i = 0; i < iterations; ++i)
+                valid &= BuiltinTypes::isValid(type, value);
+        }
+    }
+    QVERIFY(valid);
+}
+
+QTEST_MAIN(BuiltinTypesTest)
+#include "tst_builtintypes.moc"
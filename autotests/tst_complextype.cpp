@@ -0,0 +1,57 @@
+#include "complextype.h"
+
+#include <QTest>
+
+using namespace XSD;
+
+class ComplexTypeTest : public QObject
+{
+    Q_OBJECT
+private Q_SLOTS:
+    void structuralHash();
+    void structuralHashInvalidation();
+};
+
+static ComplexType createType(const QString &name)
+{
+    ComplexType type("ns");
+    type.setName(name);
+    Element element("ns");
+    element.setName("value");
+    element.setType(QName("http://www.w3.org/2001/XMLSchema", "string"));
+    type.addElement(element);
+    Attribute attribute("ns");
+    attribute.setName("id");
+    type.addAttribute(attribute);
+    return type;
+}
+
+void ComplexTypeTest::structuralHash()
+{
+    const ComplexType item = createType("Item");
+    ComplexType other = createType("Item1");
+    QCOMPARE(item.structuralHash(), other.structuralHash());
+    QVERIFY(item != other);
+    other.setName("Item");
+    QVERIFY(item == other);
+
+    ComplexType copy(item);
+    QCOMPARE(copy.structuralHash(), item.structuralHash());
+}
+
+void ComplexTypeTest::structuralHashInvalidation()
+{
+    ComplexType type = createType("Item");
+    const uint hash = type.structuralHash();
+    Element element("ns");
+    element.setName("other");
+    type.addElement(element);
+    QVERIFY(type.structuralHash() != hash);
+
+    ComplexType reference = createType("Item");
+    reference.addElement(element);
+    QCOMPARE(type.structuralHash(), reference.structuralHash());
+}
+
+QTEST_MAIN(ComplexTypeTest)
+#include "tst_complextype.moc"
@@ -0,0 +1,76 @@
+// Included first, so it has to bring the includes of the string conversion itself
+#include "enums.h"
+
+#include <QTest>
+
+class EnumTest : public QObject
+{
+    Q_OBJECT
+private Q_SLOTS:
+    void toString();
+    void fromString_data();
+    void fromString();
+    void combinable();
+};
+
+static constexpr bool parsesTo(const char *str, EnumHolder::Color expected)
+{
+    EnumHolder::Color value = EnumHolder::Red;
+    return EnumHolder::fromString(str, std::char_traits<char>::length(str), value)
+            && value == expected;
+}
+
+static_assert(parsesTo("tan", EnumHolder::Tan), "fromString() is usable in constant expressions");
+static_assert(!parsesTo("rex", EnumHolder::Red), "a distinguishing character is not enough");
+
+void EnumTest::toString()
+{
+    QCOMPARE(QByteArray(EnumHolder::toString(EnumHolder::Red)), QByteArray("red"));
+    QCOMPARE(QByteArray(EnumHolder::toString(EnumHolder::Tan)), QByteArray("tan"));
+    QCOMPARE(QByteArray(EnumHolder::toString(EnumHolder::Long)), QByteArray("Long"));
+    QCOMPARE(QByteArray(::toString(High)), QByteArray("High"));
+    QVERIFY(!EnumHolder::toString(static_cast<EnumHolder::Color>(4)));
+    QCOMPARE(QByteArray(EnumHolder::kode_Color_names[1]), QByteArray("green"));
+}
+
+void EnumTest::fromString_data()
+{
+    QTest::addColumn<QByteArray>("string");
+    QTest::addColumn<bool>("valid");
+    QTest::addColumn<int>("value");
+
+    QTest::newRow("red") << QByteArray("red") << true << int(EnumHolder::Red);
+    QTest::newRow("green") << QByteArray("green") << true << int(EnumHolder::Green);
+    QTest::newRow("blue") << QByteArray("blue") << true << int(EnumHolder::Blue);
+    QTest::newRow("tan") << QByteArray("tan") << true << int(EnumHolder::Tan);
+    QTest::newRow("enum name") << QByteArray("Red") << false << 0;
+    QTest::newRow("prefix") << QByteArray("gree") << false << 0;
+    QTest::newRow("same length") << QByteArray("ted") << false << 0;
+    QTest::newRow("empty") << QByteArray() << false << 0;
+}
+
+void EnumTest::fromString()
+{
+    QFETCH(QByteArray, string);
+    QFETCH(bool, valid);
+    QFETCH(int, value);
+
+    EnumHolder::Color color = EnumHolder::Red;
+    QCOMPARE(EnumHolder::fromString(string.constData(), std::size_t(string.size()), color), valid);
+    if (valid)
+        QCOMPARE(int(color), value);
+}
+
+void EnumTest::combinable()
+{
+    QCOMPARE(QByteArray(EnumHolder::toString(EnumHolder::Write)), QByteArray("Write"));
+    QVERIFY(!EnumHolder::toString(
+            static_cast<EnumHolder::Permission>(EnumHolder::Read | EnumHolder::Write)));
+
+    EnumHolder::Permission permission = EnumHolder::Read;
+    QVERIFY(EnumHolder::fromString("Execute", 7, permission));
+    QCOMPARE(permission, EnumHolder::Execute);
+}
+
+QTEST_MAIN(EnumTest)
+#include "tst_enum.moc"
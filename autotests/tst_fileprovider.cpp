@@ -0,0 +1,84 @@
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QTemporaryDir>
+#include <QTest>
+#include <QUrl>
+
+#include <common/fileprovider.h>
+
+class FileProviderTest : public QObject
+{
+    Q_OBJECT
+private Q_SLOTS:
+    void importPathIndex();
+    void importPathCase();
+    void downloadsDisabled();
+};
+
+static void writeFile(const QString &fileName)
+{
+    QVERIFY(QDir().mkpath(QFileInfo(fileName).absolutePath()));
+    QFile file(fileName);
+    QVERIFY(file.open(QIODevice::WriteOnly));
+    file.write("<schema/>");
+}
+
+void FileProviderTest::importPathIndex()
+{
+    QTemporaryDir first;
+    QTemporaryDir second;
+    QVERIFY(first.isValid() && second.isValid());
+    writeFile(second.filePath(QStringLiteral("example.com/schemas/a.xsd")));
+
+    FileProvider provider(true, { first.path(), second.path() });
+    QString target;
+    QVERIFY(provider.findLocal(QUrl(QStringLiteral("http://example.com/schemas/a.xsd")), target));
+    QCOMPARE(QFileInfo(target).canonicalFilePath(),
+             QFileInfo(second.filePath(QStringLiteral("example.com/schemas/a.xsd")))
+                     .canonicalFilePath());
+    QVERIFY(!provider.findLocal(QUrl(QStringLiteral("http://example.com/schemas/b.xsd")), target));
+
+    // The index is only refreshed on demand
+    writeFile(first.filePath(QStringLiteral("example.com/schemas/b.xsd")));
+    QVERIFY(!provider.findLocal(QUrl(QStringLiteral("http://example.com/schemas/b.xsd")), target));
+    FileProvider::invalidateImportPathIndex();
+    QVERIFY(provider.findLocal(QUrl(QStringLiteral("http://example.com/schemas/b.xsd")), target));
+    QVERIFY(target.startsWith(QDir(first.path()).absolutePath()));
+}
+
+void FileProviderTest::importPathCase()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    writeFile(dir.filePath(QStringLiteral("example.com/Schemas/Case.xsd")));
+
+    // Spelled differently, the file is only found where the file system would find it
+    FileProvider provider(true, { dir.path() });
+    QString target;
+    const bool found =
+            provider.findLocal(QUrl(QStringLiteral("http://example.com/schemas/case.xsd")), target);
+    const QString otherSpelling = dir.filePath(QStringLiteral("example.com/schemas/case.xsd"));
+    QCOMPARE(found, QFileInfo::exists(otherSpelling));
+    if (found)
+        QVERIFY(target.endsWith(QStringLiteral("example.com/Schemas/Case.xsd")));
+}
+
+void FileProviderTest::downloadsDisabled()
+{
+    const QUrl url(QStringLiteral("http://localhost:1/schemas/cached.xsd"));
+    FileProvider provider;
+    provider.setDownloadsEnabled(false);
+    QString target;
+    QVERIFY(!provider.get(url, target));
+
+    FileProvider::addToCache(url, QByteArray("<schema/>"));
+    target.clear();
+    QVERIFY(provider.get(url, target));
+    QFile file(target);
+    QVERIFY(file.open(QIODevice::ReadOnly));
+    QCOMPARE(file.readAll(), QByteArray("<schema/>"));
+}
+
+QTEST_MAIN(FileProviderTest)
+#include "tst_fileprovider.moc"
@@ -0,0 +1,216 @@
+#include "instancevalidator.h"
+#include "parser.h"
+
+#include <QDomDocument>
+#include <QTest>
+
+#include <common/messagehandler.h>
+#include <common/nsmanager.h>
+#include <common/parsercontext.h>
+
+using namespace XSD;
+
+class InstanceValidatorTest : public QObject
+{
+    Q_OBJECT
+private Q_SLOTS:
+    void initTestCase();
+    void validDocument();
+    void errors();
+    void adjacentChoices();
+    void choiceWithWildcard();
+    void benchmark();
+    void benchmarkDomLoading();
+
+private:
+    Types mTypes;
+    QByteArray mLargeDocument;
+};
+
+static const char schema[] =
+        "<xs:schema xmlns:xs=\"http://www.w3.org/2001/XMLSchema\""
+        " xmlns:tns=\"urn:test\" targetNamespace=\"urn:test\" elementFormDefault=\"qualified\">"
+        "  <xs:element name=\"order\" type=\"tns:Order\"/>"
+        "  <xs:complexType name=\"Order\">"
+        "    <xs:sequence>"
+        "      <xs:element name=\"id\" type=\"xs:int\"/>"
+        "      <xs:element name=\"item\" type=\"tns:Item\" maxOccurs=\"unbounded\"/>"
+        "      <xs:choice>"
+        "        <xs:element name=\"card\" type=\"xs:string\"/>"
+        "        <xs:element name=\"cash\" type=\"xs:boolean\"/>"
+        "      </xs:choice>"
+        "    </xs:sequence>"
+        "    <xs:attribute name=\"status\" type=\"tns:Status\" use=\"required\"/>"
+        "  </xs:complexType>"
+        "  <xs:complexType name=\"Item\">"
+        "    <xs:sequence>"
+        "      <xs:element name=\"name\" type=\"xs:string\"/>"
+        "      <xs:element name=\"note\" type=\"xs:string\" minOccurs=\"0\"/>"
+        "    </xs:sequence>"
+        "  </xs:complexType>"
+        "  <xs:simpleType name=\"Status\">"
+        "    <xs:restriction base=\"xs:string\">"
+        "      <xs:enumeration value=\"open\"/>"
+        "      <xs:enumeration value=\"closed\"/>"
+        "    </xs:restriction>"
+        "  </xs:simpleType>"
+        "</xs:schema>";
+
+void InstanceValidatorTest::initTestCase()
+{
+    NSManager namespaceManager;
+    MessageHandler messageHandler;
+    ParserContext context;
+    context.setNamespaceManager(&namespaceManager);
+    context.setMessageHandler(&messageHandler);
+
+    Parser parser;
+    QVERIFY(parser.parseString(&context, QByteArray(schema)));
+    mTypes = parser.types();
+
+    mLargeDocument = "<order xmlns=\"urn:test\" status=\"open\"><id>1</id>";
+    for (int i = 0; i < 20000; ++i) {
+        mLargeDocument += "<item><name>Item " + QByteArray::number(i)
+                + "</name><note>Some note</note></item>";
+    }
+    mLargeDocument += "<cash>true</cash></order>";
+}
+
+void InstanceValidatorTest::validDocument()
+{
+    InstanceValidator validator(mTypes);
+    QVERIFY(validator.validate(QByteArray("<order xmlns=\"urn:test\" status=\"open\">"
+                                          "<id>42</id>"
+                                          "<item><name>a</name></item>"
+                                          "<item><name>b</name><note>n</note></item>"
+                                          "<card>1234</card>"
+                                          "</order>")));
+    QVERIFY(validator.errors().isEmpty());
+
+    QVERIFY(validator.validate(mLargeDocument));
+}
+
+void InstanceValidatorTest::errors()
+{
+    InstanceValidator validator(mTypes);
+
+    QVERIFY(!validator.validate(QByteArray("<order xmlns=\"urn:test\" status=\"pending\">\n"
+                                           "  <item><name>a</name></item>\n"
+                                           "</order>")));
+    QList<InstanceValidator::Error> errors = validator.errors();
+    QCOMPARE(errors.count(), 2);
+    QCOMPARE(errors.at(0).lineNumber, qint64(1));
+    QVERIFY(errors.at(0).message.contains(QLatin1String("status")));
+    QCOMPARE(errors.at(1).lineNumber, qint64(2));
+    QVERIFY(errors.at(1).columnNumber > 0);
+    QVERIFY(errors.at(1).message.contains(QLatin1String("id")));
+
+    QVERIFY(!validator.validate(QByteArray("<order xmlns=\"urn:test\" status=\"open\">\n"
+                                           "  <id>x</id>\n"
+                                           "  <item><name>a</name></item>\n"
+                                           "</order>")));
+    errors = validator.errors();
+    QCOMPARE(errors.count(), 2);
+    QCOMPARE(errors.at(0).lineNumber, qint64(2));
+    QCOMPARE(errors.at(1).lineNumber, qint64(4));
+    QVERIFY(errors.at(1).message.contains(QLatin1String("card")));
+
+    QVERIFY(!validator.validate(QByteArray("<unknown/>")));
+    QCOMPARE(validator.errors().count(), 1);
+
+    QVERIFY(!validator.validate(QByteArray("<order xmlns=\"urn:test\" status=\"open\">")));
+    QCOMPARE(validator.errors().count(), 1);
+}
+
+void InstanceValidatorTest::adjacentChoices()
+{
+    // Two choices with the same members are still two required particles
+    NSManager namespaceManager;
+    MessageHandler messageHandler;
+    ParserContext context;
+    context.setNamespaceManager(&namespaceManager);
+    context.setMessageHandler(&messageHandler);
+
+    Parser parser;
+    QVERIFY(parser.parseString(
+            &context,
+            QByteArray("<xs:schema xmlns:xs=\"http://www.w3.org/2001/XMLSchema\">"
+                       "  <xs:element name=\"pair\">"
+                       "    <xs:complexType>"
+                       "      <xs:sequence>"
+                       "        <xs:choice>"
+                       "          <xs:element name=\"a\" type=\"xs:string\"/>"
+                       "          <xs:element name=\"b\" type=\"xs:string\"/>"
+                       "        </xs:choice>"
+                       "        <xs:choice>"
+                       "          <xs:element name=\"a\" type=\"xs:string\"/>"
+                       "          <xs:element name=\"b\" type=\"xs:string\"/>"
+                       "        </xs:choice>"
+                       "      </xs:sequence>"
+                       "    </xs:complexType>"
+                       "  </xs:element>"
+                       "</xs:schema>")));
+
+    InstanceValidator validator(parser.types());
+    QVERIFY(validator.validate(QByteArray("<pair><b/><a/></pair>")));
+    QVERIFY(validator.validate(QByteArray("<pair><a/><a/></pair>")));
+    QVERIFY(!validator.validate(QByteArray("<pair><a/></pair>")));
+    QVERIFY(!validator.validate(QByteArray("<pair><a/><b/><a/></pair>")));
+}
+
+void InstanceValidatorTest::choiceWithWildcard()
+{
+    NSManager namespaceManager;
+    MessageHandler messageHandler;
+    ParserContext context;
+    context.setNamespaceManager(&namespaceManager);
+    context.setMessageHandler(&messageHandler);
+
+    Parser parser;
+    QVERIFY(parser.parseString(
+            &context,
+            QByteArray("<xs:schema xmlns:xs=\"http://www.w3.org/2001/XMLSchema\">"
+                       "  <xs:element name=\"value\">"
+                       "    <xs:complexType>"
+                       "      <xs:sequence>"
+                       "        <xs:element name=\"id\" type=\"xs:int\"/>"
+                       "        <xs:choice>"
+                       "          <xs:element name=\"number\" type=\"xs:int\"/>"
+                       "          <xs:any processContents=\"lax\"/>"
+                       "          <xs:element name=\"flag\" type=\"xs:boolean\"/>"
+                       "        </xs:choice>"
+                       "      </xs:sequence>"
+                       "    </xs:complexType>"
+                       "  </xs:element>"
+                       "</xs:schema>")));
+
+    // The wildcard is a member of the choice, the declared members keep their types
+    InstanceValidator validator(parser.types());
+    QVERIFY(validator.validate(QByteArray("<value><id>1</id><number>2</number></value>")));
+    QVERIFY(validator.validate(QByteArray("<value><id>1</id><flag>true</flag></value>")));
+    QVERIFY(validator.validate(QByteArray("<value><id>1</id><other/></value>")));
+    QVERIFY(!validator.validate(QByteArray("<value><id>1</id><number>x</number></value>")));
+    QVERIFY(!validator.validate(QByteArray("<value><id>1</id></value>")));
+    QVERIFY(!validator.validate(QByteArray("<value><id>1</id><other/><flag>true</flag></value>")));
+}
+
+void InstanceValidatorTest::benchmark()
+{
+    InstanceValidator validator(mTypes);
+    qDebug() << "Validating" << mLargeDocument.size() << "bytes";
+    QBENCHMARK {
+        validator.validate(mLargeDocument);
+    }
+}
+
+// Baseline for DOM-based validation, which has to build the tree first
+void InstanceValidatorTest::benchmarkDomLoading()
+{
+    QBENCHMARK {
+        QDomDocument document;
+        document.setContent(mLargeDocument, true);
+    }
+}
+
+QTEST_MAIN(InstanceValidatorTest)
+#include "tst_instancevalidator.moc"
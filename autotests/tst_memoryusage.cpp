@@ -0,0 +1,99 @@
+#include "memoryusage.h"
+#include "parser.h"
+
+#include <QTest>
+
+#include <common/messagehandler.h>
+#include <common/nsmanager.h>
+#include <common/parsercontext.h>
+
+using namespace XSD;
+
+class MemoryUsageTest : public QObject
+{
+    Q_OBJECT
+private Q_SLOTS:
+    void parsedSchema();
+    void duplicateStrings();
+};
+
+static const char schema[] = "<xs:schema xmlns:xs=\"http://www.w3.org/2001/XMLSchema\""
+                             " xmlns:tns=\"urn:test\" targetNamespace=\"urn:test\">"
+                             "  <xs:annotation>"
+                             "    <xs:documentation>Orders</xs:documentation>"
+                             "  </xs:annotation>"
+                             "  <xs:element name=\"order\" type=\"tns:Order\"/>"
+                             "  <xs:complexType name=\"Order\">"
+                             "    <xs:sequence>"
+                             "      <xs:element name=\"id\" type=\"xs:string\"/>"
+                             "      <xs:element name=\"note\" type=\"xs:string\"/>"
+                             "    </xs:sequence>"
+                             "    <xs:attribute name=\"id\" type=\"xs:string\"/>"
+                             "  </xs:complexType>"
+                             "  <xs:simpleType name=\"Code\">"
+                             "    <xs:restriction base=\"xs:string\">"
+                             "      <xs:enumeration value=\"a\"/>"
+                             "      <xs:enumeration value=\"b\"/>"
+                             "    </xs:restriction>"
+                             "  </xs:simpleType>"
+                             "</xs:schema>";
+
+void MemoryUsageTest::parsedSchema()
+{
+    NSManager namespaceManager;
+    MessageHandler messageHandler;
+    ParserContext context;
+    context.setNamespaceManager(&namespaceManager);
+    context.setMessageHandler(&messageHandler);
+
+    Parser parser;
+    QVERIFY(parser.parseString(&context, QByteArray(schema)));
+    const MemoryUsage usage = parser.memoryUsage();
+
+    QCOMPARE(usage.simpleTypeCount(), 1);
+    QCOMPARE(usage.complexTypeCount(), 1);
+    // The global element, the elements of the complex type and their global copies
+    QCOMPARE(usage.elementCount(), 5);
+    QCOMPARE(usage.attributeCount(), 1);
+    QCOMPARE(usage.annotationCount(), 1);
+    QCOMPARE(usage.documentCount(), 1);
+
+    qint64 total = 0;
+    for (int i = 0; i < MemoryUsage::CategoryCount; ++i) {
+        const auto category = static_cast<MemoryUsage::Category>(i);
+        QVERIFY2(usage.bytes(category) > 0, qPrintable(MemoryUsage::categoryName(category)));
+        total += usage.bytes(category);
+    }
+    QCOMPARE(usage.totalBytes(), total);
+
+    // The element and the attribute named "id" are separate strings from the DOM
+    QVERIFY(usage.stringCount() > 0);
+    QVERIFY(usage.duplicateStringCount() >= 1);
+    QVERIFY(usage.duplicateStringBytes() > 0);
+}
+
+void MemoryUsageTest::duplicateStrings()
+{
+    const QString nameSpace = QString::fromLatin1("urn:test");
+    const QString name = QString::fromLatin1("value");
+    Element first(nameSpace);
+    first.setName(name);
+    // Shares the characters of the first name, so it is no duplicate
+    Element shared(nameSpace);
+    shared.setName(name);
+    // Same content, allocated separately
+    Element separate(nameSpace);
+    separate.setName(QString::fromLatin1("value"));
+
+    MemoryUsage usage;
+    usage.addElements(Element::List() << first << shared << separate);
+    QCOMPARE(usage.elementCount(), 3);
+    QCOMPARE(usage.stringCount(), 3);
+    QCOMPARE(usage.duplicateStringCount(), 1);
+    QVERIFY(usage.duplicateStringBytes() > 0);
+    QVERIFY(usage.bytes(MemoryUsage::Elements) > 0);
+    QCOMPARE(usage.bytes(MemoryUsage::Annotations), 0);
+}
+
+QTEST_MAIN(MemoryUsageTest)
+#include "tst_memoryusage.moc"
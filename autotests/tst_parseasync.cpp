@@ -0,0 +1,146 @@
+#include "parser.h"
+
+#include <common/messagehandler.h>
+
+#include <QFile>
+#include <QFutureWatcher>
+#include <QSignalSpy>
+#include <QTemporaryDir>
+#include <QTest>
+
+using namespace XSD;
+
+class ParseAsyncTest : public QObject
+{
+    Q_OBJECT
+private Q_SLOTS:
+    void initTestCase();
+    void parseWithImport();
+    void missingFile();
+    void messages();
+    void cancel();
+
+private:
+    QTemporaryDir mDir;
+};
+
+static const char mainSchema[] =
+        "<xs:schema xmlns:xs=\"http://www.w3.org/2001/XMLSchema\""
+        " xmlns:tns=\"urn:main\" xmlns:other=\"urn:other\" targetNamespace=\"urn:main\">"
+        "  <xs:import namespace=\"urn:other\" schemaLocation=\"other.xsd\"/>"
+        "  <xs:complexType name=\"Main\">"
+        "    <xs:sequence>"
+        "      <xs:element name=\"part\" type=\"other:Part\"/>"
+        "    </xs:sequence>"
+        "  </xs:complexType>"
+        "</xs:schema>";
+
+static const char otherSchema[] =
+        "<xs:schema xmlns:xs=\"http://www.w3.org/2001/XMLSchema\" targetNamespace=\"urn:other\">"
+        "  <xs:complexType name=\"Part\">"
+        "    <xs:sequence>"
+        "      <xs:element name=\"name\" type=\"xs:string\"/>"
+        "    </xs:sequence>"
+        "  </xs:complexType>"
+        "</xs:schema>";
+
+static void writeFile(const QString &fileName, const QByteArray &data)
+{
+    QFile file(fileName);
+    QVERIFY(file.open(QIODevice::WriteOnly));
+    file.write(data);
+}
+
+void ParseAsyncTest::initTestCase()
+{
+    QVERIFY(mDir.isValid());
+    writeFile(mDir.filePath(QStringLiteral("main.xsd")), QByteArray(mainSchema));
+    writeFile(mDir.filePath(QStringLiteral("other.xsd")), QByteArray(otherSchema));
+}
+
+void ParseAsyncTest::parseWithImport()
+{
+    const QUrl url = QUrl::fromLocalFile(mDir.filePath(QStringLiteral("main.xsd")));
+
+    QFuture<Types> future;
+    {
+        // The parser may go away before the future finishes
+        Parser parser;
+        future = parser.parseAsync(url);
+    }
+    QFutureWatcher<Types> watcher;
+    QSignalSpy finishedSpy(&watcher, &QFutureWatcherBase::finished);
+    watcher.setFuture(future);
+    QTRY_VERIFY(future.isFinished());
+
+    QCOMPARE(future.resultCount(), 1);
+    const Types types = future.result();
+    QCOMPARE(types.complexTypes().count(), 2);
+    QVERIFY(!types.complexType(QName(QStringLiteral("urn:other"), QStringLiteral("Part")))
+                     .isNull());
+    QTRY_COMPARE(finishedSpy.count(), 1);
+}
+
+void ParseAsyncTest::missingFile()
+{
+    Parser parser;
+    QFuture<Types> future =
+            parser.parseAsync(QUrl::fromLocalFile(mDir.filePath(QStringLiteral("none.xsd"))));
+    QTRY_VERIFY(future.isFinished());
+    QCOMPARE(future.resultCount(), 0);
+}
+
+class RecordingMessageHandler : public MessageHandler
+{
+public:
+    void warning(const QString &message) override { mWarnings.append(message); }
+    void error(const QString &message) override { mErrors.append(message); }
+
+    QStringList mWarnings;
+    QStringList mErrors;
+};
+
+void ParseAsyncTest::messages()
+{
+    writeFile(mDir.filePath(QStringLiteral("broken.xsd")),
+              QByteArray("<xs:schema xmlns:xs=\"http://www.w3.org/2001/XMLSchema\">"
+                         "  <xs:import namespace=\"urn:missing\" schemaLocation=\"missing.xsd\"/>"
+                         "  <xs:element name=\"broken\" type=\"xs:string\">"
+                         "</xs:schema>"));
+    RecordingMessageHandler messageHandler;
+    Parser parser;
+    QFuture<Types> future = parser.parseAsync(
+            QUrl::fromLocalFile(mDir.filePath(QStringLiteral("broken.xsd"))), &messageHandler);
+    QTRY_VERIFY(future.isFinished());
+    QCOMPARE(future.resultCount(), 0);
+    QCOMPARE(messageHandler.mErrors.count(), 1);
+    QVERIFY(messageHandler.mErrors.first().contains(QLatin1String("broken.xsd")));
+
+    RecordingMessageHandler missingHandler;
+    future = parser.parseAsync(QUrl::fromLocalFile(mDir.filePath(QStringLiteral("none.xsd"))),
+                               &missingHandler);
+    QTRY_VERIFY(future.isFinished());
+    QCOMPARE(future.resultCount(), 0);
+    QVERIFY(!missingHandler.mWarnings.isEmpty());
+    QCOMPARE(missingHandler.mErrors.count(), 1);
+    QVERIFY(missingHandler.mErrors.first().contains(QLatin1String("none.xsd")));
+}
+
+void ParseAsyncTest::cancel()
+{
+    const QUrl url = QUrl::fromLocalFile(mDir.filePath(QStringLiteral("main.xsd")));
+    Parser parser;
+    QFuture<Types> future = parser.parseAsync(url);
+    // Local documents are found right away, and reported as progress
+    QCOMPARE(future.progressMinimum(), 0);
+    QCOMPARE(future.progressMaximum(), 2);
+    QCOMPARE(future.progressValue(), 2);
+
+    future.cancel();
+    QTRY_VERIFY(future.isFinished());
+    QVERIFY(future.isCanceled());
+    QCOMPARE(future.resultCount(), 0);
+}
+
+QTEST_MAIN(ParseAsyncTest)
+#include "tst_parseasync.moc"
@@ -0,0 +1,243 @@
+#include "parser.h"
+
+#include <QDir>
+#include <QDomDocument>
+#include <QFile>
+#include <QFileInfo>
+#include <QTemporaryDir>
+#include <QTest>
+
+#include <common/messagehandler.h>
+#include <common/nsmanager.h>
+#include <common/parsercontext.h>
+
+using namespace XSD;
+
+class ParserTest : public QObject
+{
+    Q_OBJECT
+private Q_SLOTS:
+    void lazyParsing();
+    void lazySubstitution();
+    void lazyNamespacesOfAncestors();
+    void diamondImports();
+    void relativeCopies();
+};
+
+static const char schema[] = "<xs:schema xmlns:xs=\"http://www.w3.org/2001/XMLSchema\""
+                             " xmlns:tns=\"urn:test\" targetNamespace=\"urn:test\">"
+                             "  <xs:element name=\"root\" type=\"tns:RootType\"/>"
+                             "  <xs:element name=\"unused\" type=\"tns:UnusedType\"/>"
+                             "  <xs:complexType name=\"RootType\">"
+                             "    <xs:sequence>"
+                             "      <xs:element ref=\"tns:item\"/>"
+                             "    </xs:sequence>"
+                             "    <xs:attribute name=\"code\" type=\"tns:Code\"/>"
+                             "  </xs:complexType>"
+                             "  <xs:complexType name=\"DerivedType\">"
+                             "    <xs:complexContent>"
+                             "      <xs:extension base=\"tns:RootType\"/>"
+                             "    </xs:complexContent>"
+                             "  </xs:complexType>"
+                             "  <xs:element name=\"item\" type=\"xs:string\"/>"
+                             "  <xs:simpleType name=\"Code\">"
+                             "    <xs:restriction base=\"xs:string\"/>"
+                             "  </xs:simpleType>"
+                             "  <xs:complexType name=\"UnusedType\"/>"
+                             "</xs:schema>";
+
+void ParserTest::lazyParsing()
+{
+    NSManager namespaceManager;
+    MessageHandler messageHandler;
+    ParserContext context;
+    context.setNamespaceManager(&namespaceManager);
+    context.setMessageHandler(&messageHandler);
+
+    Parser parser;
+    parser.setLazyParsing(true);
+    QVERIFY(parser.parseString(&context, QByteArray(schema)));
+    QVERIFY(parser.types().complexTypes().isEmpty());
+
+    QVERIFY(parser.resolveLazyComponents(QName::List() << QName("urn:test", "root")));
+    const Types types = parser.types();
+    QCOMPARE(types.complexTypes().count(), 2);
+    QVERIFY(!types.complexType(QName("urn:test", "RootType")).isNull());
+    QVERIFY(!types.complexType(QName("urn:test", "DerivedType")).isNull());
+    QVERIFY(types.complexType(QName("urn:test", "UnusedType")).isNull());
+    QVERIFY(!types.simpleType(QName("urn:test", "Code")).isNull());
+
+    const Element::List elements = types.complexType(QName("urn:test", "RootType")).elements();
+    QCOMPARE(elements.count(), 1);
+    QCOMPARE(elements.at(0).name(), QString("item"));
+}
+
+void ParserTest::lazySubstitution()
+{
+    // The prefix of the substitution group is declared on the substituting element
+    static const char substitutionSchema[] =
+            "<xs:schema xmlns:xs=\"http://www.w3.org/2001/XMLSchema\""
+            " xmlns:tns=\"urn:test\" targetNamespace=\"urn:test\">"
+            "  <xs:element name=\"head\" type=\"tns:HeadType\"/>"
+            "  <xs:element xmlns:h=\"urn:test\" name=\"member\" substitutionGroup=\"h:head\""
+            "   type=\"h:MemberType\"/>"
+            "  <xs:complexType name=\"HeadType\"/>"
+            "  <xs:complexType name=\"MemberType\">"
+            "    <xs:complexContent>"
+            "      <xs:extension base=\"tns:HeadType\"/>"
+            "    </xs:complexContent>"
+            "  </xs:complexType>"
+            "</xs:schema>";
+
+    NSManager namespaceManager;
+    MessageHandler messageHandler;
+    ParserContext context;
+    context.setNamespaceManager(&namespaceManager);
+    context.setMessageHandler(&messageHandler);
+
+    Parser parser;
+    parser.setLazyParsing(true);
+    QVERIFY(parser.parseString(&context, QByteArray(substitutionSchema)));
+    QVERIFY(parser.resolveLazyComponents(QName::List() << QName("urn:test", "head")));
+
+    const Types types = parser.types();
+    bool memberFound = false;
+    for (const Element &element : types.elements()) {
+        if (element.qualifiedName() == QName("urn:test", "member"))
+            memberFound = true;
+    }
+    QVERIFY(memberFound);
+    QVERIFY(!types.complexType(QName("urn:test", "MemberType")).isNull());
+}
+
+static void writeSchema(const QTemporaryDir &dir, const QString &fileName, const char *body,
+                        const char *nameSpace)
+{
+    const QString path = dir.filePath(fileName);
+    QVERIFY(QDir().mkpath(QFileInfo(path).absolutePath()));
+    QFile file(path);
+    QVERIFY(file.open(QIODevice::WriteOnly));
+    file.write(QByteArray("<xs:schema xmlns:xs=\"http://www.w3.org/2001/XMLSchema\""
+                          " targetNamespace=\"")
+               + nameSpace + "\">" + body + "</xs:schema>");
+}
+
+void ParserTest::lazyNamespacesOfAncestors()
+{
+    NSManager namespaceManager;
+    MessageHandler messageHandler;
+    ParserContext context;
+    context.setNamespaceManager(&namespaceManager);
+    context.setMessageHandler(&messageHandler);
+
+    Parser parser;
+    parser.setLazyParsing(true);
+    {
+        // Like the types of a WSDL file, the prefixes are declared outside of the schema
+        QDomDocument document;
+        QVERIFY(document.setContent(
+                QByteArray("<definitions xmlns:xs=\"http://www.w3.org/2001/XMLSchema\""
+                           " xmlns:t=\"urn:test\">"
+                           "  <xs:schema targetNamespace=\"urn:test\">"
+                           "    <xs:element name=\"root\" type=\"t:Code\"/>"
+                           "    <xs:simpleType name=\"Code\">"
+                           "      <xs:restriction base=\"xs:string\"/>"
+                           "    </xs:simpleType>"
+                           "  </xs:schema>"
+                           "</definitions>")));
+        NSManager definitionsNamespaceManager(&context, document.documentElement());
+        QVERIFY(parser.parseSchemaTag(&context,
+                                      document.documentElement().firstChildElement()));
+    }
+
+    // The components are parsed after the document is gone
+    QVERIFY(parser.resolveLazyComponents(QName::List() << QName("urn:test", "root")));
+    const Types types = parser.types();
+    QName rootType;
+    for (const Element &element : types.elements()) {
+        if (element.qualifiedName() == QName("urn:test", "root"))
+            rootType = element.type();
+    }
+    QCOMPARE(rootType, QName("urn:test", "Code"));
+    QVERIFY(!types.simpleType(QName("urn:test", "Code")).isNull());
+}
+
+void ParserTest::diamondImports()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    // a and b import the same file through different relative paths, and main
+    // imports an identical copy of it from another directory
+    writeSchema(dir, QStringLiteral("main.xsd"),
+                "<xs:import namespace=\"urn:a\" schemaLocation=\"a/a.xsd\"/>"
+                "<xs:import namespace=\"urn:b\" schemaLocation=\"b/b.xsd\"/>"
+                "<xs:import namespace=\"urn:common\" schemaLocation=\"copy/common.xsd\"/>",
+                "urn:main");
+    writeSchema(dir, QStringLiteral("a/a.xsd"),
+                "<xs:import namespace=\"urn:common\" schemaLocation=\"../common/common.xsd\"/>"
+                "<xs:complexType name=\"A\"/>",
+                "urn:a");
+    writeSchema(dir, QStringLiteral("b/b.xsd"),
+                "<xs:import namespace=\"urn:common\""
+                " schemaLocation=\"../b/../common/./common.xsd\"/>"
+                "<xs:complexType name=\"B\"/>",
+                "urn:b");
+    writeSchema(dir, QStringLiteral("common/common.xsd"), "<xs:complexType name=\"Common\"/>",
+                "urn:common");
+    writeSchema(dir, QStringLiteral("copy/common.xsd"), "<xs:complexType name=\"Common\"/>",
+                "urn:common");
+
+    NSManager namespaceManager;
+    MessageHandler messageHandler;
+    ParserContext context;
+    context.setNamespaceManager(&namespaceManager);
+    context.setMessageHandler(&messageHandler);
+    const QString mainName = dir.filePath(QStringLiteral("main.xsd"));
+    context.setDocumentBaseUrlFromFileUrl(QUrl::fromLocalFile(mainName));
+
+    Parser parser;
+    QFile file(mainName);
+    QVERIFY(file.open(QIODevice::ReadOnly));
+    QVERIFY(parser.parseFile(&context, file));
+
+    // Each document is parsed once, so each type exists once
+    const ComplexType::List complexTypes = parser.types().complexTypes();
+    QCOMPARE(complexTypes.count(), 3);
+}
+
+void ParserTest::relativeCopies()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    // x/wrapper.xsd and y/wrapper.xsd are identical, but import different files
+    writeSchema(dir, QStringLiteral("main.xsd"),
+                "<xs:import namespace=\"urn:w\" schemaLocation=\"x/wrapper.xsd\"/>"
+                "<xs:import namespace=\"urn:w\" schemaLocation=\"y/wrapper.xsd\"/>",
+                "urn:main");
+    const char wrapper[] = "<xs:import namespace=\"urn:t\" schemaLocation=\"types.xsd\"/>";
+    writeSchema(dir, QStringLiteral("x/wrapper.xsd"), wrapper, "urn:w");
+    writeSchema(dir, QStringLiteral("y/wrapper.xsd"), wrapper, "urn:w");
+    writeSchema(dir, QStringLiteral("x/types.xsd"), "<xs:complexType name=\"X\"/>", "urn:t");
+    writeSchema(dir, QStringLiteral("y/types.xsd"), "<xs:complexType name=\"Y\"/>", "urn:t");
+
+    NSManager namespaceManager;
+    MessageHandler messageHandler;
+    ParserContext context;
+    context.setNamespaceManager(&namespaceManager);
+    context.setMessageHandler(&messageHandler);
+    const QString mainName = dir.filePath(QStringLiteral("main.xsd"));
+    context.setDocumentBaseUrlFromFileUrl(QUrl::fromLocalFile(mainName));
+
+    Parser parser;
+    QFile file(mainName);
+    QVERIFY(file.open(QIODevice::ReadOnly));
+    QVERIFY(parser.parseFile(&context, file));
+
+    const ComplexType::List complexTypes = parser.types().complexTypes();
+    QCOMPARE(complexTypes.count(), 2);
+    QVERIFY(!complexTypes.complexType(QName("urn:t", "X")).isNull());
+    QVERIFY(!complexTypes.complexType(QName("urn:t", "Y")).isNull());
+}
+
+QTEST_MAIN(ParserTest)
+#include "tst_parser.moc"
@@ -0,0 +1,445 @@
+#include "printer.h"
+
+#include <QFile>
+#include <QTemporaryDir>
+#include <QTest>
+
+using namespace KODE;
+
+class PrinterTest : public QObject
+{
+    Q_OBJECT
+private Q_SLOTS:
+    void moveOperations();
+    void sharedMoveOperations();
+    void inlineFunctions();
+    void dPointerInlineFunctions();
+    void inlineFileFunctions();
+    void memberLayout();
+    void unityFileCode();
+    void shardFileContent();
+    void depfile();
+    void unchangedFiles();
+    void unchangedShards();
+};
+
+// Returns the trimmed lines of @p fileName in @p dir
+static QStringList printedLines(const QTemporaryDir &dir, const QString &fileName)
+{
+    QFile file(dir.filePath(fileName));
+    if (!file.open(QIODevice::ReadOnly))
+        return QStringList();
+    QStringList lines;
+    const QStringList text = QString::fromUtf8(file.readAll()).split(QLatin1Char('\n'));
+    for (const QString &line : text)
+        lines.append(line.trimmed());
+    return lines;
+}
+
+static Function valueAccessor(const QString &body)
+{
+    Function accessor(QStringLiteral("value"), QStringLiteral("int"));
+    accessor.setConst(true);
+    accessor.setInline(true);
+    accessor.setBody(body);
+    return accessor;
+}
+
+static File dataFile(bool sharedData)
+{
+    Class data(QStringLiteral("Data"));
+    data.setUseDPointer(true);
+    if (sharedData)
+        data.setUseSharedData(true);
+    data.setCanBeCopied(true);
+    data.addMemberVariable(MemberVariable(QStringLiteral("value"), QStringLiteral("int")));
+    data.addFunction(Function(QStringLiteral("~Data")));
+
+    File file;
+    file.setFilename(QStringLiteral("data"));
+    file.insertClass(data);
+    return file;
+}
+
+void PrinterTest::moveOperations()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    Printer printer;
+    printer.setOutputDirectory(dir.path());
+    printer.printImplementation(dataFile(false));
+    const QStringList lines = printedLines(dir, QStringLiteral("data.cpp"));
+
+    QVERIFY(lines.contains("#include <utility>"));
+    // The move constructor steals the private data instead of allocating
+    const int moveConstructor = lines.indexOf("Data::Data( Data&& other ) noexcept");
+    QVERIFY(moveConstructor >= 0);
+    QCOMPARE(lines.at(moveConstructor + 1),
+             QStringLiteral(": d( std::exchange( other.d, nullptr ) )"));
+    QCOMPARE(lines.at(moveConstructor + 2), QStringLiteral("{"));
+    QCOMPARE(lines.at(moveConstructor + 3), QStringLiteral("}"));
+    QCOMPARE(lines.count("d = new PrivateDPtr;"), 1); // only the copy constructor allocates
+
+    // Moved-from instances can be assigned to and destroyed
+    QVERIFY(lines.contains("if ( d )"));
+    QVERIFY(lines.contains("d = new PrivateDPtr( *other.d );"));
+    QVERIFY(lines.contains("delete d;"));
+    QVERIFY(lines.contains("std::swap( d, other.d );"));
+}
+
+void PrinterTest::sharedMoveOperations()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    Printer printer;
+    printer.setOutputDirectory(dir.path());
+    printer.printImplementation(dataFile(true));
+    const QStringList lines = printedLines(dir, QStringLiteral("data.cpp"));
+
+    // Moving the shared data pointer does not touch the reference count
+    const int moveConstructor = lines.indexOf("Data::Data( Data&& other ) noexcept");
+    QVERIFY(moveConstructor >= 0);
+    QCOMPARE(lines.at(moveConstructor + 1), QStringLiteral(": d( std::move( other.d ) )"));
+    QVERIFY(lines.contains("d.swap( other.d );"));
+}
+
+void PrinterTest::inlineFunctions()
+{
+    Class value(QStringLiteral("Value"));
+    value.addMemberVariable(MemberVariable(QStringLiteral("value"), QStringLiteral("int")));
+    value.addFunction(valueAccessor(QStringLiteral("return mValue;")));
+    File file;
+    file.setFilename(QStringLiteral("value"));
+    file.insertClass(value);
+
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    Printer printer;
+    printer.setOutputDirectory(dir.path());
+    printer.printHeader(file);
+    printer.printImplementation(file);
+
+    const QStringList header = printedLines(dir, QStringLiteral("value.h"));
+    const int accessor = header.indexOf("inline int value() const");
+    QVERIFY(accessor >= 0);
+    QCOMPARE(header.at(accessor + 2), QStringLiteral("return mValue;"));
+    QVERIFY(!printedLines(dir, QStringLiteral("value.cpp")).join('\n').contains("value()"));
+}
+
+void PrinterTest::dPointerInlineFunctions()
+{
+    File file = dataFile(false);
+    Class data = file.classes().first();
+    data.addFunction(valueAccessor(QStringLiteral("return d->mValue;")));
+    file.clearClasses();
+    file.insertClass(data);
+
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    Printer printer;
+    printer.setOutputDirectory(dir.path());
+    QTest::ignoreMessage(QtWarningMsg,
+                         "Data::value can't be inline, the private data of the class is only "
+                         "known in the implementation");
+    printer.printHeader(file);
+    printer.printImplementation(file);
+
+    // PrivateDPtr is incomplete in the header, so the accessor is defined in the
+    // implementation, and can't be inline there
+    const QStringList header = printedLines(dir, QStringLiteral("data.h"));
+    QVERIFY(header.contains("int value() const;"));
+    QVERIFY(!header.join('\n').contains("d->mValue"));
+    const QStringList implementation = printedLines(dir, QStringLiteral("data.cpp"));
+    const int accessor = implementation.indexOf("int Data::value() const");
+    QVERIFY(accessor >= 0);
+    QCOMPARE(implementation.at(accessor + 2), QStringLiteral("return d->mValue;"));
+}
+
+void PrinterTest::inlineFileFunctions()
+{
+    Function twice(QStringLiteral("twice"), QStringLiteral("int"));
+    twice.addArgument(QStringLiteral("int x"));
+    twice.setConstexpr(true);
+    twice.setBody(QStringLiteral("return 2 * x;"));
+    Function half(QStringLiteral("half"), QStringLiteral("int"));
+    half.addArgument(QStringLiteral("int x"));
+    half.setBody(QStringLiteral("return x / 2;"));
+
+    File file;
+    file.setFilename(QStringLiteral("functions"));
+    file.addFileFunction(twice);
+    file.addFileFunction(half);
+
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    Printer printer;
+    printer.setOutputDirectory(dir.path());
+    printer.printHeader(file);
+    printer.printImplementation(file);
+
+    const QStringList header = printedLines(dir, QStringLiteral("functions.h"));
+    QVERIFY(header.contains("constexpr int twice( int x )"));
+    QVERIFY(header.contains("return 2 * x;"));
+    QVERIFY(!header.join('\n').contains("half"));
+    const QStringList implementation = printedLines(dir, QStringLiteral("functions.cpp"));
+    QVERIFY(implementation.contains("int half( int x )"));
+    QVERIFY(!implementation.join('\n').contains("twice"));
+}
+
+void PrinterTest::memberLayout()
+{
+    Class layout(QStringLiteral("Layout"));
+    layout.addMemberVariable(MemberVariable(QStringLiteral("enabled"), QStringLiteral("bool")));
+    layout.addMemberVariable(MemberVariable(QStringLiteral("ratio"), QStringLiteral("double")));
+    layout.addMemberVariable(MemberVariable(QStringLiteral("count"), QStringLiteral("int")));
+    layout.addMemberVariable(MemberVariable(QStringLiteral("text"), QStringLiteral("char *")));
+    Function constructor(QStringLiteral("Layout"));
+    constructor.addArgument(QStringLiteral("int count"));
+    constructor.addInitializer(QStringLiteral("mEnabled( true )"));
+    constructor.addInitializer(QStringLiteral("mRatio( 1.0 )"));
+    constructor.addInitializer(QStringLiteral("mCount( count )"));
+    layout.addFunction(constructor);
+    File file;
+    file.setFilename(QStringLiteral("layout"));
+    file.insertClass(layout);
+
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    Printer printer;
+    printer.setOutputDirectory(dir.path());
+    printer.setOptimizeMemberLayout(true);
+    printer.printHeader(file);
+    printer.printImplementation(file);
+
+    // 8 byte scalars go before pointers, whatever the size of pointers
+    const QStringList header = printedLines(dir, QStringLiteral("layout.h"));
+    const int first = header.indexOf("double mRatio;");
+    QVERIFY(first >= 0);
+    QCOMPARE(header.mid(first, 4),
+             QStringList({ "double mRatio;", "char *mText;", "int mCount;", "bool mEnabled;" }));
+    QCOMPARE(printer.memberLayoutSavings().value(QStringLiteral("Layout")), 8);
+
+    // The initializers follow the declaration order
+    const QStringList implementation = printedLines(dir, QStringLiteral("layout.cpp"));
+    const int constructorLine = implementation.indexOf("Layout::Layout( int count )");
+    QVERIFY(constructorLine >= 0);
+    QCOMPARE(implementation.at(constructorLine + 1),
+             QStringLiteral(": mRatio( 1.0 ), mCount( count ), mEnabled( true )"));
+}
+
+static File codeFile(const QString &name, const QString &fileCode)
+{
+    Code code;
+    code.addBlock(fileCode);
+    File file;
+    file.setFilename(name);
+    file.addFileCode(code);
+    return file;
+}
+
+void PrinterTest::unityFileCode()
+{
+    const File::List files = {
+        codeFile(QStringLiteral("a"), QStringLiteral("static int helper()\n{\n    return 1;\n}")),
+        codeFile(QStringLiteral("b"), QStringLiteral("namespace {\nint helper() { return 2; }\n}")),
+        codeFile(QStringLiteral("c"), QStringLiteral("static int other() { return helper(); }")),
+    };
+
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    Printer printer;
+    printer.setOutputDirectory(dir.path());
+    const QStringList unityFiles = printer.printUnityImplementations(files, QStringLiteral("all"));
+
+    // Both a and b define a static helper(), c only uses it
+    QCOMPARE(unityFiles,
+             QStringList({ QStringLiteral("all_unity_0.cpp"), QStringLiteral("all_unity_1.cpp") }));
+    QCOMPARE(printedLines(dir, unityFiles.at(0)).filter("#include"),
+             QStringList({ "#include \"a.cpp\"", "#include \"c.cpp\"" }));
+    QCOMPARE(printedLines(dir, unityFiles.at(1)).filter("#include"),
+             QStringList({ "#include \"b.cpp\"" }));
+}
+
+static Class shardClass(const QString &name)
+{
+    Class cl(name);
+    Function run(QStringLiteral("run"), QStringLiteral("int"));
+    run.setBody(QStringLiteral("return helper() + shared() + sCounter + sLimit;"));
+    cl.addFunction(run);
+    return cl;
+}
+
+void PrinterTest::shardFileContent()
+{
+    File file = codeFile(QStringLiteral("sharded"), QStringLiteral("static const int sLimit = 3;"));
+    file.addExternCDeclaration(QStringLiteral("int c_api(void)"));
+    file.addFileVariable(Variable(QStringLiteral("sCounter"), QStringLiteral("int"), true));
+    Function helper(QStringLiteral("helper"), QStringLiteral("int"), Function::Public, true);
+    helper.setBody(QStringLiteral("return 1;"));
+    file.addFileFunction(helper);
+    Function shared(QStringLiteral("shared"), QStringLiteral("int"));
+    shared.setBody(QStringLiteral("return 2;"));
+    file.addFileFunction(shared);
+    file.insertClass(shardClass(QStringLiteral("A")));
+    file.insertClass(shardClass(QStringLiteral("B")));
+
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    Printer printer;
+    printer.setOutputDirectory(dir.path());
+    const QStringList shards = printer.printShardedImplementation(file, 2);
+    QCOMPARE(shards.count(), 2);
+
+    // The first shard defines what has external linkage
+    const QStringList first = printedLines(dir, shards.at(0));
+    QVERIFY(first.contains("int sCounter;"));
+    QVERIFY(first.contains("int shared()"));
+    QVERIFY(first.contains("return 2;"));
+
+    // Every shard sees all of the file content
+    for (const QString &shard : shards) {
+        const QStringList lines = printedLines(dir, shard);
+        QVERIFY(lines.contains("extern \"C\" {"));
+        QVERIFY(lines.contains("int c_api(void);"));
+        QVERIFY(lines.contains("static const int sLimit = 3;"));
+        QVERIFY(lines.contains("static int helper()"));
+        QCOMPARE(lines.filter("::run()").count(), 1);
+    }
+    const QStringList second = printedLines(dir, shards.at(1));
+    QVERIFY(second.contains("extern int sCounter;"));
+    QVERIFY(second.contains("int shared();"));
+    QVERIFY(!second.contains("return 2;"));
+}
+
+void PrinterTest::depfile()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    Printer printer;
+    printer.setOutputDirectory(dir.path());
+    printer.setDependencies(
+            { QStringLiteral("/schemas/my schema.xsd"), QStringLiteral("/schemas/a#$b.xsd") });
+
+    const File file = codeFile(QStringLiteral("deps"), QStringLiteral("static int sValue = 1;"));
+    printer.printHeader(file);
+    printer.printImplementation(file);
+    printer.printImplementation(file);
+
+    const QStringList printed = printer.printedFiles();
+    QCOMPARE(printed, QStringList({ dir.filePath(QStringLiteral("deps.h")),
+                                    dir.filePath(QStringLiteral("deps.cpp")) }));
+
+    const QString depfile = dir.filePath(QStringLiteral("deps.d"));
+    printer.printDepfile(depfile);
+    QFile deps(depfile);
+    QVERIFY(deps.open(QIODevice::ReadOnly));
+    const QString dependencies = QStringLiteral(" \\\n  /schemas/my\\ schema.xsd"
+                                                " \\\n  /schemas/a\\#$$b.xsd\n");
+    QCOMPARE(QString::fromLocal8Bit(deps.readAll()),
+             printed.at(0) + ':' + dependencies + printed.at(1) + ':' + dependencies);
+}
+
+static void writeFile(const QString &fileName, const QByteArray &content)
+{
+    QFile file(fileName);
+    QVERIFY(file.open(QIODevice::WriteOnly));
+    file.write(content);
+}
+
+static QByteArray readFile(const QString &fileName)
+{
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly))
+        return QByteArray();
+    return file.readAll();
+}
+
+void PrinterTest::unchangedFiles()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString fingerprints = dir.filePath(QStringLiteral("fingerprints"));
+    const QString header = dir.filePath(QStringLiteral("layout.h"));
+    const QString implementation = dir.filePath(QStringLiteral("layout.cpp"));
+    File file;
+    file.setFilename(QStringLiteral("layout"));
+    file.insertClass(shardClass(QStringLiteral("A")));
+    {
+        Printer printer;
+        printer.setOutputDirectory(dir.path());
+        printer.setFingerprintFile(fingerprints);
+        printer.printHeader(file);
+        printer.printImplementation(file);
+        printer.writeFingerprints();
+    }
+
+    // Files printed from the same model are left alone, but still count as printed
+    writeFile(header, "unchanged");
+    writeFile(implementation, "unchanged");
+    {
+        Printer printer;
+        printer.setOutputDirectory(dir.path());
+        printer.setFingerprintFile(fingerprints);
+        printer.printHeader(file);
+        printer.printImplementation(file);
+        QCOMPARE(printer.printedFiles(), QStringList({ header, implementation }));
+        printer.writeFingerprints();
+    }
+    QCOMPARE(readFile(header), QByteArray("unchanged"));
+    QCOMPARE(readFile(implementation), QByteArray("unchanged"));
+
+    // A different model or different arguments render the files again
+    file.insertClass(shardClass(QStringLiteral("B")));
+    Printer printer;
+    printer.setOutputDirectory(dir.path());
+    printer.setFingerprintFile(fingerprints);
+    printer.printHeader(file);
+    printer.printImplementation(file, false);
+    QVERIFY(readFile(header).contains("class B"));
+    QVERIFY(readFile(implementation).contains("B::run()"));
+}
+
+void PrinterTest::unchangedShards()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString fingerprints = dir.filePath(QStringLiteral("fingerprints"));
+    File file;
+    file.setFilename(QStringLiteral("sharded"));
+    file.insertClass(shardClass(QStringLiteral("A")));
+    file.insertClass(shardClass(QStringLiteral("B")));
+    {
+        Printer printer;
+        printer.setOutputDirectory(dir.path());
+        printer.setFingerprintFile(fingerprints);
+        QCOMPARE(printer.printShardedImplementation(file, 2),
+                 QStringList({ QStringLiteral("sharded_0.cpp"), QStringLiteral("sharded_1.cpp") }));
+        printer.writeFingerprints();
+    }
+
+    // Only the shard which is missing is printed again
+    const QString first = dir.filePath(QStringLiteral("sharded_0.cpp"));
+    const QString second = dir.filePath(QStringLiteral("sharded_1.cpp"));
+    writeFile(first, "unchanged");
+    QVERIFY(QFile::remove(second));
+    {
+        Printer printer;
+        printer.setOutputDirectory(dir.path());
+        printer.setFingerprintFile(fingerprints);
+        printer.printShardedImplementation(file, 2);
+        QCOMPARE(printer.printedFiles(), QStringList({ first, second }));
+        printer.writeFingerprints();
+    }
+    QCOMPARE(readFile(first), QByteArray("unchanged"));
+    QVERIFY(readFile(second).contains("::run()"));
+
+    // Another shard count distributes the classes differently
+    Printer printer;
+    printer.setOutputDirectory(dir.path());
+    printer.setFingerprintFile(fingerprints);
+    printer.printShardedImplementation(file, 1);
+    QVERIFY(readFile(first).contains("::run()"));
+}
+
+QTEST_MAIN(PrinterTest)
+#include "tst_printer.moc"
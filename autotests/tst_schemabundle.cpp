@@ -0,0 +1,171 @@
+#include "parser.h"
+
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QTemporaryDir>
+#include <QTest>
+
+#include <common/fileprovider.h>
+#include <common/messagehandler.h>
+#include <common/nsmanager.h>
+#include <common/parsercontext.h>
+#include <common/schemabundle.h>
+
+using namespace XSD;
+
+class SchemaBundleTest : public QObject
+{
+    Q_OBJECT
+private Q_SLOTS:
+    void writeAndOpen_data();
+    void writeAndOpen();
+    void invalidBundle();
+    void parserBundle();
+    void cleanupTestCase();
+
+private:
+    QTemporaryDir mDir;
+};
+
+static void writeFile(const QString &fileName, const QByteArray &data)
+{
+    QFile file(fileName);
+    QVERIFY(file.open(QIODevice::WriteOnly));
+    file.write(data);
+}
+
+void SchemaBundleTest::writeAndOpen_data()
+{
+    QTest::addColumn<int>("compression");
+    QTest::newRow("uncompressed") << int(SchemaBundle::Uncompressed);
+    QTest::newRow("compressed") << int(SchemaBundle::Compressed);
+}
+
+void SchemaBundleTest::writeAndOpen()
+{
+    QFETCH(int, compression);
+
+    QMap<QUrl, QByteArray> documents;
+    documents.insert(QUrl(QStringLiteral("http://example.com/a.xsd")),
+                     QByteArray("<schema>") + QByteArray(1000, ' ') + "</schema>");
+    documents.insert(QUrl(QStringLiteral("http://example.com/b.xsd")), QByteArray("<schema/>"));
+    documents.insert(QUrl(QStringLiteral("http://example.com/empty.xsd")), QByteArray(""));
+
+    const QString fileName = mDir.filePath(QStringLiteral("bundle.ksb"));
+    QString errorString;
+    QVERIFY(SchemaBundle::write(fileName, documents,
+                                SchemaBundle::Compression(compression), &errorString));
+    if (compression == SchemaBundle::Compressed) {
+        QVERIFY(QFileInfo(fileName).size() < 1000);
+    }
+
+    SchemaBundle bundle;
+    QVERIFY2(bundle.open(fileName), qPrintable(bundle.errorString()));
+    QVERIFY(bundle.isOpen());
+    QCOMPARE(bundle.urls().count(), 3);
+    for (auto it = documents.constBegin(); it != documents.constEnd(); ++it) {
+        QVERIFY(bundle.contains(it.key()));
+        QCOMPARE(bundle.document(it.key()), it.value());
+        QVERIFY(!bundle.document(it.key()).isNull());
+    }
+    QVERIFY(!bundle.contains(QUrl(QStringLiteral("http://example.com/c.xsd"))));
+    QVERIFY(bundle.document(QUrl(QStringLiteral("http://example.com/c.xsd"))).isNull());
+
+    bundle.close();
+    QVERIFY(!bundle.isOpen());
+}
+
+void SchemaBundleTest::invalidBundle()
+{
+    SchemaBundle bundle;
+    QVERIFY(!bundle.open(mDir.filePath(QStringLiteral("none.ksb"))));
+    QVERIFY(!bundle.errorString().isEmpty());
+
+    const QString fileName = mDir.filePath(QStringLiteral("invalid.ksb"));
+    writeFile(fileName, QByteArray("<schema/> is not a bundle"));
+    QVERIFY(!bundle.open(fileName));
+    QVERIFY(!bundle.isOpen());
+
+    // A truncated bundle is rejected instead of reading past the end
+    const QString validName = mDir.filePath(QStringLiteral("valid.ksb"));
+    QMap<QUrl, QByteArray> documents;
+    documents.insert(QUrl(QStringLiteral("http://example.com/a.xsd")), QByteArray("<schema/>"));
+    QVERIFY(SchemaBundle::write(validName, documents));
+    QFile valid(validName);
+    QVERIFY(valid.open(QIODevice::ReadOnly));
+    QByteArray truncated = valid.readAll();
+    truncated.chop(4);
+    writeFile(fileName, truncated);
+    QVERIFY(!bundle.open(fileName));
+
+    // An uncompressed entry claiming more bytes than are stored would read past the mapping
+    QVERIFY(valid.seek(0));
+    QByteArray oversized = valid.readAll();
+    oversized[24 + 28] = char(0xff);
+    writeFile(fileName, oversized);
+    QVERIFY(!bundle.open(fileName));
+    QVERIFY(bundle.errorString().contains(QLatin1String("corrupt")));
+}
+
+void SchemaBundleTest::parserBundle()
+{
+    QVERIFY(QDir(mDir.path()).mkpath(QStringLiteral("build")));
+    QVERIFY(QDir(mDir.path()).mkpath(QStringLiteral("deploy")));
+    const QString mainName = mDir.filePath(QStringLiteral("build/main.xsd"));
+    writeFile(mainName,
+              QByteArray("<xs:schema xmlns:xs=\"http://www.w3.org/2001/XMLSchema\""
+              " targetNamespace=\"urn:main\">"
+              "  <xs:import namespace=\"urn:other\" schemaLocation=\"other.xsd\"/>"
+              "</xs:schema>"));
+    writeFile(mDir.filePath(QStringLiteral("build/other.xsd")),
+              QByteArray("<xs:schema xmlns:xs=\"http://www.w3.org/2001/XMLSchema\""
+              " targetNamespace=\"urn:other\">"
+              "  <xs:complexType name=\"Part\"/>"
+              "</xs:schema>"));
+
+    const auto parse = [](Parser &parser, const QString &fileName) {
+        NSManager namespaceManager;
+        MessageHandler messageHandler;
+        ParserContext context;
+        context.setNamespaceManager(&namespaceManager);
+        context.setMessageHandler(&messageHandler);
+        context.setDocumentBaseUrlFromFileUrl(QUrl::fromLocalFile(fileName));
+        QFile file(fileName);
+        return file.open(QIODevice::ReadOnly) && parser.parseFile(&context, file);
+    };
+
+    const QString bundleName = mDir.filePath(QStringLiteral("build/schemas.ksb"));
+    {
+        Parser parser;
+        QVERIFY(parse(parser, mainName));
+        QCOMPARE(parser.types().complexTypes().count(), 1);
+        QVERIFY(parser.writeBundle(bundleName, SchemaBundle::Compressed));
+    }
+
+    // The bundle holds the root schema too, relative to the bundle
+    const QString deployedBundle = mDir.filePath(QStringLiteral("deploy/schemas.ksb"));
+    QVERIFY(QFile::copy(bundleName, deployedBundle));
+    SchemaBundle bundle;
+    QVERIFY(bundle.open(deployedBundle));
+    QCOMPARE(bundle.urls().count(), 2);
+    const QString deployedMain = mDir.filePath(QStringLiteral("deploy/main.xsd"));
+    writeFile(deployedMain, bundle.document(QUrl::fromLocalFile(deployedMain)));
+    bundle.close();
+
+    // The imported schema only exists in the moved bundle
+    QVERIFY(FileProvider::mountBundle(deployedBundle));
+    Parser parser;
+    QVERIFY(parse(parser, deployedMain));
+    QCOMPARE(parser.types().complexTypes().count(), 1);
+    QCOMPARE(parser.types().complexTypes().first().name(), QStringLiteral("Part"));
+    QCOMPARE(parser.sourceFiles().count(), 1);
+}
+
+void SchemaBundleTest::cleanupTestCase()
+{
+    FileProvider::unmountBundles();
+}
+
+QTEST_MAIN(SchemaBundleTest)
+#include "tst_schemabundle.moc"
@@ -0,0 +1,226 @@
+#include "simpletypevalidator.h"
+
+#include <QTest>
+
+using namespace XSD;
+
+class SimpleTypeValidatorTest : public QObject
+{
+    Q_OBJECT
+private Q_SLOTS:
+    void facets();
+    void baseTypeChain();
+    void list();
+    void ranges();
+    void binaryLength();
+    void nameCharacterClasses();
+    void unionBase();
+    void moveAndAssign();
+    void benchmark();
+};
+
+static const QString xsd = QStringLiteral("http://www.w3.org/2001/XMLSchema");
+
+static SimpleType createType(const QString &name, const QName &baseTypeName)
+{
+    SimpleType type("ns");
+    type.setName(name);
+    type.setBaseTypeName(baseTypeName);
+    return type;
+}
+
+void SimpleTypeValidatorTest::facets()
+{
+    SimpleType code = createType("code", QName(xsd, "string"));
+    code.setFacetValue(SimpleType::PATTERN, "[A-Z]{2}\\d+");
+    code.setFacetValue(SimpleType::MAXLEN, "5");
+    const SimpleTypeValidator validator(code);
+    QCOMPARE(validator.builtinType(), QString("string"));
+    QVERIFY(validator.validate("AB12"));
+    QVERIFY(!validator.validate("AB123456"));
+    QVERIFY(!validator.validate("xAB12"));
+    QString error;
+    QVERIFY(!validator.validate("12", &error));
+    QVERIFY(!error.isEmpty());
+
+    SimpleType color = createType("color", QName(xsd, "token"));
+    color.setFacetValue(SimpleType::ENUM, "red");
+    color.setFacetValue(SimpleType::ENUM, "green");
+    const SimpleTypeValidator colorValidator(color);
+    QVERIFY(colorValidator.validate(" red "));
+    QVERIFY(!colorValidator.validate("blue"));
+}
+
+void SimpleTypeValidatorTest::baseTypeChain()
+{
+    SimpleType percent = createType("percent", QName(xsd, "int"));
+    percent.setFacetValue(SimpleType::MININC, "0");
+    percent.setFacetValue(SimpleType::MAXINC, "100");
+    SimpleType smallPercent = createType("smallPercent", QName("ns", "percent"));
+    smallPercent.setFacetValue(SimpleType::MAXEX, "10");
+    Types types;
+    SimpleType::List simpleTypes;
+    simpleTypes.append(percent);
+    simpleTypes.append(smallPercent);
+    types.setSimpleTypes(simpleTypes);
+
+    const SimpleTypeValidator validator(smallPercent, types);
+    QCOMPARE(validator.builtinType(), QString("int"));
+    QVERIFY(validator.validate("9"));
+    QVERIFY(!validator.validate("10"));
+    QVERIFY(!validator.validate("-1"));
+    QVERIFY(!validator.validate("1.5"));
+    QVERIFY(!validator.validate("abc"));
+}
+
+void SimpleTypeValidatorTest::list()
+{
+    SimpleType numbers("ns");
+    numbers.setName("numbers");
+    numbers.setSubType(SimpleType::TypeList);
+    numbers.setListTypeName(QName(xsd, "unsignedByte"));
+    numbers.setFacetValue(SimpleType::MAXLEN, "3");
+    const SimpleTypeValidator validator(numbers);
+    QVERIFY(validator.validate(" 1 2\t255 "));
+    QVERIFY(!validator.validate("1 2 256"));
+    QVERIFY(!validator.validate("1 2 3 4"));
+}
+
+void SimpleTypeValidatorTest::ranges()
+{
+    SimpleType half = createType("half", QName(xsd, "decimal"));
+    half.setFacetValue(SimpleType::MININC, "0.5");
+    half.setFacetValue(SimpleType::MAXEX, "1");
+    const SimpleTypeValidator halfValidator(half);
+    QVERIFY(halfValidator.validate("0.5"));
+    QVERIFY(halfValidator.validate("00.9990"));
+    QVERIFY(!halfValidator.validate("0.49999999999999999999"));
+    QVERIFY(!halfValidator.validate("1.0"));
+
+    // Bounds beyond the precision of a double
+    SimpleType big = createType("big", QName(xsd, "integer"));
+    big.setFacetValue(SimpleType::MAXINC, "100000000000000000000");
+    const SimpleTypeValidator bigValidator(big);
+    QVERIFY(bigValidator.validate("100000000000000000000"));
+    QVERIFY(!bigValidator.validate("100000000000000000001"));
+    QVERIFY(bigValidator.validate("-100000000000000000001"));
+
+    const SimpleTypeValidator longValidator(createType("l", QName(xsd, "long")));
+    QVERIFY(longValidator.validate("9223372036854775807"));
+    QVERIFY(!longValidator.validate("9223372036854775808"));
+
+    SimpleType ratio = createType("ratio", QName(xsd, "double"));
+    ratio.setFacetValue(SimpleType::MINEX, "-INF");
+    ratio.setFacetValue(SimpleType::MAXINC, "1.5");
+    const SimpleTypeValidator ratioValidator(ratio);
+    QVERIFY(ratioValidator.validate("1.5E0"));
+    QVERIFY(!ratioValidator.validate("1.6"));
+    QVERIFY(!ratioValidator.validate("NaN"));
+
+    // Range facets of non-numeric types are not compared as numbers
+    SimpleType since = createType("since", QName(xsd, "date"));
+    since.setFacetValue(SimpleType::MININC, "2000-01-01");
+    const SimpleTypeValidator sinceValidator(since);
+    QVERIFY(sinceValidator.validate("2020-05-01"));
+}
+
+void SimpleTypeValidatorTest::binaryLength()
+{
+    SimpleType key = createType("key", QName(xsd, "base64Binary"));
+    key.setFacetValue(SimpleType::LENGTH, "4");
+    const SimpleTypeValidator validator(key);
+    QVERIFY(validator.validate("AAECAw=="));
+    QVERIFY(validator.validate("AAEC Aw=="));
+    QVERIFY(!validator.validate("AAECAwQ="));
+    QVERIFY(!validator.validate("AAEC"));
+
+    SimpleType hash = createType("hash", QName(xsd, "hexBinary"));
+    hash.setFacetValue(SimpleType::MAXLEN, "2");
+    const SimpleTypeValidator hashValidator(hash);
+    QVERIFY(hashValidator.validate("0aFF"));
+    QVERIFY(!hashValidator.validate("0aFF00"));
+}
+
+void SimpleTypeValidatorTest::nameCharacterClasses()
+{
+    SimpleType name = createType("name", QName(xsd, "string"));
+    name.setFacetValue(SimpleType::PATTERN, "\\i\\c*");
+    const SimpleTypeValidator validator(name);
+    QVERIFY(validator.validate("_a-1"));
+    QVERIFY(!validator.validate("1a"));
+
+    // Within a character class the escapes stand for their characters
+    SimpleType mixed = createType("mixed", QName(xsd, "string"));
+    mixed.setFacetValue(SimpleType::PATTERN, "[\\i0-9][a\\c]*[\\I]");
+    const SimpleTypeValidator mixedValidator(mixed);
+    QVERIFY(mixedValidator.validate("1a-b "));
+    QVERIFY(mixedValidator.validate("x.2!"));
+    QVERIFY(!mixedValidator.validate("-ab!"));
+    QVERIFY(!mixedValidator.validate("ab a"));
+    QVERIFY(!mixedValidator.validate("abc"));
+
+    SimpleType other = createType("other", QName(xsd, "string"));
+    other.setFacetValue(SimpleType::PATTERN, "[\\C]+");
+    const SimpleTypeValidator otherValidator(other);
+    QVERIFY(otherValidator.validate("! ?"));
+    QVERIFY(!otherValidator.validate("!-"));
+}
+
+void SimpleTypeValidatorTest::unionBase()
+{
+    SimpleType sizes("ns");
+    sizes.setName("sizes");
+    sizes.setSubType(SimpleType::TypeUnion);
+    SimpleType small = createType("small", QName("ns", "sizes"));
+    small.setFacetValue(SimpleType::ENUM, "S");
+    small.setFacetValue(SimpleType::ENUM, "XS");
+    Types types;
+    SimpleType::List simpleTypes;
+    simpleTypes.append(sizes);
+    simpleTypes.append(small);
+    types.setSimpleTypes(simpleTypes);
+
+    // The members of the union are not known
+    const SimpleTypeValidator unionValidator(sizes, types);
+    QVERIFY(unionValidator.validate("anything"));
+
+    // The facets of the derived type still apply
+    const SimpleTypeValidator validator(small, types);
+    QVERIFY(validator.validate("XS"));
+    QVERIFY(!validator.validate("XL"));
+}
+
+void SimpleTypeValidatorTest::moveAndAssign()
+{
+    SimpleType code = createType("code", QName(xsd, "string"));
+    code.setFacetValue(SimpleType::MAXLEN, "2");
+    const SimpleTypeValidator validator(code);
+
+    SimpleTypeValidator moved(validator);
+    SimpleTypeValidator target(std::move(moved));
+    QVERIFY(!target.validate("abc"));
+
+    // A moved-from validator can be assigned to again
+    moved = validator;
+    QVERIFY(moved.validate("ab"));
+    QVERIFY(!moved.validate("abc"));
+    moved = SimpleTypeValidator();
+    QVERIFY(moved.validate("abc"));
+}
+
+void SimpleTypeValidatorTest::benchmark()
+{
+    SimpleType code = createType("code", QName(xsd, "string"));
+    code.setFacetValue(SimpleType::PATTERN, "[A-Z]{2}\\d{4}");
+    for (int i = 0; i < 100; ++i)
+        code.setFacetValue(SimpleType::ENUM, QString("AB%1").arg(1000 + i));
+    const SimpleTypeValidator validator(code);
+    const QString value = QStringLiteral("AB1050");
+
+    QBENCHMARK {
+        QVERIFY(validator.validate(value));
+    }
+}
+
+QTEST_MAIN(SimpleTypeValidatorTest)
+#include "tst_simpletypevalidator.moc"
@@ -0,0 +1,119 @@
+#include "statemachines.h"
+#include "teststatemachine.h"
+
+#include <QTest>
+#include <QVector>
+
+using namespace KODE;
+
+class StateMachineTest : public QObject
+{
+    Q_OBJECT
+private Q_SLOTS:
+    void transitionTable();
+    void dispatchHandlers();
+    void noTransitions();
+    void benchmark_data();
+    void benchmark();
+};
+
+static QStringList lines(const Code &code)
+{
+    QStringList result;
+    const QStringList text = code.text().split(QLatin1Char('\n'));
+    for (const QString &line : text)
+        result.append(line.trimmed());
+    return result;
+}
+
+void StateMachineTest::transitionTable()
+{
+    const StateMachine machine = createTestMachine(StateMachine::TableEmission);
+    const QStringList definition = lines(machine.stateDefinition());
+    QVERIFY(definition.contains("enum class State : int { Content = 0, Element = 1, Idle = 2 };"));
+    QVERIFY(definition.contains("State state = State::Idle;"));
+
+    const QStringList table = lines(machine.transitionTable());
+    QVERIFY(table.contains("enum class Event : int { Open = 0, Text = 1, Close = 2 };"));
+    QVERIFY(table.contains("{ State::Element, State::Content, State::Idle }, // Content"));
+    QVERIFY(table.contains("{ State::Element, State::Content, State::Content }, // Element"));
+    QVERIFY(table.contains("{ State::Element, State::Idle, State::Idle }, // Idle"));
+
+    const QStringList transition = lines(machine.transition(QStringLiteral("event")));
+    QVERIFY(transition.contains(
+            "state = transitions[static_cast<int>(state)][static_cast<int>(event)];"));
+}
+
+void StateMachineTest::dispatchHandlers()
+{
+    const StateMachine machine = createTestMachine(StateMachine::DispatchEmission);
+    const QStringList definition = lines(machine.stateDefinition());
+    QVERIFY(definition.contains("using StateHandler = void (*)(State &state, int *counts);"));
+    // Handlers which do not use all parameters must not trigger -Wunused-parameter
+    const QString handler =
+            QStringLiteral("[]([[maybe_unused]] State &state, [[maybe_unused]] int *counts) {");
+    QCOMPARE(definition.count(handler), 3);
+    QVERIFY(definition.contains("++counts[0];"));
+
+    const QStringList logic = lines(machine.transitionLogic());
+    QVERIFY(logic.contains("stateHandlers[static_cast<int>(state)](state, counts);"));
+}
+
+void StateMachineTest::noTransitions()
+{
+    StateMachine machine;
+    machine.setEmissionMode(StateMachine::TableEmission);
+    const QString table = machine.transitionTable().text();
+    QVERIFY(table.contains("static constexpr int eventCount = 0;"));
+    QVERIFY(!table.contains("transitions["));
+    QVERIFY(!machine.stateDefinition().text().contains("stateNames["));
+}
+
+// The machines of the benchmark are printed by statemachinegenerator from
+// createTestMachine(), so the code which is timed is what the modes emit
+void StateMachineTest::benchmark_data()
+{
+    QTest::addColumn<int>("mode");
+    QTest::newRow("switch") << int(StateMachine::SwitchEmission);
+    QTest::newRow("table") << int(StateMachine::TableEmission);
+    QTest::newRow("dispatch") << int(StateMachine::DispatchEmission);
+}
+
+void StateMachineTest::benchmark()
+{
+    QFETCH(int, mode);
+
+    // A reproducible stream of events, like the tokens of a document
+    QVector<int> events(100000);
+    quint32 seed = 1;
+    for (int &event : events) {
+        seed = seed * 1103515245 + 12345;
+        event = int((seed >> 16) % 3);
+    }
+
+    // The transitions of createTestMachine(), by state and event
+    static const int transitions[3][3] = { { 1, 0, 2 }, { 1, 0, 0 }, { 1, 2, 2 } };
+    int expected[3] = {};
+    int state = 2;
+    for (const int event : std::as_const(events)) {
+        ++expected[state];
+        state = transitions[state][event];
+    }
+
+    int counts[3] = {};
+    QBENCHMARK {
+        counts[0] = counts[1] = counts[2] = 0;
+        if (mode == StateMachine::SwitchEmission)
+            SwitchMachine().run(events, counts);
+        else if (mode == StateMachine::TableEmission)
+            TableMachine().run(events, counts);
+        else
+            DispatchMachine().run(events, counts);
+    }
+    QCOMPARE(counts[0], expected[0]);
+    QCOMPARE(counts[1], expected[1]);
+    QCOMPARE(counts[2], expected[2]);
+}
+
+QTEST_MAIN(StateMachineTest)
+#include "tst_statemachine.moc"
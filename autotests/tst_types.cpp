@@ -0,0 +1,157 @@
+#include "types.h"
+#include "typesregistry.h"
+
+#include <QTest>
+
+using namespace XSD;
+
+class TypesTest : public QObject
+{
+    Q_OBJECT
+private Q_SLOTS:
+    void simpleTypeLookup();
+    void typeHierarchy();
+    void reachableTypes();
+    void registry();
+};
+
+static SimpleType createSimpleType(const QString &name, const QString &elementName)
+{
+    SimpleType type("ns");
+    type.setName(name);
+    type.setElementName(elementName);
+    return type;
+}
+
+void TypesTest::simpleTypeLookup()
+{
+    Types types;
+    SimpleType::List simpleTypes;
+    simpleTypes.append(createSimpleType("code", "first"));
+    simpleTypes.append(createSimpleType("code", "second"));
+    types.setSimpleTypes(simpleTypes);
+
+    QCOMPARE(types.simpleType(QName("ns", "code")).elementName(), "first");
+    QCOMPARE(types.simpleType(QName("ns", "code"), "second").elementName(), "second");
+    QVERIFY(types.simpleType(QName("ns", "code"), "third").isNull());
+    QVERIFY(types.simpleType(QName("ns", "other")).isNull());
+
+    Types more;
+    SimpleType::List moreTypes;
+    moreTypes.append(createSimpleType("other", "third"));
+    moreTypes.append(createSimpleType("code", "first"));
+    more.setSimpleTypes(moreTypes);
+    types += more;
+    QCOMPARE(types.simpleType(QName("ns", "other"), "third").name(), "other");
+    QCOMPARE(types.simpleTypes().count(), 4);
+}
+
+static ComplexType createComplexType(const QString &name, const QString &baseName)
+{
+    ComplexType type("ns");
+    type.setName(name);
+    if (!baseName.isEmpty())
+        type.setBaseTypeName(QName("ns", baseName));
+    return type;
+}
+
+void TypesTest::typeHierarchy()
+{
+    ComplexType::List complexTypes;
+    ComplexType root = createComplexType("root", QString());
+    root.addDerivedType(QName("ns", "middle"));
+    complexTypes.append(root);
+    complexTypes.append(createComplexType("leaf", "middle"));
+    complexTypes.append(createComplexType("middle", "root"));
+    complexTypes.append(createComplexType("other", "root"));
+    complexTypes.append(createComplexType("unrelated", QString()));
+    Types types;
+    types.setComplexTypes(complexTypes);
+
+    QCOMPARE(types.complexType(QName("ns", "leaf")).baseTypeName(), QName("ns", "middle"));
+    QVERIFY(types.complexType(QName("ns", "missing")).isNull());
+
+    const QName::List derived = types.derivedTypes(QName("ns", "root"));
+    QCOMPARE(derived.count(), 3);
+    QCOMPARE(derived.at(0), QName("ns", "middle"));
+    QCOMPARE(derived.at(1), QName("ns", "leaf"));
+    QCOMPARE(derived.at(2), QName("ns", "other"));
+    QCOMPARE(types.derivedTypes(QName("ns", "root"), false).count(), 2);
+    QVERIFY(types.derivedTypes(QName("ns", "unrelated")).isEmpty());
+
+    QVERIFY(types.isDerivedFrom(QName("ns", "leaf"), QName("ns", "root")));
+    QVERIFY(!types.isDerivedFrom(QName("ns", "root"), QName("ns", "leaf")));
+    QVERIFY(!types.isDerivedFrom(QName("ns", "other"), QName("ns", "middle")));
+    QCOMPARE(types.derivationDepth(QName("ns", "leaf")), 2);
+    QCOMPARE(types.derivationDepth(QName("ns", "missing")), -1);
+
+    const ComplexType leaf = types.complexType(QName("ns", "leaf"));
+    QCOMPARE(types.polymorphicBaseClass(leaf).name(), QString("root"));
+}
+
+void TypesTest::reachableTypes()
+{
+    Element rootElement("ns");
+    rootElement.setName("root");
+    rootElement.setType(QName("ns", "wrapper"));
+    Element unusedElement("ns");
+    unusedElement.setName("unused");
+    unusedElement.setType(QName("ns", "other"));
+
+    Element member("ns");
+    member.setName("member");
+    member.setType(QName("ns", "code"));
+    ComplexType wrapper = createComplexType("wrapper", QString());
+    wrapper.addElement(member);
+
+    ComplexType::List complexTypes;
+    complexTypes.append(wrapper);
+    complexTypes.append(createComplexType("extended", "wrapper"));
+    complexTypes.append(createComplexType("other", QString()));
+    SimpleType::List simpleTypes;
+    simpleTypes.append(createSimpleType("code", QString()));
+    simpleTypes.append(createSimpleType("unusedCode", QString()));
+    Element::List elements;
+    elements.append(rootElement);
+    elements.append(unusedElement);
+
+    Types types;
+    types.setComplexTypes(complexTypes);
+    types.setSimpleTypes(simpleTypes);
+    types.setElements(elements);
+
+    const Types pruned = types.reachableFrom(QName::List() << QName("ns", "root"));
+    QCOMPARE(pruned.elements().count(), 1);
+    QCOMPARE(pruned.elements().at(0).name(), QString("root"));
+    QCOMPARE(pruned.complexTypes().count(), 2);
+    QVERIFY(!pruned.complexType(QName("ns", "extended")).isNull());
+    QVERIFY(pruned.complexType(QName("ns", "other")).isNull());
+    QCOMPARE(pruned.simpleTypes().count(), 1);
+    QCOMPARE(pruned.simpleTypes().at(0).name(), QString("code"));
+}
+
+void TypesTest::registry()
+{
+    TypesRegistry registry;
+    QVERIFY(!registry.acquire());
+
+    Types types;
+    SimpleType::List simpleTypes;
+    simpleTypes.append(createSimpleType("code", QString()));
+    types.setSimpleTypes(simpleTypes);
+    registry.publish(types);
+    QVERIFY(!types.isFrozen());
+
+    const TypesRegistry::Snapshot snapshot = registry.acquire();
+    QVERIFY(snapshot->isFrozen());
+    QCOMPARE(registry.generation(), quint64(1));
+
+    registry.publish(Types());
+    QCOMPARE(registry.generation(), quint64(2));
+    QVERIFY(registry.acquire()->simpleTypes().isEmpty());
+    // Readers keep their snapshot
+    QVERIFY(!snapshot->simpleType(QName("ns", "code")).isNull());
+}
+
+QTEST_MAIN(TypesTest)
+#include "tst_types.moc"
@@ -0,0 +1,136 @@
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QTemporaryDir>
+#include <QTest>
+#include <QUrl>
+
+#include <common/fileprovider.h>
+#include <common/xmlcatalog.h>
+
+class XmlCatalogTest : public QObject
+{
+    Q_OBJECT
+private Q_SLOTS:
+    void initTestCase();
+    void resolve();
+    void delegation();
+    void fileProvider();
+    void errors();
+
+private:
+    QString path(const char *fileName) const;
+    QTemporaryDir mDir;
+};
+
+static const char mainCatalog[] =
+        "<catalog xmlns=\"urn:oasis:names:tc:entity:xmlns:xml:catalog\">\n"
+        "  <uri name=\"http://example.com/a.xsd\" uri=\"local/a.xsd\"/>\n"
+        "  <rewriteURI uriStartString=\"http://example.com/\" rewritePrefix=\"mirror/\"/>\n"
+        "  <rewriteURI uriStartString=\"http://example.com/deep/\" rewritePrefix=\"deep/\"/>\n"
+        "  <group xml:base=\"suffix/\">\n"
+        "    <uriSuffix uriSuffix=\"/common.xsd\" uri=\"common.xsd\"/>\n"
+        "  </group>\n"
+        "  <system systemId=\"http://dtd.org/b.dtd\" uri=\"b.dtd\"/>\n"
+        "  <delegateURI uriStartString=\"http://delegated.org/\" catalog=\"delegate.xml\"/>\n"
+        "  <nextCatalog catalog=\"next.xml\"/>\n"
+        "  <nextCatalog catalog=\"missing.xml\"/>\n"
+        "</catalog>\n";
+
+static const char delegateCatalog[] =
+        "<catalog xmlns=\"urn:oasis:names:tc:entity:xmlns:xml:catalog\">\n"
+        "  <uri name=\"http://delegated.org/x.xsd\" uri=\"delegated/x.xsd\"/>\n"
+        "</catalog>\n";
+
+static const char nextCatalog[] =
+        "<catalog xmlns=\"urn:oasis:names:tc:entity:xmlns:xml:catalog\">\n"
+        "  <uri name=\"http://next.org/y.xsd\" uri=\"next/y.xsd\"/>\n"
+        "  <uri name=\"http://delegated.org/z.xsd\" uri=\"next/z.xsd\"/>\n"
+        "  <nextCatalog catalog=\"catalog.xml\"/>\n"
+        "</catalog>\n";
+
+static void writeFile(const QString &fileName, const QByteArray &data)
+{
+    QFile file(fileName);
+    QVERIFY(file.open(QIODevice::WriteOnly));
+    file.write(data);
+}
+
+QString XmlCatalogTest::path(const char *fileName) const
+{
+    // Catalog entries are resolved against the canonical path of the catalog
+    return QDir(QFileInfo(mDir.path()).canonicalFilePath()).filePath(QLatin1String(fileName));
+}
+
+void XmlCatalogTest::initTestCase()
+{
+    QVERIFY(mDir.isValid());
+    writeFile(path("catalog.xml"), QByteArray(mainCatalog));
+    writeFile(path("delegate.xml"), QByteArray(delegateCatalog));
+    writeFile(path("next.xml"), QByteArray(nextCatalog));
+    writeFile(path("broken.xml"), QByteArray("<catalog"));
+    QVERIFY(QDir(mDir.path()).mkpath(QStringLiteral("local")));
+    writeFile(path("local/a.xsd"), QByteArray("<schema/>"));
+}
+
+void XmlCatalogTest::resolve()
+{
+    XmlCatalog catalog;
+    QVERIFY(catalog.isEmpty());
+    QVERIFY(catalog.load(path("catalog.xml")));
+    QVERIFY(!catalog.isEmpty());
+
+    const auto local = [this](const char *fileName) { return QUrl::fromLocalFile(path(fileName)); };
+    QCOMPARE(catalog.resolveUri(QStringLiteral("http://example.com/a.xsd")), local("local/a.xsd"));
+    QCOMPARE(catalog.resolveUri(QStringLiteral("http://example.com/c/d.xsd")),
+             local("mirror/c/d.xsd"));
+    // The longest start string wins
+    QCOMPARE(catalog.resolveUri(QStringLiteral("http://example.com/deep/e.xsd")),
+             local("deep/e.xsd"));
+    QCOMPARE(catalog.resolveUri(QStringLiteral("http://other.org/common.xsd")),
+             local("suffix/common.xsd"));
+    QCOMPARE(catalog.resolveSystem(QStringLiteral("http://dtd.org/b.dtd")), local("b.dtd"));
+    QVERIFY(catalog.resolveUri(QStringLiteral("http://dtd.org/b.dtd")).isEmpty());
+    QCOMPARE(catalog.resolveUri(QStringLiteral("http://next.org/y.xsd")), local("next/y.xsd"));
+    QVERIFY(catalog.resolveUri(QStringLiteral("http://unknown.org/y.xsd")).isEmpty());
+
+    // resolve() falls back to the system entries
+    QCOMPARE(catalog.resolve(QUrl(QStringLiteral("http://dtd.org/b.dtd"))), local("b.dtd"));
+}
+
+void XmlCatalogTest::delegation()
+{
+    XmlCatalog catalog;
+    QVERIFY(catalog.load(path("catalog.xml")));
+    QCOMPARE(catalog.resolveUri(QStringLiteral("http://delegated.org/x.xsd")),
+             QUrl::fromLocalFile(path("delegated/x.xsd")));
+    // A matching delegate ends the search, the next catalogs are not consulted
+    QVERIFY(catalog.resolveUri(QStringLiteral("http://delegated.org/z.xsd")).isEmpty());
+}
+
+void XmlCatalogTest::fileProvider()
+{
+    XmlCatalog catalog;
+    QVERIFY(catalog.load(path("catalog.xml")));
+
+    FileProvider provider(true);
+    provider.setCatalog(catalog);
+    QString target;
+    QVERIFY(provider.findLocal(QUrl(QStringLiteral("http://example.com/a.xsd")), target));
+    QCOMPARE(target, path("local/a.xsd"));
+    QCOMPARE(provider.resolve(QUrl(QStringLiteral("http://unknown.org/y.xsd"))),
+             QUrl(QStringLiteral("http://unknown.org/y.xsd")));
+}
+
+void XmlCatalogTest::errors()
+{
+    XmlCatalog catalog;
+    QVERIFY(!catalog.load(path("none.xml")));
+    QVERIFY(!catalog.errorString().isEmpty());
+    QVERIFY(!catalog.load(path("broken.xml")));
+    QVERIFY(catalog.errorString().contains(QLatin1String("broken.xml")));
+    QVERIFY(catalog.isEmpty());
+}
+
+QTEST_MAIN(XmlCatalogTest)
+#include "tst_xmlcatalog.moc"
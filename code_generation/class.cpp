@@ -20,6 +20,9 @@
     Boston, MA 02110-1301, USA.
 */
 
+#include <QtCore/QCryptographicHash>
+#include <QtCore/QDataStream>
+
 #include "class.h"
 
 #include <QDebug>
@@ -35,6 +38,7 @@ public:
     QString mDPointer;
     bool mUseSharedData = false;
     bool mCanBeCopied = false;
+    bool mRelocatable = false;
     Function::List mFunctions;
     MemberVariable::List mMemberVariables;
     QStringList mIncludes;
@@ -157,6 +161,16 @@ bool Class::canBeCopied() const
     return d->mCanBeCopied;
 }
 
+void Class::setRelocatable(bool b)
+{
+    d->mRelocatable = b;
+}
+
+bool Class::isRelocatable() const
+{
+    return d->mRelocatable;
+}
+
 void Class::addInclude(const QString &include, const QString &forwardDeclaration)
 {
     if (!include.isEmpty() && !d->mIncludes.contains(include))
@@ -515,3 +529,30 @@ void KODE::Class::setNamespaceAndName(const QString &name)
         d->mName = d->mName.mid(pos + 2);
     }
 }
+
+QByteArray Class::fingerprint() const
+{
+    QByteArray data;
+    QDataStream stream(&data, QIODevice::WriteOnly);
+    stream.setVersion(QDataStream::Qt_5_9);
+    stream << d->mName << d->mNameSpace << d->mExportDeclaration << d->mDPointer
+           << d->mUseSharedData << d->mCanBeCopied << d->mRelocatable << d->mIncludes
+           << d->mForwardDeclarations << d->mDocs << d->mParentClassName << d->mDeclMacros
+           << d->mIsQGadget << d->mIsQObject;
+    for (const Include &include : std::as_const(d->mHeaderIncludes))
+        stream << include.includeFileName << int(include.type);
+    for (const Function &f : std::as_const(d->mFunctions))
+        stream << f.fingerprint();
+    for (const MemberVariable &v : std::as_const(d->mMemberVariables))
+        stream << v.fingerprint();
+    for (const Class &c : std::as_const(d->mBaseClasses))
+        stream << c.fingerprint();
+    for (const Typedef &t : std::as_const(d->mTypedefs))
+        stream << t.fingerprint();
+    for (const Enum &e : std::as_const(d->mEnums))
+        stream << e.fingerprint();
+    for (const Class &c : std::as_const(d->mNestedClasses))
+        stream << c.fingerprint();
+
+    return QCryptographicHash::hash(data, QCryptographicHash::Sha1);
+}
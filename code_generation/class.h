@@ -155,6 +155,10 @@ public:
     /**
      * Sets whether the class can be copied (generates a copy constructor
      * and an operator= implementations, in case a d pointer is used).
+     *
+     * With a d pointer, noexcept move operations are generated as well. The
+     * move constructor takes over the private data of the other instance,
+     * which holds none afterwards and can only be assigned to or destroyed.
      */
     void setCanBeCopied(bool b);
 
@@ -163,6 +167,21 @@ public:
      */
     bool canBeCopied() const;
 
+    /**
+     * Sets whether the class is relocatable, i.e. whether it can be moved in memory
+     * with memcpy(). If set, a Q_DECLARE_TYPEINFO( Class, Q_RELOCATABLE_TYPE ) is
+     * generated after the class declaration (Q_MOVABLE_TYPE with Qt 5), so that
+     * Qt containers can move the instances without calling constructors.
+     *
+     * This holds for classes which only contain a d pointer.
+     */
+    void setRelocatable(bool b);
+
+    /**
+     * Returns whether the class is relocatable.
+     */
+    bool isRelocatable() const;
+
     /**
      * Adds an include to the class object.
      *
@@ -343,6 +362,12 @@ public:
      */
     QStringList declarationMacros() const;
 
+    /**
+     * Returns a hash of the class, which changes whenever the
+     * code generated for it changes.
+     */
+    QByteArray fingerprint() const;
+
 private:
     class Private;
     Private *d;
@@ -19,6 +19,11 @@
     Boston, MA 02110-1301, USA.
 */
 
+#include <QtCore/QCryptographicHash>
+#include <QtCore/QDataStream>
+#include <QtCore/QHash>
+#include <QtCore/QMap>
+#include <QtCore/QSet>
 #include <QtCore/QStringList>
 
 #include "enum.h"
@@ -34,8 +39,207 @@ public:
     bool mCombinable = false;
     bool mTypedef = false;
     bool mIsQENUM = false;
+    bool mStringConversion = false;
+    QStringList mStringValues;
+
+    QByteArray stringValue(int index) const;
+    void printStringConversion(Code &code) const;
+};
+
+namespace {
+
+struct LookupEntry
+{
+    QByteArray mString;
+    QString mValue;
 };
 
+QString cStringLiteral(const QByteArray &string)
+{
+    QString literal = QLatin1String("\"");
+    for (const char c : string) {
+        const uchar u = static_cast<uchar>(c);
+        if (c == '"' || c == '\\') {
+            literal += QLatin1Char('\\');
+            literal += QLatin1Char(c);
+        } else if (u < 0x20 || u >= 0x7f) {
+            literal += QStringLiteral("\\%1").arg(uint(u), 3, 8, QLatin1Char('0'));
+        } else {
+            literal += QLatin1Char(c);
+        }
+    }
+    literal += QLatin1Char('"');
+    return literal;
+}
+
+QString cCharLiteral(char c)
+{
+    const uchar u = static_cast<uchar>(c);
+    if (c == '\'' || c == '\\')
+        return QStringLiteral("'\\%1'").arg(QLatin1Char(c));
+    if (u < 0x20 || u >= 0x7f)
+        return QStringLiteral("'\\%1'").arg(uint(u), 3, 8, QLatin1Char('0'));
+    return QStringLiteral("'%1'").arg(QLatin1Char(c));
+}
+
+/**
+ * Emits a switch over the character of the entries, which all have the same length,
+ * that splits them into the most groups and recurses until each group holds a single entry.
+ */
+void printLookup(Code &code, const QList<LookupEntry> &entries, QSet<int> usedPositions)
+{
+    const int length = int(entries.first().mString.size());
+
+    if (entries.count() == 1) {
+        const LookupEntry &entry = entries.first();
+        if (usedPositions.count() == length) {
+            code += QLatin1String("value = ") + entry.mValue + QLatin1Char(';');
+            code += QLatin1String("return true;");
+        } else {
+            code += QLatin1String("if (std::char_traits<char>::compare(str, ")
+                    + cStringLiteral(entry.mString) + QLatin1String(", ") + QString::number(length)
+                    + QLatin1String(") == 0) {");
+            code.indent();
+            code += QLatin1String("value = ") + entry.mValue + QLatin1Char(';');
+            code += QLatin1String("return true;");
+            code.unindent();
+            code += '}';
+            code += QLatin1String("break;");
+        }
+        return;
+    }
+
+    int position = -1;
+    int groupCount = 0;
+    for (int i = 0; i < length; ++i) {
+        if (usedPositions.contains(i))
+            continue;
+        QSet<char> chars;
+        for (const LookupEntry &entry : entries)
+            chars.insert(entry.mString.at(i));
+        if (chars.count() > groupCount) {
+            position = i;
+            groupCount = chars.count();
+        }
+    }
+    usedPositions.insert(position);
+
+    QList<char> order;
+    QHash<char, QList<LookupEntry>> groups;
+    for (const LookupEntry &entry : entries) {
+        const char c = entry.mString.at(position);
+        if (!groups.contains(c))
+            order.append(c);
+        groups[c].append(entry);
+    }
+
+    code += QLatin1String("switch (str[") + QString::number(position) + QLatin1String("]) {");
+    code.indent();
+    for (const char c : std::as_const(order)) {
+        code += QLatin1String("case ") + cCharLiteral(c) + QLatin1Char(':');
+        code.indent();
+        printLookup(code, groups.value(c), usedPositions);
+        code.unindent();
+    }
+    code.unindent();
+    code += '}';
+    code += QLatin1String("break;");
+}
+
+}
+
+QByteArray Enum::Private::stringValue(int index) const
+{
+    if (index < mStringValues.count())
+        return mStringValues.at(index).toUtf8();
+    return mEnums.at(index).toUtf8();
+}
+
+void Enum::Private::printStringConversion(Code &code) const
+{
+    const int count = mEnums.count();
+    // Prefixed so that it does not clash with the names of the enclosing scope
+    const QString namesTable = QLatin1String("kode_") + mName + QLatin1String("_names");
+
+    QStringList names;
+    for (int i = 0; i < count; ++i)
+        names.append(cStringLiteral(stringValue(i)));
+
+    code += QStringLiteral("static constexpr const char *const %1[%2] = { %3 };")
+                    .arg(namesTable)
+                    .arg(count)
+                    .arg(names.join(QLatin1String(", ")));
+    code.newLine();
+
+    code += QStringLiteral("static constexpr const char *toString(%1 value)").arg(mName);
+    code += '{';
+    code.indent();
+    if (mCombinable) {
+        code += QLatin1String("switch (value) {");
+        code.indent();
+        for (int i = 0; i < count; ++i) {
+            code += QLatin1String("case ") + mEnums.at(i) + QLatin1Char(':');
+            code.indent();
+            code += QStringLiteral("return %1[%2];").arg(namesTable).arg(i);
+            code.unindent();
+        }
+        code += QLatin1String("default:");
+        code.indent();
+        code += QLatin1String("return nullptr;");
+        code.unindent();
+        code.unindent();
+        code += '}';
+    } else {
+        code += QStringLiteral("return static_cast<int>(value) >= 0 && static_cast<int>(value) < "
+                               "%1 ? %2[value] : nullptr;")
+                        .arg(count)
+                        .arg(namesTable);
+    }
+    code.unindent();
+    code += '}';
+    code.newLine();
+
+    // Group the strings by length, the first occurrence of a string wins
+    QMap<int, QList<LookupEntry>> lengths;
+    QSet<QByteArray> seen;
+    for (int i = 0; i < count; ++i) {
+        const QByteArray string = stringValue(i);
+        if (seen.contains(string))
+            continue;
+        seen.insert(string);
+        LookupEntry entry;
+        entry.mString = string;
+        entry.mValue = mEnums.at(i);
+        lengths[string.size()].append(entry);
+    }
+
+    code += QStringLiteral(
+                    "static constexpr bool fromString(const char *str, std::size_t length, %1 &value)")
+                    .arg(mName);
+    code += '{';
+    code.indent();
+    code += QLatin1String("switch (length) {");
+    code.indent();
+    QMap<int, QList<LookupEntry>>::ConstIterator it;
+    for (it = lengths.constBegin(); it != lengths.constEnd(); ++it) {
+        code += QLatin1String("case ") + QString::number(it.key()) + QLatin1Char(':');
+        code.indent();
+        if (it.key() == 0) {
+            code += QLatin1String("value = ") + it.value().first().mValue + QLatin1Char(';');
+            code += QLatin1String("return true;");
+        } else {
+            printLookup(code, it.value(), QSet<int>());
+        }
+        code.unindent();
+    }
+    code.unindent();
+    code += '}';
+    code += QLatin1String("return false;");
+    code.unindent();
+    code += '}';
+    code.newLine();
+}
+
 Enum::Enum() : d(new Private) {}
 
 Enum::Enum(const Enum &other) : d(new Private)
@@ -100,6 +304,9 @@ void Enum::printDeclaration(Code &code) const
     if (d->mIsQENUM)
         code.addLine(QStringLiteral("Q_ENUM(%1)").arg(d->mName));
     code.newLine();
+
+    if (hasStringConversion())
+        d->printStringConversion(code);
 }
 
 void Enum::setIsQENUM(bool qenum)
@@ -111,3 +318,29 @@ void Enum::setTypedef(bool typeDef)
 {
     d->mTypedef = typeDef;
 }
+
+void Enum::setStringConversion(bool conversion)
+{
+    d->mStringConversion = conversion;
+}
+
+bool Enum::hasStringConversion() const
+{
+    return d->mStringConversion && !d->mEnums.isEmpty();
+}
+
+void Enum::setStringValues(const QStringList &values)
+{
+    d->mStringValues = values;
+}
+
+QByteArray Enum::fingerprint() const
+{
+    QByteArray data;
+    QDataStream stream(&data, QIODevice::WriteOnly);
+    stream.setVersion(QDataStream::Qt_5_9);
+    stream << d->mName << d->mEnums << d->mCombinable << d->mTypedef << d->mIsQENUM
+           << d->mStringConversion << d->mStringValues;
+
+    return QCryptographicHash::hash(data, QCryptographicHash::Sha1);
+}
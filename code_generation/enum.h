@@ -92,6 +92,43 @@ public:
      */
     void setTypedef(bool typeDef = true);
 
+    /**
+     * @brief setStringConversion
+     * If set, printDeclaration() additionally generates a constexpr table
+     * kode_<Enum>_names with the string values of the enum, a constexpr
+     * toString(Enum) and a constexpr
+     * fromString(const char *str, std::size_t length, Enum &value) overload.
+     *
+     * fromString() dispatches on the length and on distinguishing characters of the
+     * input, so a lookup does at most one full string comparison. For combinable
+     * enums toString() only maps the single flag values and returns nullptr otherwise.
+     *
+     * The generated code requires C++17, Printer includes <cstddef> and <string>
+     * in headers declaring such an enum.
+     * @param conversion
+     */
+    void setStringConversion(bool conversion = true);
+
+    /**
+     * Returns whether printDeclaration() generates the string conversion.
+     */
+    bool hasStringConversion() const;
+
+    /**
+     * Sets the strings the enum values are converted from and to by the generated
+     * string conversion. By default the names of the enum values are used.
+     * The strings are emitted as UTF-8.
+     *
+     * @param values The string values, in the same order as the enum values.
+     */
+    void setStringValues(const QStringList &values);
+
+    /**
+     * Returns a hash of the enum, which changes whenever the
+     * code generated for it changes.
+     */
+    QByteArray fingerprint() const;
+
 private:
     class Private;
     Private *d;
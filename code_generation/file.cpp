@@ -19,6 +19,8 @@
     Boston, MA 02110-1301, USA.
 */
 
+#include <QtCore/QCryptographicHash>
+#include <QtCore/QDataStream>
 #include <QtCore/QStringList>
 
 #include "file.h"
@@ -286,3 +288,23 @@ void File::clearCode()
     clearFileFunctions();
     clearFileVariables();
 }
+
+QByteArray File::fingerprint() const
+{
+    QByteArray data;
+    QDataStream stream(&data, QIODevice::WriteOnly);
+    stream.setVersion(QDataStream::Qt_5_9);
+    stream << d->mHeaderFilename << d->mImplFilename << d->mNameSpace << d->mProject
+           << d->mCopyrightStrings << d->mLicense.text() << d->mIncludes
+           << d->mExternCDeclarations << d->mFileCode.text();
+    for (const Class &c : std::as_const(d->mClasses))
+        stream << c.fingerprint();
+    for (const Variable &v : std::as_const(d->mFileVariables))
+        stream << v.fingerprint();
+    for (const Function &f : std::as_const(d->mFileFunctions))
+        stream << f.fingerprint();
+    for (const Enum &e : std::as_const(d->mFileEnums))
+        stream << e.fingerprint();
+
+    return QCryptographicHash::hash(data, QCryptographicHash::Sha1);
+}
@@ -36,6 +36,8 @@ namespace KODE {
 class KODE_EXPORT File
 {
 public:
+    typedef QList<File> List;
+
     /**
      * Creates a new file.
      */
@@ -227,6 +229,12 @@ public:
      */
     Code fileCode() const;
 
+    /**
+     * Returns a hash of the file, which changes whenever the
+     * code generated for it changes.
+     */
+    QByteArray fingerprint() const;
+
 private:
     class Private;
     Private *d;
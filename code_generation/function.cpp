@@ -20,6 +20,8 @@
     Boston, MA 02110-1301, USA.
 */
 
+#include <QtCore/QCryptographicHash>
+#include <QtCore/QDataStream>
 #include <QtCore/QStringList>
 #include <QtCore/QDebug>
 
@@ -82,6 +84,10 @@ public:
     bool mIsConst = false;
     bool mIsStatic = false;
     bool mIsExplicit = false;
+    bool mIsNoexcept = false;
+    bool mIsInline = false;
+    bool mIsConstexpr = false;
+    QStringList mAttributes;
     QString mReturnType;
     QString mName;
     Argument::List mArguments;
@@ -270,6 +276,56 @@ void Function::setExplicit(bool isExplicit)
     d->mIsExplicit = isExplicit;
 }
 
+bool Function::isNoexcept() const
+{
+    return d->mIsNoexcept;
+}
+
+void Function::setNoexcept(bool isNoexcept)
+{
+    d->mIsNoexcept = isNoexcept;
+}
+
+bool Function::isInline() const
+{
+    return d->mIsInline;
+}
+
+void Function::setInline(bool isInline)
+{
+    d->mIsInline = isInline;
+}
+
+bool Function::isConstexpr() const
+{
+    return d->mIsConstexpr;
+}
+
+void Function::setConstexpr(bool isConstexpr)
+{
+    d->mIsConstexpr = isConstexpr;
+}
+
+void Function::addAttribute(const QString &attribute)
+{
+    d->mAttributes.append(attribute);
+}
+
+void Function::setAttributes(const QStringList &attributes)
+{
+    d->mAttributes = attributes;
+}
+
+QStringList Function::attributes() const
+{
+    return d->mAttributes;
+}
+
+bool Function::hasInlineDefinition() const
+{
+    return d->mIsInline || d->mIsConstexpr;
+}
+
 bool Function::hasArguments() const
 {
     return !d->mArguments.isEmpty();
@@ -290,3 +346,17 @@ QDebug operator<<(QDebug dbg, const Function &func)
     dbg << func.name();
     return dbg;
 }
+
+QByteArray Function::fingerprint() const
+{
+    QByteArray data;
+    QDataStream stream(&data, QIODevice::WriteOnly);
+    stream.setVersion(QDataStream::Qt_5_9);
+    stream << d->mAccess << d->mIsConst << d->mIsStatic << d->mIsExplicit << d->mIsNoexcept
+           << d->mIsInline << d->mIsConstexpr << d->mAttributes << d->mReturnType << d->mName
+           << d->mInitializers << d->mBody << d->mDocs << int(d->mVirtualMode);
+    for (const Argument &argument : std::as_const(d->mArguments))
+        stream << argument.headerDeclaration() << argument.bodyDeclaration();
+
+    return QCryptographicHash::hash(data, QCryptographicHash::Sha1);
+}
@@ -240,6 +240,73 @@ public:
      */
     bool isExplicit() const;
 
+    /**
+     * Sets whether the function is marked with noexcept specifier.
+     */
+    void setNoexcept(bool isNoexcept = true);
+
+    /**
+     * Returns whether the function is marked with noexcept specifier.
+     */
+    bool isNoexcept() const;
+
+    /**
+     * Sets whether the function is marked with inline specifier.
+     *
+     * Inline member functions are defined in the class declaration in the header,
+     * so that the compiler can inline them across translation units, and inline
+     * file functions after the classes. The private data of d-pointer classes is
+     * only declared in the implementation file, so the functions of such classes
+     * are defined there without the inline specifier.
+     */
+    void setInline(bool isInline = true);
+
+    /**
+     * Returns whether the function is marked with inline specifier.
+     */
+    bool isInline() const;
+
+    /**
+     * Sets whether the function is marked with constexpr specifier.
+     *
+     * Like inline functions, constexpr functions are defined in the header, and
+     * the functions of d-pointer classes are not constexpr.
+     */
+    void setConstexpr(bool isConstexpr = true);
+
+    /**
+     * Returns whether the function is marked with constexpr specifier.
+     */
+    bool isConstexpr() const;
+
+    /**
+     * Adds an @param attribute like "nodiscard" or "deprecated(\"use bar()\")",
+     * which is printed as [[attribute]] in front of the declaration.
+     */
+    void addAttribute(const QString &attribute);
+
+    /**
+     * Sets the @param attributes of the function.
+     */
+    void setAttributes(const QStringList &attributes);
+
+    /**
+     * Returns the attributes of the function.
+     */
+    QStringList attributes() const;
+
+    /**
+     * Returns whether the function is defined in the class declaration,
+     * i.e. whether it is inline or constexpr.
+     */
+    bool hasInlineDefinition() const;
+
+    /**
+     * Returns a hash of the function, which changes whenever the
+     * code generated for it changes.
+     */
+    QByteArray fingerprint() const;
+
 private:
     class FunctionPrivate;
     FunctionPrivate *d;
@@ -20,15 +20,23 @@
     Boston, MA 02110-1301, USA.
 */
 
+#include <QtCore/QCryptographicHash>
+#include <QtCore/QDataStream>
 #include <QtCore/QFile>
+#include <QtCore/QHash>
+#include <QtCore/QRegularExpression>
+#include <QtCore/QSet>
 #include <QtCore/QStringList>
 #if QT_VERSION < QT_VERSION_CHECK(6, 0, 0)
 #    include <QtCore/QTextCodec>
 #endif
 #include <QtCore/QTextStream>
+#include <QtCore/QVector>
 #include <QtCore/QFileInfo>
 #include <QDebug>
 
+#include <algorithm>
+
 #include "printer.h"
 
 using namespace KODE;
@@ -41,9 +49,22 @@ public:
     void addLabel(Code &code, const QString &label);
     QString classHeader(const Class &classObject, bool publicMembers, bool nestedClass = false);
     QString classImplementation(const Class &classObject, bool nestedClass = false);
-    void addFunctionHeaders(Code &code, const Function::List &functions, const QString &className,
-                            int access);
+    Code implementationPrologue(const File &file, const Class::List &classes,
+                                bool createHeaderInclude);
+    void addFileContent(Code &out, const File &file, bool sharded = false,
+                        bool definitions = true);
+    void printImplementationFile(const File &file, Code &out, const QString &fileName);
+    void addFunctionHeaders(Code &code, const Function::List &functions,
+                            const Class &classObject, int access);
+    QStringList constructorInitializers(const Function &function, const Class &classObject) const;
+    bool isDefinedInHeader(const Function &function, const Class &classObject) const;
+    Function printedFunction(const Function &function, const Class &classObject) const;
     QString formatType(const QString &type) const;
+    MemberVariable::List memberLayout(const Class &classObject) const;
+    QStringList orderedInitializers(const QStringList &initializers,
+                                    const Class &classObject) const;
+    QStringList layoutEnums(const Class &classObject) const;
+    bool isPackedBool(const MemberVariable &variable) const;
 
     Printer *mParent;
     Style mStyle;
@@ -54,6 +75,18 @@ public:
     QString mOutputDirectory;
     QString mSourceFile;
     QStringList mStatementsAfterIncludes;
+    bool mOptimizeMemberLayout = false;
+    bool mPackBoolMembers = false;
+    QMap<QString, int> mMemberLayoutSavings;
+    QStringList mEnclosingEnums;
+    QStringList mDependencies;
+    QStringList mPrintedFiles;
+    QString mFingerprintFile;
+    QHash<QString, QByteArray> mStoredFingerprints;
+    QHash<QString, QByteArray> mFingerprints;
+
+    QString outputFileName(const QString &fileName) const;
+    bool isUnchanged(const QString &fileName, const QByteArray &fingerprint);
 
     /**
      * @brief printCodeIntoFile
@@ -75,6 +108,309 @@ void Printer::Private::addLabel(Code &code, const QString &label)
         code.indent();
 }
 
+namespace {
+
+/**
+ * Returns whether the printer generates copy and move operations for the
+ * given @param classObject or one of its nested classes.
+ */
+bool hasGeneratedMoveOperations(const Class &classObject)
+{
+    if (classObject.useDPointer() && classObject.canBeCopied()
+        && !classObject.memberVariables().isEmpty())
+        return true;
+    const Class::List nestedClasses = classObject.nestedClasses();
+    return std::any_of(nestedClasses.begin(), nestedClasses.end(), hasGeneratedMoveOperations);
+}
+
+/**
+ * Returns whether an enum of the given @param classObject or of one of its
+ * nested classes generates string conversion functions.
+ */
+bool hasEnumStringConversion(const Class &classObject)
+{
+    const Enum::List enums = classObject.enums();
+    if (std::any_of(enums.begin(), enums.end(),
+                    [](const Enum &e) { return e.hasStringConversion(); }))
+        return true;
+    const Class::List nestedClasses = classObject.nestedClasses();
+    return std::any_of(nestedClasses.begin(), nestedClasses.end(), hasEnumStringConversion);
+}
+
+/**
+ * Orders the alignment requirements of the types the same way on all common ABIs:
+ * 8 byte scalars are at least as aligned as pointers, which are at least as aligned
+ * as long, which is at least as aligned as int.
+ */
+enum AlignmentRank { ByteRank = 1, ShortRank, IntRank, LongRank, PointerRank, Int64Rank };
+
+struct TypeLayout
+{
+    int size;
+    int alignment;
+    int rank;
+};
+
+/**
+ * Returns size and alignment of a member of the given @param type on a 64-bit
+ * (LP64) target. The generated code does not depend on the platform libkode runs
+ * on. Types which are not known are assumed to be pointer sized.
+ */
+TypeLayout typeLayout(const QString &type, const QStringList &enums)
+{
+    static const TypeLayout byteLayout = { 1, 1, ByteRank };
+    static const TypeLayout shortLayout = { 2, 2, ShortRank };
+    static const TypeLayout intLayout = { 4, 4, IntRank };
+    static const TypeLayout longLayout = { 8, 8, LongRank };
+    static const TypeLayout pointerLayout = { 8, 8, PointerRank };
+    static const TypeLayout int64Layout = { 8, 8, Int64Rank };
+    // Implicitly shared Qt classes, QList and QString hold three pointers in Qt 6
+#if QT_VERSION >= QT_VERSION_CHECK(6, 0, 0)
+    static const TypeLayout arrayLayout = { 24, 8, PointerRank };
+    static const TypeLayout variantLayout = { 32, 8, Int64Rank };
+#else
+    static const TypeLayout arrayLayout = pointerLayout;
+    static const TypeLayout variantLayout = { 16, 8, Int64Rank };
+#endif
+
+    QString t = type.trimmed();
+    if (t.startsWith(QLatin1String("const ")))
+        t = t.mid(6).trimmed();
+
+    if (t.endsWith('*') || t.endsWith('&'))
+        return pointerLayout;
+
+    static const QHash<QString, TypeLayout> builtins = {
+        { QStringLiteral("bool"), byteLayout },
+        { QStringLiteral("char"), byteLayout },
+        { QStringLiteral("uchar"), byteLayout },
+        { QStringLiteral("qint8"), byteLayout },
+        { QStringLiteral("quint8"), byteLayout },
+        { QStringLiteral("short"), shortLayout },
+        { QStringLiteral("ushort"), shortLayout },
+        { QStringLiteral("qint16"), shortLayout },
+        { QStringLiteral("quint16"), shortLayout },
+        { QStringLiteral("QChar"), shortLayout },
+        { QStringLiteral("int"), intLayout },
+        { QStringLiteral("uint"), intLayout },
+        { QStringLiteral("unsigned"), intLayout },
+        { QStringLiteral("unsigned int"), intLayout },
+        { QStringLiteral("qint32"), intLayout },
+        { QStringLiteral("quint32"), intLayout },
+        { QStringLiteral("float"), intLayout },
+        { QStringLiteral("QTime"), intLayout },
+        { QStringLiteral("long"), longLayout },
+        { QStringLiteral("ulong"), longLayout },
+        { QStringLiteral("long long"), int64Layout },
+        { QStringLiteral("qint64"), int64Layout },
+        { QStringLiteral("quint64"), int64Layout },
+        { QStringLiteral("qlonglong"), int64Layout },
+        { QStringLiteral("qulonglong"), int64Layout },
+        { QStringLiteral("double"), int64Layout },
+        { QStringLiteral("qreal"), int64Layout },
+        { QStringLiteral("QDate"), int64Layout },
+        { QStringLiteral("size_t"), pointerLayout },
+        { QStringLiteral("QDateTime"), pointerLayout },
+        { QStringLiteral("QUrl"), pointerLayout },
+        { QStringLiteral("QString"), arrayLayout },
+        { QStringLiteral("QByteArray"), arrayLayout },
+        { QStringLiteral("QStringList"), arrayLayout },
+        { QStringLiteral("QVariant"), variantLayout },
+    };
+
+    const auto it = builtins.constFind(t);
+    if (it != builtins.constEnd())
+        return it.value();
+
+    if (t.startsWith(QLatin1String("QList<")) || t.startsWith(QLatin1String("QVector<")))
+        return arrayLayout;
+    if (t.startsWith(QLatin1String("QMap<")) || t.startsWith(QLatin1String("QHash<"))
+        || t.startsWith(QLatin1String("QSet<")))
+        return pointerLayout;
+
+    // Enums of the class itself
+    const int scope = t.lastIndexOf(QLatin1String("::"));
+    if (enums.contains(scope < 0 ? t : t.mid(scope + 2)))
+        return intLayout;
+
+    return pointerLayout;
+}
+
+/**
+ * Estimates the size of an object with the given member @param variables,
+ * with bool members packed into bits if @param packBools is set.
+ */
+int estimatedSize(const MemberVariable::List &variables, const QStringList &enums, bool packBools)
+{
+    int size = 0;
+    int maxAlignment = 1;
+    int bits = 0;
+    for (const MemberVariable &v : variables) {
+        if (v.isStatic())
+            continue;
+        if (packBools && v.type().trimmed() == QLatin1String("bool")) {
+            if (bits % 8 == 0)
+                ++size;
+            ++bits;
+            continue;
+        }
+        bits = 0;
+        const TypeLayout layout = typeLayout(v.type(), enums);
+        size = (size + layout.alignment - 1) / layout.alignment * layout.alignment;
+        size += layout.size;
+        maxAlignment = qMax(maxAlignment, layout.alignment);
+    }
+    return (size + maxAlignment - 1) / maxAlignment * maxAlignment;
+}
+
+/**
+ * Returns the names declared at file scope by the given file @param code, i.e. the
+ * functions, variables, types and macros outside of function and class bodies.
+ * Named and anonymous namespaces and extern "C" blocks count as file scope.
+ * This is a heuristic which does not expand macros.
+ */
+QSet<QString> fileScopeNames(const QString &code)
+{
+    static const QRegularExpression comments(QStringLiteral("//[^\\n]*|/\\*.*?\\*/"),
+                                             QRegularExpression::DotMatchesEverythingOption);
+    static const QRegularExpression literals(
+            QStringLiteral("\"(\\\\.|[^\"\\\\])*\"|'(\\\\.|[^'\\\\])*'"));
+    static const QRegularExpression define(QStringLiteral("^\\s*#\\s*define\\s+(\\w+)"),
+                                           QRegularExpression::MultilineOption);
+    static const QRegularExpression directive(QStringLiteral("^\\s*#[^\\n]*"),
+                                              QRegularExpression::MultilineOption);
+    static const QRegularExpression identifier(QStringLiteral("[A-Za-z_]\\w*"));
+    static const QRegularExpression declaratorEnd(QStringLiteral("[(=\\[]"));
+    static const QRegularExpression typeKeyword(
+            QStringLiteral("^(?:typedef\\s+)?(?:enum\\s+class|enum|class|struct|union)\\s+(\\w+)"));
+
+    QSet<QString> names;
+    QString text = code;
+    text.remove(comments);
+    text.replace(literals, QStringLiteral("\"\""));
+    QRegularExpressionMatchIterator defines = define.globalMatch(text);
+    while (defines.hasNext())
+        names.insert(defines.next().captured(1));
+    text.remove(directive);
+
+    // The name declared by a statement at file scope
+    auto addDeclaredName = [&](const QString &statement) {
+        const QString declaration = statement.simplified();
+        if (declaration.startsWith(QLatin1String("using namespace ")))
+            return;
+        const QRegularExpressionMatch type = typeKeyword.match(declaration);
+        if (type.hasMatch()) {
+            names.insert(type.captured(1));
+            return;
+        }
+        const int end = declaration.indexOf(declaratorEnd);
+        QRegularExpressionMatchIterator it = identifier.globalMatch(declaration.left(end));
+        QString name;
+        while (it.hasNext())
+            name = it.next().captured();
+        if (!name.isEmpty() && name != QLatin1String("namespace"))
+            names.insert(name);
+    };
+
+    // Whether each open brace is transparent, i.e. keeps the file scope
+    QVector<bool> braces;
+    QString statement;
+    for (const QChar c : std::as_const(text)) {
+        const bool fileScope = !braces.contains(false);
+        if (c == QLatin1Char('{')) {
+            const QString opener = statement.simplified();
+            const bool transparent = opener.startsWith(QLatin1String("namespace"))
+                    || opener.startsWith(QLatin1String("extern \"\""));
+            if (fileScope && !transparent)
+                addDeclaredName(statement);
+            braces.append(transparent);
+            statement.clear();
+        } else if (c == QLatin1Char('}')) {
+            if (!braces.isEmpty())
+                braces.removeLast();
+            statement.clear();
+        } else if (c == QLatin1Char(';')) {
+            if (fileScope)
+                addDeclaredName(statement);
+            statement.clear();
+        } else {
+            statement += c;
+        }
+    }
+    return names;
+}
+
+}
+
+bool Printer::Private::isPackedBool(const MemberVariable &variable) const
+{
+    return mOptimizeMemberLayout && mPackBoolMembers && !variable.isStatic()
+            && variable.type().trimmed() == QLatin1String("bool");
+}
+
+QStringList Printer::Private::layoutEnums(const Class &classObject) const
+{
+    QStringList enums = mEnclosingEnums;
+    const Enum::List classEnums = classObject.enums();
+    for (const Enum &e : classEnums)
+        enums.append(e.name());
+    return enums;
+}
+
+/**
+ * Returns the member variables of @param classObject in the order they are declared,
+ * which is by decreasing alignment if the layout optimization is enabled.
+ */
+MemberVariable::List Printer::Private::memberLayout(const Class &classObject) const
+{
+    MemberVariable::List variables = classObject.memberVariables();
+    if (!mOptimizeMemberLayout)
+        return variables;
+
+    const QStringList enums = layoutEnums(classObject);
+    auto rank = [&](const MemberVariable &v) {
+        // Static members do not take space, packed bools go to the end
+        if (v.isStatic())
+            return -1;
+        if (isPackedBool(v))
+            return 0;
+        return typeLayout(v.type(), enums).rank;
+    };
+    std::stable_sort(variables.begin(), variables.end(),
+                     [&](const MemberVariable &a, const MemberVariable &b) {
+                         return rank(a) > rank(b);
+                     });
+    return variables;
+}
+
+/**
+ * Returns the constructor @param initializers in the order the members of
+ * @param classObject are initialized: base classes first, followed by the member
+ * variables in declaration order. Otherwise the compiler warns with -Wreorder.
+ */
+QStringList Printer::Private::orderedInitializers(const QStringList &initializers,
+                                                  const Class &classObject) const
+{
+    if (!mOptimizeMemberLayout || classObject.useDPointer())
+        return initializers;
+
+    QStringList members;
+    const MemberVariable::List layout = memberLayout(classObject);
+    for (const MemberVariable &v : layout)
+        members.append(v.name());
+
+    static const QRegularExpression argumentsStart(QStringLiteral("[({]"));
+    auto position = [&](const QString &initializer) {
+        const int end = initializer.indexOf(argumentsStart);
+        return members.indexOf(initializer.left(end).trimmed());
+    };
+    QStringList ordered = initializers;
+    std::stable_sort(ordered.begin(), ordered.end(), [&](const QString &a, const QString &b) {
+        return position(a) < position(b);
+    });
+    return ordered;
+}
+
 QString Printer::Private::formatType(const QString &type) const
 {
     QString s = type;
@@ -210,7 +546,7 @@ QString Printer::Private::classHeader(const Class &classObject, bool publicMembe
 
     Function::List functions = classObject.functions();
 
-    addFunctionHeaders(code, functions, classObject.name(), Function::Public);
+    addFunctionHeaders(code, functions, classObject, Function::Public);
 
     if (classObject.canBeCopied() && classObject.useDPointer()
         && !classObject.memberVariables().isEmpty()) {
@@ -218,17 +554,23 @@ QString Printer::Private::classHeader(const Class &classObject, bool publicMembe
         cc.addArgument("const " + classObject.name() + '&');
         Function op("operator=", classObject.name() + '&');
         op.addArgument("const " + classObject.name() + '&');
+        Function mc(classObject.name());
+        mc.addArgument(classObject.name() + "&&");
+        mc.setNoexcept(true);
+        Function mop("operator=", classObject.name() + '&');
+        mop.addArgument(classObject.name() + "&&");
+        mop.setNoexcept(true);
         Function::List list;
-        list << cc << op;
-        addFunctionHeaders(code, list, classObject.name(), Function::Public);
+        list << cc << op << mc << mop;
+        addFunctionHeaders(code, list, classObject, Function::Public);
     }
 
-    addFunctionHeaders(code, functions, classObject.name(), Function::Public | Function::Slot);
-    addFunctionHeaders(code, functions, classObject.name(), Function::Signal);
-    addFunctionHeaders(code, functions, classObject.name(), Function::Protected);
-    addFunctionHeaders(code, functions, classObject.name(), Function::Protected | Function::Slot);
-    addFunctionHeaders(code, functions, classObject.name(), Function::Private);
-    addFunctionHeaders(code, functions, classObject.name(), Function::Private | Function::Slot);
+    addFunctionHeaders(code, functions, classObject, Function::Public | Function::Slot);
+    addFunctionHeaders(code, functions, classObject, Function::Signal);
+    addFunctionHeaders(code, functions, classObject, Function::Protected);
+    addFunctionHeaders(code, functions, classObject, Function::Protected | Function::Slot);
+    addFunctionHeaders(code, functions, classObject, Function::Private);
+    addFunctionHeaders(code, functions, classObject, Function::Private | Function::Slot);
 
     if (!classObject.memberVariables().isEmpty()) {
         Function::List::ConstIterator it;
@@ -258,7 +600,7 @@ QString Printer::Private::classHeader(const Class &classObject, bool publicMembe
             else
                 code += "PrivateDPtr *" + classObject.dPointerName() + ";";
         } else {
-            MemberVariable::List variables = classObject.memberVariables();
+            const MemberVariable::List variables = memberLayout(classObject);
             MemberVariable::List::ConstIterator it2;
             for (it2 = variables.constBegin(); it2 != variables.constEnd(); ++it2) {
                 MemberVariable v = *it2;
@@ -269,10 +611,24 @@ QString Printer::Private::classHeader(const Class &classObject, bool publicMembe
 
                 decl += formatType(v.type());
 
-                decl += v.name() + ';';
+                decl += v.name();
+                if (isPackedBool(v))
+                    decl += " : 1";
+                decl += ';';
 
                 code += decl;
             }
+
+            if (mOptimizeMemberLayout) {
+                const QStringList enums = layoutEnums(classObject);
+                QString name = classObject.name();
+                if (!classObject.nameSpace().isEmpty())
+                    name.prepend(classObject.nameSpace() + "::");
+                mMemberLayoutSavings.insert(
+                        name,
+                        estimatedSize(classObject.memberVariables(), enums, false)
+                                - estimatedSize(variables, enums, mPackBoolMembers));
+            }
         }
         if (mLabelsDefineIndent)
             code.unindent();
@@ -307,13 +663,16 @@ QString Printer::Private::classImplementation(const Class &classObject, bool nes
         if (classObject.useSharedData()) {
             privateClass.addBaseClass(Class("QSharedData"));
         }
-        MemberVariable::List vars = classObject.memberVariables();
+        const MemberVariable::List vars = classObject.memberVariables();
         MemberVariable::List::ConstIterator it;
+        for (it = vars.constBegin(); it != vars.constEnd(); ++it)
+            privateClass.addMemberVariable(*it);
+        // Initialize in declaration order
+        const MemberVariable::List layout = memberLayout(classObject);
         Function ctor("PrivateDPtr");
         bool hasInitializers = false;
-        for (it = vars.constBegin(); it != vars.constEnd(); ++it) {
+        for (it = layout.constBegin(); it != layout.constEnd(); ++it) {
             const MemberVariable v = *it;
-            privateClass.addMemberVariable(v);
             if (!v.initializer().isEmpty()) {
                 ctor.addInitializer(v.name() + '(' + v.initializer() + ')');
                 hasInitializers = true;
@@ -321,7 +680,10 @@ QString Printer::Private::classImplementation(const Class &classObject, bool nes
         }
         if (hasInitializers)
             privateClass.addFunction(ctor);
+        // The members of the private class may use the enums of the class
+        mEnclosingEnums = layoutEnums(classObject);
         code += classHeader(privateClass, true /*publicMembers*/);
+        mEnclosingEnums.clear();
         if (hasInitializers)
             code += classImplementation(privateClass);
     }
@@ -345,7 +707,7 @@ QString Printer::Private::classImplementation(const Class &classObject, bool nes
     Function::List functions = classObject.functions();
     Function::List::ConstIterator it;
     for (it = functions.constBegin(); it != functions.constEnd(); ++it) {
-        Function f = *it;
+        Function f = printedFunction(*it, classObject);
 
         // Omit signals
         if (f.access() == Function::Signal)
@@ -353,25 +715,13 @@ QString Printer::Private::classImplementation(const Class &classObject, bool nes
         // Omit pure virtuals without a body
         if (f.virtualMode() == Function::PureVirtual && f.body().isEmpty())
             continue;
+        // Omit functions defined in the header
+        if (isDefinedInHeader(f, classObject))
+            continue;
 
         code += mParent->functionSignature(f, functionClassName, true);
 
-        QStringList inits = f.initializers();
-        if (classObject.useDPointer() && !classObject.memberVariables().isEmpty()
-            && f.name() == classObject.name()) {
-            inits.append(classObject.dPointerName() + "(new PrivateDPtr)");
-        }
-        if (!classObject.useDPointer() && f.name() == classObject.name()
-            && f.arguments().isEmpty()) {
-            // Default constructor: add initializers for variables
-            for (itV = vars.constBegin(); itV != vars.constEnd(); ++itV) {
-                const MemberVariable v = *itV;
-                if (!v.initializer().isEmpty()) {
-                    inits.append(v.name() + '(' + v.initializer() + ')');
-                }
-            }
-        }
-
+        const QStringList inits = constructorInitializers(f, classObject);
         if (!inits.isEmpty()) {
             code.indent();
             code += ": " + inits.join(", ");
@@ -442,11 +792,21 @@ QString Printer::Private::classImplementation(const Class &classObject, bool nes
         body += "return *this;";
         body.unindent();
         body.newLine();
-        if (classObject.useSharedData())
+        if (classObject.useSharedData()) {
             body += classObject.dPointerName() + " = other." + classObject.dPointerName() + ";";
-        else
+        } else {
+            // A moved-from instance has no private data anymore
+            body += "if ( " + classObject.dPointerName() + " )";
+            body.indent();
             body += "*" + classObject.dPointerName() + " = *other." + classObject.dPointerName()
                     + ";";
+            body.unindent();
+            body += "else";
+            body.indent();
+            body += classObject.dPointerName() + " = new PrivateDPtr( *other."
+                    + classObject.dPointerName() + " );";
+            body.unindent();
+        }
         for (int i = 0; i < baseClasses.count(); ++i) {
             body += QLatin1String("* static_cast<") + baseClasses[i].name()
                     + QLatin1String(" *>(this) = other;");
@@ -461,6 +821,61 @@ QString Printer::Private::classImplementation(const Class &classObject, bool nes
         code.addBlock(op.body(), Code::defaultIndentation());
         code += '}';
         code.newLine();
+
+        // print move constructor
+        Function mc(classObject.name());
+        mc.addArgument(functionClassName + "&& other");
+        mc.setNoexcept(true);
+
+        code += mParent->functionSignature(mc, functionClassName, true);
+
+        list.clear();
+        for (int i = 0; i < baseClasses.count(); ++i) {
+            list.append(baseClasses[i].name() + "( std::move( other ) )");
+        }
+        // The private data is stolen, the moved-from instance can only be assigned to
+        // or destroyed
+        if (classObject.useSharedData()) {
+            list.append(classObject.dPointerName() + "( std::move( other."
+                        + classObject.dPointerName() + " ) )");
+        } else {
+            list.append(classObject.dPointerName() + "( std::exchange( other."
+                        + classObject.dPointerName() + ", nullptr ) )");
+        }
+        code.indent();
+        code += ": " + list.join(", ");
+        code.unindent();
+
+        code += '{';
+        code += '}';
+        code.newLine();
+
+        // print move assignment operator
+        Function mop("operator=", functionClassName + "& ");
+        mop.addArgument(functionClassName + "&& other");
+        mop.setNoexcept(true);
+
+        body.clear();
+        if (classObject.useSharedData())
+            body += classObject.dPointerName() + ".swap( other." + classObject.dPointerName()
+                    + " );";
+        else
+            body += "std::swap( " + classObject.dPointerName() + ", other."
+                    + classObject.dPointerName() + " );";
+        for (int i = 0; i < baseClasses.count(); ++i) {
+            body += QLatin1String("static_cast<") + baseClasses[i].name()
+                    + QLatin1String(" &>(*this) = std::move( other );");
+        }
+
+        body.newLine();
+        body += "return *this;";
+        mop.setBody(body);
+
+        code += mParent->functionSignature(mop, functionClassName, true);
+        code += '{';
+        code.addBlock(mop.body(), Code::defaultIndentation());
+        code += '}';
+        code.newLine();
     }
 
     // Generate nested class functions
@@ -474,15 +889,65 @@ QString Printer::Private::classImplementation(const Class &classObject, bool nes
     return code.text();
 }
 
+QStringList Printer::Private::constructorInitializers(const Function &function,
+                                                     const Class &classObject) const
+{
+    QStringList inits = function.initializers();
+    if (function.name() != classObject.name())
+        return inits;
+    inits = orderedInitializers(inits, classObject);
+
+    if (classObject.useDPointer() && !classObject.memberVariables().isEmpty()) {
+        inits.append(classObject.dPointerName() + "(new PrivateDPtr)");
+    } else if (!classObject.useDPointer() && function.arguments().isEmpty()) {
+        // Default constructor: add initializers for variables
+        const MemberVariable::List vars = memberLayout(classObject);
+        for (const MemberVariable &v : vars) {
+            if (!v.initializer().isEmpty()) {
+                inits.append(v.name() + '(' + v.initializer() + ')');
+            }
+        }
+    }
+
+    return inits;
+}
+
+bool Printer::Private::isDefinedInHeader(const Function &function, const Class &classObject) const
+{
+    if (!function.hasInlineDefinition())
+        return false;
+
+    // The private data of d-pointer classes is only known in the implementation
+    return !classObject.useDPointer() || classObject.memberVariables().isEmpty();
+}
+
+/**
+ * Returns @param function as it is printed for @param classObject: functions which
+ * can't be defined in the header are printed without inline and constexpr, as
+ * other translation units could not use them otherwise.
+ */
+Function Printer::Private::printedFunction(const Function &function,
+                                           const Class &classObject) const
+{
+    if (!function.hasInlineDefinition() || isDefinedInHeader(function, classObject))
+        return function;
+
+    Function f = function;
+    f.setInline(false);
+    f.setConstexpr(false);
+    return f;
+}
+
 void Printer::Private::addFunctionHeaders(Code &code, const Function::List &functions,
-                                          const QString &className, int access)
+                                          const Class &classObject, int access)
 {
+    const QString className = classObject.name();
     bool needNewLine = false;
     bool hasAccess = false;
 
     Function::List::ConstIterator it;
     for (it = functions.constBegin(); it != functions.constEnd(); ++it) {
-        Function f = *it;
+        const Function f = printedFunction(*it, classObject);
         if (f.access() == access) {
             if (!hasAccess) {
                 addLabel(code, f.accessAsString() + ':');
@@ -490,14 +955,32 @@ void Printer::Private::addFunctionHeaders(Code &code, const Function::List &func
             }
             if (mLabelsDefineIndent)
                 code.indent();
-            if (!(*it).docs().isEmpty()) {
+            if (!f.docs().isEmpty()) {
                 code += "/**";
                 code.indent();
-                code.addFormattedText((*it).docs());
+                code.addFormattedText(f.docs());
                 code.unindent();
                 code += " */";
             }
-            code += mParent->functionSignature(*it, className, false) + ';';
+            if (f.hasInlineDefinition() != (*it).hasInlineDefinition()) {
+                qWarning("%s::%s can't be inline, the private data of the class is only known in "
+                         "the implementation",
+                         qPrintable(className), qPrintable(f.name()));
+            }
+            if (isDefinedInHeader(f, classObject)) {
+                code += mParent->functionSignature(f, className, false);
+                const QStringList inits = constructorInitializers(f, classObject);
+                if (!inits.isEmpty()) {
+                    code.indent();
+                    code += ": " + inits.join(", ");
+                    code.unindent();
+                }
+                code += '{';
+                code.addBlock(f.body(), Code::defaultIndentation());
+                code += '}';
+            } else {
+                code += mParent->functionSignature(f, className, false) + ';';
+            }
             if (mLabelsDefineIndent)
                 code.unindent();
             needNewLine = true;
@@ -557,6 +1040,21 @@ void Printer::setSourceFile(const QString &sourceFile)
     d->mSourceFile = sourceFile;
 }
 
+void Printer::setOptimizeMemberLayout(bool b)
+{
+    d->mOptimizeMemberLayout = b;
+}
+
+void Printer::setPackBoolMembers(bool b)
+{
+    d->mPackBoolMembers = b;
+}
+
+QMap<QString, int> Printer::memberLayoutSavings() const
+{
+    return d->mMemberLayoutSavings;
+}
+
 void Printer::setLabelsDefineIndent(bool b)
 {
     d->mLabelsDefineIndent = b;
@@ -572,6 +1070,12 @@ QString Printer::functionSignature(const Function &function, const QString &clas
 {
     QString s;
 
+    if (!forImplementation) {
+        const QStringList attributes = function.attributes();
+        for (const QString &attribute : attributes)
+            s += "[[" + attribute + "]] ";
+    }
+
     if (function.isStatic() && !forImplementation) {
         s += QStringLiteral("static ");
     }
@@ -584,6 +1088,12 @@ QString Printer::functionSignature(const Function &function, const QString &clas
         s += QStringLiteral("explicit ");
     }
 
+    if (function.isConstexpr() && !forImplementation) {
+        s += QStringLiteral("constexpr ");
+    } else if (function.isInline() && !forImplementation) {
+        s += QStringLiteral("inline ");
+    }
+
     QString ret = function.returnType();
     if (!ret.isEmpty()) {
         s += d->formatType(ret);
@@ -611,6 +1121,9 @@ QString Printer::functionSignature(const Function &function, const QString &clas
     if (function.isConst())
         s += " const";
 
+    if (function.isNoexcept())
+        s += " noexcept";
+
     if (function.virtualMode() == Function::Override && !forImplementation) {
         s += " override";
     }
@@ -685,6 +1198,10 @@ static QStringList commonLeft(const QStringList &l1, const QStringList &l2)
 
 void Printer::printHeader(const File &file)
 {
+    if (d->isUnchanged(d->outputFileName(file.filenameHeader()),
+                       fingerprint(file) + QByteArrayLiteral("header")))
+        return;
+
     Code out;
 
     if (d->mCreationWarning)
@@ -704,11 +1221,22 @@ void Printer::printHeader(const File &file)
     // Create includes
     Include::List processedIncludes;
     const Class::List classes = file.classes();
+    const Enum::List fileEnums = file.fileEnums();
+    if (std::any_of(fileEnums.begin(), fileEnums.end(),
+                    [](const Enum &e) { return e.hasStringConversion(); })
+        || std::any_of(classes.begin(), classes.end(), hasEnumStringConversion)) {
+        // std::size_t and std::char_traits of the generated fromString()
+        processedIncludes << Include("cstddef") << Include("string");
+        out += "#include <cstddef>";
+        out += "#include <string>";
+    }
     Q_FOREACH (const Class &cl, classes) {
         Q_ASSERT(!cl.name().isEmpty());
         Include::List includes = cl.headerIncludes();
         if (cl.useSharedData())
             includes.append(Include("QtCore/QSharedData"));
+        if (cl.isRelocatable())
+            includes.append(Include("QtCore/QtGlobal"));
         // qDebug() << "includes=" << includes;
         for (auto include : std::as_const(includes)) {
             if (!processedIncludes.contains(include)) {
@@ -796,11 +1324,46 @@ void Printer::printHeader(const File &file)
         out.newLine();
     }
 
+    // Inline file functions, the others are defined in the implementation
+    const Function::List fileFunctions = file.fileFunctions();
+    for (const Function &f : fileFunctions) {
+        if (!f.hasInlineDefinition())
+            continue;
+        out += functionSignature(f);
+        out += '{';
+        out.addBlock(f.body(), Code::defaultIndentation());
+        out += '}';
+        out.newLine();
+    }
+
     if (!file.nameSpace().isEmpty()) {
         out += '}';
         out.newLine();
     }
 
+    // Type traits have to be declared in the global namespace
+    QStringList relocatableClasses;
+    for (it = classes.constBegin(); it != classes.constEnd(); ++it) {
+        if (!(*it).isRelocatable())
+            continue;
+        QString name = (*it).name();
+        if (!(*it).nameSpace().isEmpty())
+            name.prepend((*it).nameSpace() + "::");
+        if (!file.nameSpace().isEmpty())
+            name.prepend(file.nameSpace() + "::");
+        relocatableClasses.append(name);
+    }
+    if (!relocatableClasses.isEmpty()) {
+        out += "#if QT_VERSION >= QT_VERSION_CHECK(6, 0, 0)";
+        for (const QString &name : std::as_const(relocatableClasses))
+            out += "Q_DECLARE_TYPEINFO(" + name + ", Q_RELOCATABLE_TYPE);";
+        out += "#else";
+        for (const QString &name : std::as_const(relocatableClasses))
+            out += "Q_DECLARE_TYPEINFO(" + name + ", Q_MOVABLE_TYPE);";
+        out += "#endif";
+        out.newLine();
+    }
+
     // Print to file
     QString filename = file.filenameHeader();
 
@@ -813,14 +1376,15 @@ void Printer::printHeader(const File &file)
     d->printCodeIntoFile(out, &header);
 }
 
-void Printer::printImplementation(const File &file, bool createHeaderInclude)
+Code Printer::Private::implementationPrologue(const File &file, const Class::List &classes,
+                                              bool createHeaderInclude)
 {
     Code out;
 
-    if (d->mCreationWarning)
-        out += creationWarning();
+    if (mCreationWarning)
+        out += mParent->creationWarning();
 
-    out.addBlock(licenseHeader(file));
+    out.addBlock(mParent->licenseHeader(file));
 
     out.newLine();
 
@@ -840,10 +1404,11 @@ void Printer::printImplementation(const File &file, bool createHeaderInclude)
 
     // Create class includes
     QStringList processed;
-    Class::List classes = file.classes();
     Class::List::ConstIterator it;
     for (it = classes.constBegin(); it != classes.constEnd(); ++it) {
         QStringList includes = (*it).includes();
+        if (hasGeneratedMoveOperations(*it))
+            includes.append(QStringLiteral("utility")); // std::move, std::swap, std::exchange
         QStringList::ConstIterator it2;
         for (it2 = includes.constBegin(); it2 != includes.constEnd(); ++it2) {
             if (!processed.contains(*it2)) {
@@ -861,6 +1426,18 @@ void Printer::printImplementation(const File &file, bool createHeaderInclude)
         out.newLine();
     }
 
+    return out;
+}
+
+/**
+ * Prints the extern "C" declarations, file variables, file code and file functions
+ * of @param file. In @param sharded output, the static file variables are shared by
+ * all shards, and only the shard with the @param definitions defines the file
+ * variables and the functions which are not static. The other shards declare them.
+ */
+void Printer::Private::addFileContent(Code &out, const File &file, bool sharded,
+                                      bool definitions)
+{
     // 'extern "C"' declarations
     const QStringList externCDeclarations = file.externCDeclarations();
     if (!externCDeclarations.isEmpty()) {
@@ -879,7 +1456,9 @@ void Printer::printImplementation(const File &file, bool createHeaderInclude)
     for (itV = vars.constBegin(); itV != vars.constEnd(); ++itV) {
         Variable v = *itV;
         QString str;
-        if (v.isStatic())
+        if (!definitions)
+            str += "extern ";
+        else if (v.isStatic() && !sharded)
             str += "static ";
         str += v.type() + ' ' + v.name() + ';';
         out += str;
@@ -894,22 +1473,61 @@ void Printer::printImplementation(const File &file, bool createHeaderInclude)
         out.newLine();
     }
 
-    // File functions
+    // File functions, inline ones are defined in the header
     Function::List funcs = file.fileFunctions();
     Function::List::ConstIterator itF;
     for (itF = funcs.constBegin(); itF != funcs.constEnd(); ++itF) {
         Function f = *itF;
-        out += functionSignature(f);
+        if (f.hasInlineDefinition())
+            continue;
+        if (!definitions && !f.isStatic()) {
+            out += mParent->functionSignature(f) + ';';
+            out.newLine();
+            continue;
+        }
+        out += mParent->functionSignature(f);
         out += '{';
         out.addBlock(f.body(), Code::defaultIndentation());
         out += '}';
         out.newLine();
     }
+}
+
+void Printer::Private::printImplementationFile(const File &file, Code &out,
+                                               const QString &fileName)
+{
+    if (!file.nameSpace().isEmpty()) {
+        out += "}";
+        out.newLine();
+    }
+
+    // Print to file
+    QString filename = fileName;
+
+    if (!mOutputDirectory.isEmpty())
+        filename.prepend(mOutputDirectory + '/');
+
+    QFile implementation(filename);
+    printCodeIntoFile(out, &implementation);
+}
+
+void Printer::printImplementation(const File &file, bool createHeaderInclude)
+{
+    if (d->isUnchanged(d->outputFileName(file.filenameImplementation()),
+                       fingerprint(file) + QByteArrayLiteral("implementation")
+                               + QByteArray::number(createHeaderInclude)))
+        return;
+
+    const Class::List classes = file.classes();
+    Code out = d->implementationPrologue(file, classes, createHeaderInclude);
+
+    d->addFileContent(out, file);
 
     // Classes
 #ifdef KDAB_DELETED
     bool containsQObject = false;
 #endif
+    Class::List::ConstIterator it;
     for (it = classes.constBegin(); it != classes.constEnd(); ++it) {
 #ifdef KDAB_DELETED
         if ((*it).isQObject())
@@ -918,12 +1536,7 @@ void Printer::printImplementation(const File &file, bool createHeaderInclude)
 
         QString str = d->classImplementation(*it);
         if (!str.isEmpty())
-            out += d->classImplementation(*it);
-    }
-
-    if (!file.nameSpace().isEmpty()) {
-        out += "}";
-        out.newLine();
+            out += str;
     }
 
     // KDAB: removed; 1) for removing .filename(), and 2) qmake would want moc_foo.cpp anyway
@@ -934,20 +1547,325 @@ void Printer::printImplementation(const File &file, bool createHeaderInclude)
     }
 #endif
 
-    // Print to file
-    QString filename = file.filenameImplementation();
+    d->printImplementationFile(file, out, file.filenameImplementation());
+}
+
+QStringList Printer::printShardedImplementation(const File &file, int shardCount,
+                                                bool createHeaderInclude)
+{
+    if (shardCount < 1)
+        shardCount = 1;
+
+    QString baseName = file.filenameImplementation();
+    if (baseName.endsWith(QLatin1String(".cpp")))
+        baseName.chop(4);
+
+    // All shards are printed from the whole model, which also decides how the
+    // classes are distributed
+    const QByteArray modelFingerprint = fingerprint(file) + QByteArrayLiteral("shard")
+            + QByteArray::number(shardCount) + QByteArray::number(createHeaderInclude) + '/';
+    QStringList shardFiles;
+    QVector<bool> unchangedShards;
+    for (int shard = 0; shard < shardCount; ++shard) {
+        const QString shardFile = baseName + '_' + QString::number(shard) + ".cpp";
+        shardFiles.append(shardFile);
+        unchangedShards.append(d->isUnchanged(d->outputFileName(shardFile),
+                                              modelFingerprint + QByteArray::number(shard)));
+    }
+    if (!unchangedShards.contains(false))
+        return shardFiles;
+
+    const Class::List classes = file.classes();
+    QStringList implementations;
+    for (const Class &cl : classes)
+        implementations.append(d->classImplementation(cl));
+
+    // Assign the largest classes first, each to the currently smallest shard
+    QList<int> order;
+    for (int i = 0; i < classes.count(); ++i)
+        order.append(i);
+    std::stable_sort(order.begin(), order.end(), [&](int a, int b) {
+        return implementations.at(a).size() > implementations.at(b).size();
+    });
+
+    QVector<int> shardSizes(shardCount, 0);
+    QVector<int> shardOfClass(classes.count(), 0);
+    for (int index : std::as_const(order)) {
+        const int shard = int(std::min_element(shardSizes.constBegin(), shardSizes.constEnd())
+                              - shardSizes.constBegin());
+        shardOfClass[index] = shard;
+        shardSizes[shard] += implementations.at(index).size();
+    }
+
+    for (int shard = 0; shard < shardCount; ++shard) {
+        if (unchangedShards.at(shard))
+            continue;
+
+        // Keep the original order of the classes within a shard
+        Class::List shardClasses;
+        QStringList shardImplementations;
+        for (int i = 0; i < classes.count(); ++i) {
+            if (shardOfClass.at(i) == shard) {
+                shardClasses.append(classes.at(i));
+                shardImplementations.append(implementations.at(i));
+            }
+        }
 
+        Code out = d->implementationPrologue(file, shardClasses, createHeaderInclude);
+        d->addFileContent(out, file, true, shard == 0);
+        for (const QString &implementation : std::as_const(shardImplementations)) {
+            if (!implementation.isEmpty())
+                out += implementation;
+        }
+
+        d->printImplementationFile(file, out, shardFiles.at(shard));
+    }
+
+    return shardFiles;
+}
+
+QStringList Printer::printUnityImplementations(const File::List &files, const QString &baseName,
+                                               int batchSize)
+{
+    if (batchSize < 1)
+        batchSize = 1;
+
+    // Names with file scope would clash when two files end up in the same translation unit
+    struct Batch
+    {
+        QStringList implementations;
+        QSet<QString> fileScopeNames;
+    };
+    QList<Batch> batches;
+
+    for (const File &file : files) {
+        printImplementation(file);
+
+        QSet<QString> names;
+        const Variable::List vars = file.fileVariables();
+        for (const Variable &v : vars)
+            names.insert(v.name());
+        const Function::List funcs = file.fileFunctions();
+        for (const Function &f : funcs)
+            names.insert(f.name());
+        names.unite(fileScopeNames(file.fileCode().text()));
+
+        Batch *batch = nullptr;
+        for (Batch &candidate : batches) {
+            if (candidate.implementations.count() < batchSize
+                && !candidate.fileScopeNames.intersects(names)) {
+                batch = &candidate;
+                break;
+            }
+        }
+        if (!batch) {
+            batches.append(Batch());
+            batch = &batches.last();
+        }
+        batch->implementations.append(file.filenameImplementation());
+        batch->fileScopeNames.unite(names);
+    }
+
+    QStringList unityFiles;
+    for (int i = 0; i < batches.count(); ++i) {
+        Code out;
+        if (d->mCreationWarning)
+            out += creationWarning();
+
+        for (const QString &implementation : std::as_const(batches.at(i).implementations))
+            out += "#include \"" + implementation + '"';
+
+        const QString unityFile = baseName + "_unity_" + QString::number(i) + ".cpp";
+        unityFiles.append(unityFile);
+
+        QString filename = unityFile;
+        if (!d->mOutputDirectory.isEmpty())
+            filename.prepend(d->mOutputDirectory + '/');
+
+        QFile unity(filename);
+        d->printCodeIntoFile(out, &unity);
+    }
+
+    return unityFiles;
+}
+
+void Printer::printPrecompiledHeader(const File::List &files, const QString &filename,
+                                     int minimumUsage)
+{
+    // Global includes in order of appearance, with the number of files using them
+    QStringList includes;
+    QHash<QString, int> usage;
+
+    for (const File &file : files) {
+        QStringList fileIncludes = file.includes();
+        const Class::List classes = file.classes();
+        for (const Class &cl : classes) {
+            const Include::List headerIncludes = cl.headerIncludes();
+            for (const Include &include : headerIncludes) {
+                if (include.type == Include::Global)
+                    fileIncludes.append(include.includeFileName);
+            }
+            if (cl.useSharedData())
+                fileIncludes.append(QStringLiteral("QtCore/QSharedData"));
+            fileIncludes += cl.includes();
+        }
+        fileIncludes.removeDuplicates();
+
+        for (const QString &include : std::as_const(fileIncludes)) {
+            if (!usage.contains(include))
+                includes.append(include);
+            ++usage[include];
+        }
+    }
+
+    Code out;
+    if (d->mCreationWarning)
+        out += creationWarning();
+
+    out.addLine(QStringLiteral("#pragma once"));
+    out.newLine();
+
+    for (const QString &include : std::as_const(includes)) {
+        if (usage.value(include) >= minimumUsage)
+            out += "#include <" + include + '>';
+    }
+
+    QString fileName = filename;
     if (!d->mOutputDirectory.isEmpty())
-        filename.prepend(d->mOutputDirectory + '/');
+        fileName.prepend(d->mOutputDirectory + '/');
 
-    QFile implementation(filename);
-    d->printCodeIntoFile(out, &implementation);
+    QFile header(fileName);
+    d->printCodeIntoFile(out, &header);
+}
+
+QString Printer::Private::outputFileName(const QString &fileName) const
+{
+    if (mOutputDirectory.isEmpty())
+        return fileName;
+    return mOutputDirectory + '/' + fileName;
+}
+
+/**
+ * Returns true if @param fileName exists and was printed from a model with the
+ * same @param fingerprint before, so rendering it again can be skipped.
+ */
+bool Printer::Private::isUnchanged(const QString &fileName, const QByteArray &fingerprint)
+{
+    if (mFingerprintFile.isEmpty())
+        return false;
+
+    const QByteArray hash = QCryptographicHash::hash(fingerprint, QCryptographicHash::Sha1);
+    mFingerprints.insert(fileName, hash);
+    if (mStoredFingerprints.value(fileName) != hash || !QFile::exists(fileName))
+        return false;
+
+    qDebug("Skip generating %s because its model did not change", qPrintable(fileName));
+    if (!mPrintedFiles.contains(fileName))
+        mPrintedFiles.append(fileName);
+    return true;
+}
+
+QByteArray Printer::fingerprint(const File &file) const
+{
+    // Increase when the printed code changes for the same model
+    static const int s_outputVersion = 6;
+
+    QByteArray data;
+    QDataStream stream(&data, QIODevice::WriteOnly);
+    stream.setVersion(QDataStream::Qt_5_9);
+    stream << s_outputVersion << file.fingerprint() << d->mCreationWarning
+           << (d->mCreationWarning ? creationWarning() : QString()) << licenseHeader(file)
+           << d->mLabelsDefineIndent << d->mIndentLabels << d->mStatementsAfterIncludes
+           << d->mOptimizeMemberLayout << d->mPackBoolMembers;
+
+    return QCryptographicHash::hash(data, QCryptographicHash::Sha1);
+}
+
+void Printer::setFingerprintFile(const QString &fileName)
+{
+    d->mFingerprintFile = fileName;
+    d->mStoredFingerprints.clear();
+    d->mFingerprints.clear();
+
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly))
+        return;
+
+    while (!file.atEnd()) {
+        const QByteArray line = file.readLine().trimmed();
+        const int separator = line.indexOf(' ');
+        if (separator < 0)
+            continue;
+        d->mStoredFingerprints.insert(QString::fromUtf8(line.mid(separator + 1)),
+                                      QByteArray::fromHex(line.left(separator)));
+    }
+}
+
+void Printer::writeFingerprints()
+{
+    if (d->mFingerprintFile.isEmpty())
+        return;
+
+    QFile file(d->mFingerprintFile);
+    if (!file.open(QIODevice::WriteOnly)) {
+        qWarning("Can't open '%s' for writing.", qPrintable(d->mFingerprintFile));
+        return;
+    }
+
+    QStringList fileNames = d->mFingerprints.keys();
+    fileNames.sort();
+    for (const QString &fileName : std::as_const(fileNames))
+        file.write(d->mFingerprints.value(fileName).toHex() + ' ' + fileName.toUtf8() + '\n');
+}
+
+void Printer::setDependencies(const QStringList &dependencies)
+{
+    d->mDependencies = dependencies;
+}
+
+QStringList Printer::printedFiles() const
+{
+    return d->mPrintedFiles;
+}
+
+static QString escapeDepfilePath(const QString &path)
+{
+    QString escaped;
+    for (const QChar c : path) {
+        if (c == QLatin1Char(' ') || c == QLatin1Char('#'))
+            escaped += QLatin1Char('\\');
+        else if (c == QLatin1Char('$'))
+            escaped += QLatin1Char('$');
+        escaped += c;
+    }
+    return escaped;
+}
+
+void Printer::printDepfile(const QString &depfile)
+{
+    QString dependencies;
+    for (const QString &dependency : std::as_const(d->mDependencies))
+        dependencies += QLatin1String(" \\\n  ") + escapeDepfilePath(dependency);
+
+    QString text;
+    for (const QString &target : std::as_const(d->mPrintedFiles))
+        text += escapeDepfilePath(target) + QLatin1Char(':') + dependencies + QLatin1Char('\n');
+
+    QFile file(depfile);
+    if (!file.open(QIODevice::WriteOnly)) {
+        qWarning("Can't open '%s' for writing.", qPrintable(depfile));
+        return;
+    }
+    file.write(text.toLocal8Bit());
 }
 
 void Printer::Private::printCodeIntoFile(const Code &code, QFile *file)
 {
     const QString outText = code.text();
 
+    if (!mPrintedFiles.contains(file->fileName()))
+        mPrintedFiles.append(file->fileName());
+
     static bool s_compareOutput = qEnvironmentVariableIsSet("LIBKODE_COMPARE_OUTPUT");
 
     bool identical = false;
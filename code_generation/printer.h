@@ -21,6 +21,8 @@
 #ifndef KODE_PRINTER_H
 #define KODE_PRINTER_H
 
+#include <QtCore/QMap>
+
 #include "code.h"
 #include "file.h"
 #include "style.h"
@@ -104,6 +106,30 @@ public:
      */
     void setIndentLabels(bool b);
 
+    /**
+     * Sets whether the member variables of generated classes and of their
+     * private d-pointer classes are reordered by decreasing alignment, so
+     * that the objects contain as little padding as possible. The order is
+     * the same for all common ABIs and does not depend on the platform
+     * libkode runs on. Initializers, including the ones added with
+     * Function::addInitializer(), are emitted in the same order. Disabled
+     * by default.
+     */
+    void setOptimizeMemberLayout(bool b);
+
+    /**
+     * Sets whether non-static bool member variables are declared as
+     * one bit wide bitfields. Only used with setOptimizeMemberLayout().
+     */
+    void setPackBoolMembers(bool b);
+
+    /**
+     * Returns the number of bytes saved per object by the member layout
+     * optimization for each printed class, keyed by qualified class name.
+     * The sizes are estimated for a 64-bit target.
+     */
+    QMap<QString, int> memberLayoutSavings() const;
+
     /**
      * Prints the header of the class definitions in @param file.
      */
@@ -117,6 +143,45 @@ public:
      */
     void printImplementation(const File &file, bool createHeaderInclude = true);
 
+    /**
+     * Prints the implementation of the class definitions in @param file split
+     * into @param shardCount files named <implementation base name>_<n>.cpp, which
+     * can be compiled in parallel. The classes are distributed so that the shards
+     * have about the same size.
+     *
+     * The extern "C" declarations, the file code and the static file functions are
+     * printed into every shard, so the file code may only contain declarations and
+     * definitions with internal linkage. File variables and the other file functions
+     * are defined in the first shard and declared in the others. Static file variables
+     * lose the static, so that all shards share them.
+     *
+     * Returns the names of the shard files.
+     */
+    QStringList printShardedImplementation(const File &file, int shardCount,
+                                           bool createHeaderInclude = true);
+
+    /**
+     * Prints the implementations of all @param files and unity translation
+     * units which include up to @param batchSize of them each, named
+     * <baseName>_unity_<n>.cpp. Files defining file variables or functions
+     * with the same name, or declaring the same names at file scope in their
+     * file code, are put into different batches.
+     *
+     * Returns the names of the unity files, which are compiled instead of the
+     * individual implementation files.
+     */
+    QStringList printUnityImplementations(const File::List &files, const QString &baseName,
+                                          int batchSize = 8);
+
+    /**
+     * Prints a header @param filename to be used as precompiled header, which
+     * contains the global includes used by at least @param minimumUsage of the
+     * @param files, collected from the header and implementation includes of
+     * the files and their classes.
+     */
+    void printPrecompiledHeader(const File::List &files, const QString &filename,
+                                int minimumUsage = 2);
+
     /**
      * Prints a automake file as defined by @param autoMakefile.
      */
@@ -137,6 +202,47 @@ public:
      */
     void setStatementsAfterIncludes(const QStringList &statements);
 
+    /**
+     * Returns a hash of @param file and of the printer settings, which
+     * changes whenever the code printed for the file changes.
+     */
+    QByteArray fingerprint(const File &file) const;
+
+    /**
+     * Sets the @param fileName of a file with the fingerprints of the printed
+     * files and loads the fingerprints of the previous run from it. If set,
+     * printHeader(), printImplementation() and printShardedImplementation() do
+     * not render files which exist and were printed from an unchanged model,
+     * see fingerprint().
+     *
+     * Call writeFingerprints() after printing to store them for the next run.
+     */
+    void setFingerprintFile(const QString &fileName);
+
+    /**
+     * Writes the fingerprints of the files printed since setFingerprintFile()
+     * to the fingerprint file.
+     */
+    void writeFingerprints();
+
+    /**
+     * Sets the input files, e.g. the schema files returned by
+     * XSD::Parser::sourceFiles(), which all printed files depend on.
+     */
+    void setDependencies(const QStringList &dependencies);
+
+    /**
+     * Returns the paths of all files printed so far, including the ones
+     * which were not rewritten because their content did not change.
+     */
+    QStringList printedFiles() const;
+
+    /**
+     * Writes a Makefile/Ninja style @param depfile with one rule per printed
+     * file, which makes it depend on the files set with setDependencies().
+     */
+    void printDepfile(const QString &depfile);
+
 protected:
     /**
      * Returns the creation warning.
@@ -29,10 +29,57 @@ using namespace KODE;
 class StateMachine::Private
 {
 public:
+    struct Transition
+    {
+        QString mState;
+        QString mEvent;
+        QString mTargetState;
+    };
+
     QMap<QString, Code> mStateMap;
     QString mInitialState;
+    EmissionMode mEmissionMode = SwitchEmission;
+    QList<Transition> mTransitions;
+    QStringList mEvents;
+    QString mHandlerParameters;
+    QString mHandlerArguments;
+
+    QString handlerSignature(bool maybeUnused = false) const;
 };
 
+/**
+ * Returns the parameter list of the state handlers. Handlers only use some of
+ * the parameters, so in the handler definitions, @param maybeUnused is set to
+ * keep them from triggering -Wunused-parameter.
+ */
+QString StateMachine::Private::handlerSignature(bool maybeUnused) const
+{
+    QStringList parameters(QStringLiteral("State &state"));
+
+    // Split at the commas which are not part of a template argument or function type
+    int depth = 0;
+    int start = 0;
+    for (int i = 0; i <= mHandlerParameters.size(); ++i) {
+        const QChar c = i < mHandlerParameters.size() ? mHandlerParameters.at(i) : QChar(',');
+        if (c == QLatin1Char('<') || c == QLatin1Char('(') || c == QLatin1Char('['))
+            ++depth;
+        else if (c == QLatin1Char('>') || c == QLatin1Char(')') || c == QLatin1Char(']'))
+            --depth;
+        else if (c == QLatin1Char(',') && depth == 0) {
+            const QString parameter = mHandlerParameters.mid(start, i - start).trimmed();
+            if (!parameter.isEmpty())
+                parameters.append(parameter);
+            start = i + 1;
+        }
+    }
+
+    if (maybeUnused) {
+        for (QString &parameter : parameters)
+            parameter.prepend(QLatin1String("[[maybe_unused]] "));
+    }
+    return parameters.join(QLatin1String(", "));
+}
+
 StateMachine::StateMachine() : d(new Private) {}
 
 StateMachine::StateMachine(const StateMachine &other) : d(new Private)
@@ -68,6 +115,35 @@ void StateMachine::setInitialState(const QString &state)
     d->mInitialState = state;
 }
 
+void StateMachine::setEmissionMode(EmissionMode mode)
+{
+    d->mEmissionMode = mode;
+}
+
+StateMachine::EmissionMode StateMachine::emissionMode() const
+{
+    return d->mEmissionMode;
+}
+
+void StateMachine::addTransition(const QString &state, const QString &event,
+                                 const QString &targetState)
+{
+    Private::Transition transition;
+    transition.mState = state;
+    transition.mEvent = event;
+    transition.mTargetState = targetState;
+    d->mTransitions.append(transition);
+
+    if (!d->mEvents.contains(event))
+        d->mEvents.append(event);
+}
+
+void StateMachine::setHandlerArguments(const QString &parameters, const QString &arguments)
+{
+    d->mHandlerParameters = parameters;
+    d->mHandlerArguments = arguments;
+}
+
 Code StateMachine::stateDefinition() const
 {
     Code code;
@@ -78,9 +154,111 @@ Code StateMachine::stateDefinition() const
         states.append(it.key());
     }
 
-    code += QLatin1String("enum State { ") + states.join(QLatin1String(", "))
+    if (d->mEmissionMode == SwitchEmission) {
+        code += QLatin1String("enum State { ") + states.join(QLatin1String(", "))
+                + QLatin1String(" };");
+        code += QLatin1String("State state = ") + d->mInitialState + QLatin1Char(';');
+        return code;
+    }
+
+    // Dense values starting at 0, so that they can index the tables below
+    QStringList values;
+    QStringList names;
+    for (int i = 0; i < states.count(); ++i) {
+        values.append(states.at(i) + QLatin1String(" = ") + QString::number(i));
+        names.append(QLatin1Char('"') + states.at(i) + QLatin1Char('"'));
+    }
+
+    code += QLatin1String("enum class State : int { ") + values.join(QLatin1String(", "))
             + QLatin1String(" };");
-    code += QLatin1String("State state = ") + d->mInitialState + QLatin1Char(';');
+    code += QLatin1String("static constexpr int stateCount = ") + QString::number(states.count())
+            + QLatin1Char(';');
+    // Arrays of size zero are ill-formed
+    if (!states.isEmpty()) {
+        code += QLatin1String("static constexpr const char *const stateNames[stateCount] = { ")
+                + names.join(QLatin1String(", ")) + QLatin1String(" };");
+    }
+    code += QLatin1String("State state = State::") + d->mInitialState + QLatin1Char(';');
+
+    if (d->mEmissionMode == DispatchEmission && !states.isEmpty()) {
+        code += QLatin1String("using StateHandler = void (*)(") + d->handlerSignature()
+                + QLatin1String(");");
+        code += QLatin1String("static constexpr StateHandler stateHandlers[stateCount] = {");
+        code.indent();
+        for (it = d->mStateMap.constBegin(); it != d->mStateMap.constEnd(); ++it) {
+            code += QLatin1String("[](") + d->handlerSignature(true) + QLatin1String(") {");
+            code.indent();
+            code.addBlock(it.value());
+            code.unindent();
+            code += QLatin1String("},");
+        }
+        code.unindent();
+        code += QLatin1String("};");
+    }
+
+    return code;
+}
+
+Code StateMachine::transitionTable() const
+{
+    Code code;
+
+    if (d->mEmissionMode == SwitchEmission) {
+        qWarning("StateMachine::transitionTable() requires TableEmission or DispatchEmission");
+        return code;
+    }
+
+    QStringList values;
+    for (int i = 0; i < d->mEvents.count(); ++i) {
+        values.append(d->mEvents.at(i) + QLatin1String(" = ") + QString::number(i));
+    }
+
+    code += QLatin1String("enum class Event : int { ") + values.join(QLatin1String(", "))
+            + QLatin1String(" };");
+    code += QLatin1String("static constexpr int eventCount = ")
+            + QString::number(d->mEvents.count()) + QLatin1Char(';');
+    // Arrays of size zero are ill-formed, and without events nothing can happen
+    if (d->mEvents.isEmpty() || d->mStateMap.isEmpty())
+        return code;
+    code += QLatin1String("static constexpr State transitions[stateCount][eventCount] = {");
+    code.indent();
+
+    QMap<QString, Code>::ConstIterator it;
+    for (it = d->mStateMap.constBegin(); it != d->mStateMap.constEnd(); ++it) {
+        QStringList row;
+        for (const QString &event : std::as_const(d->mEvents)) {
+            QString target = it.key();
+            for (const Private::Transition &transition : std::as_const(d->mTransitions)) {
+                if (transition.mState == it.key() && transition.mEvent == event)
+                    target = transition.mTargetState;
+            }
+            row.append(QLatin1String("State::") + target);
+        }
+        code += QLatin1String("{ ") + row.join(QLatin1String(", ")) + QLatin1String(" }, // ")
+                + it.key();
+    }
+
+    code.unindent();
+    code += QLatin1String("};");
+
+    return code;
+}
+
+Code StateMachine::transition(const QString &eventExpression) const
+{
+    Code code;
+
+    if (d->mEmissionMode == SwitchEmission) {
+        qWarning("StateMachine::transition() requires TableEmission or DispatchEmission");
+        return code;
+    }
+    if (d->mEvents.isEmpty()) {
+        qWarning("StateMachine::transition() requires transitions");
+        return code;
+    }
+
+    code += QLatin1String("state = transitions[static_cast<int>(state)][static_cast<int>(")
+            + eventExpression + QLatin1String(")];");
 
     return code;
 }
@@ -89,12 +267,24 @@ Code StateMachine::transitionLogic() const
 {
     Code code;
 
+    if (d->mEmissionMode == DispatchEmission) {
+        QString arguments = QLatin1String("state");
+        if (!d->mHandlerArguments.isEmpty())
+            arguments += QLatin1String(", ") + d->mHandlerArguments;
+        code += QLatin1String("stateHandlers[static_cast<int>(state)](") + arguments
+                + QLatin1String(");");
+        return code;
+    }
+
+    const QString casePrefix = d->mEmissionMode == TableEmission ? QLatin1String("case State::")
+                                                                 : QLatin1String("case ");
+
     code += QLatin1String("switch( state ) {");
     code.indent();
 
     QMap<QString, Code>::ConstIterator it;
     for (it = d->mStateMap.constBegin(); it != d->mStateMap.constEnd(); ++it) {
-        code += QLatin1String("case ") + it.key() + QLatin1Char(':');
+        code += casePrefix + it.key() + QLatin1Char(':');
         code.indent();
         code.addBlock(it.value());
         code += QLatin1String("break;");
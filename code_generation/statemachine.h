@@ -36,6 +36,23 @@ namespace KODE {
 class KODE_EXPORT StateMachine
 {
 public:
+    /**
+     * The different ways the state machine can be emitted.
+     *
+     * @li SwitchEmission    - A plain enum and a switch over the states (default).
+     * @li TableEmission     - A dense enum class with explicit values, constexpr
+     *                         name and transition tables and a switch over the
+     *                         dense values, which compilers turn into a jump table.
+     * @li DispatchEmission  - Like TableEmission, but the state code is placed in
+     *                         captureless handlers which are called through a
+     *                         constexpr function pointer table (requires C++17).
+     *
+     * With TableEmission and DispatchEmission the state code has to refer to the
+     * states as State::Name, and with DispatchEmission it can only access the
+     * handler arguments (@see setHandlerArguments()).
+     */
+    enum EmissionMode { SwitchEmission, TableEmission, DispatchEmission };
+
     /**
      * Creates a new state machine.
      */
@@ -67,6 +84,32 @@ public:
      */
     void setInitialState(const QString &state);
 
+    /**
+     * Sets the emission @param mode of the state machine.
+     */
+    void setEmissionMode(EmissionMode mode);
+
+    /**
+     * Returns the emission mode of the state machine.
+     */
+    EmissionMode emissionMode() const;
+
+    /**
+     * Adds a transition from @param state to @param targetState,
+     * which is taken when @param event occurs.
+     *
+     * Transitions are only used by transitionTable() and transition().
+     */
+    void addTransition(const QString &state, const QString &event, const QString &targetState);
+
+    /**
+     * Sets the arguments passed to the state handlers in DispatchEmission mode.
+     *
+     * @param parameters The parameter declarations, e.g. "QXmlStreamReader &xml, Foo *result".
+     * @param arguments The arguments passed by the caller, e.g. "xml, result".
+     */
+    void setHandlerArguments(const QString &parameters, const QString &arguments);
+
     /**
      * Returns the code for the state definitions.
      */
@@ -77,6 +120,23 @@ public:
      */
     Code transitionLogic() const;
 
+    /**
+     * Returns the code for the event enum and the constexpr transition table.
+     * Events without an explicit transition keep the current state. Without
+     * any transition only the empty event enum is returned.
+     *
+     * Only available in TableEmission and DispatchEmission mode.
+     */
+    Code transitionTable() const;
+
+    /**
+     * Returns the code which moves the state machine to the next state
+     * for the event given by @param eventExpression.
+     *
+     * Only available in TableEmission and DispatchEmission mode.
+     */
+    Code transition(const QString &eventExpression) const;
+
 private:
     class Private;
     Private *d;
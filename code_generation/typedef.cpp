@@ -19,6 +19,8 @@
     Boston, MA 02110-1301, USA.
 */
 
+#include <QtCore/QCryptographicHash>
+#include <QtCore/QDataStream>
 #include <QtCore/QString>
 
 #include "typedef.h"
@@ -64,3 +66,13 @@ QString Typedef::declaration() const
 {
     return QLatin1String("typedef ") + d->mType + QLatin1Char(' ') + d->mAlias + QLatin1Char(';');
 }
+
+QByteArray Typedef::fingerprint() const
+{
+    QByteArray data;
+    QDataStream stream(&data, QIODevice::WriteOnly);
+    stream.setVersion(QDataStream::Qt_5_9);
+    stream << d->mType << d->mAlias;
+
+    return QCryptographicHash::hash(data, QCryptographicHash::Sha1);
+}
@@ -67,6 +67,12 @@ public:
      */
     QString declaration() const;
 
+    /**
+     * Returns a hash of the typedef, which changes whenever the
+     * code generated for it changes.
+     */
+    QByteArray fingerprint() const;
+
 private:
     class Private;
     Private *d;
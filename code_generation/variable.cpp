@@ -19,6 +19,8 @@
     Boston, MA 02110-1301, USA.
 */
 
+#include <QtCore/QCryptographicHash>
+#include <QtCore/QDataStream>
 #include <QtCore/QString>
 
 #include "membervariable.h"
@@ -111,3 +113,13 @@ QString Variable::initializer() const
 {
     return d->mInitializer;
 }
+
+QByteArray Variable::fingerprint() const
+{
+    QByteArray data;
+    QDataStream stream(&data, QIODevice::WriteOnly);
+    stream.setVersion(QDataStream::Qt_5_9);
+    stream << d->mType << d->mName << d->mIsStatic << d->mInitializer;
+
+    return QCryptographicHash::hash(data, QCryptographicHash::Sha1);
+}
@@ -103,6 +103,12 @@ public:
      */
     QString initializer() const;
 
+    /**
+     * Returns a hash of the variable, which changes whenever the
+     * code generated for it changes.
+     */
+    QByteArray fingerprint() const;
+
 private:
     class Private;
     Private *d;
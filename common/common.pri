@@ -5,11 +5,17 @@ HEADERS += \
   $$PWD/messagehandler.h \
   $$PWD/nsmanager.h \
   $$PWD/parsercontext.h \
-  $$PWD/qname.h
+  $$PWD/qname.h \
+  $$PWD/schemabundle.h \
+  $$PWD/schemafetcher.h \
+  $$PWD/xmlcatalog.h
 
 SOURCES += \
   $$PWD/fileprovider.cpp \
   $$PWD/messagehandler.cpp \
   $$PWD/nsmanager.cpp \
   $$PWD/parsercontext.cpp \
-  $$PWD/qname.cpp
+  $$PWD/qname.cpp \
+  $$PWD/schemabundle.cpp \
+  $$PWD/schemafetcher.cpp \
+  $$PWD/xmlcatalog.cpp
@@ -20,6 +20,7 @@
  */
 
 #include "fileprovider.h"
+#include "schemabundle.h"
 
 #include <QCoreApplication>
 #include <QEventLoop>
@@ -27,16 +28,92 @@
 #include <QUrl>
 #include <QDebug>
 #include <QDir>
+#include <QDirIterator>
+#include <QFileInfo>
+#include <QMutex>
 #include <QNetworkAccessManager>
 #include <QNetworkRequest>
 #include <QNetworkReply>
+#include <QSharedPointer>
 #include <QTemporaryFile>
+#include <QVector>
+
+#include <utility>
 
 #ifndef Q_OS_WIN
 #    include <unistd.h>
 #endif
 
 static QHash<QUrl, QByteArray> fileProviderCache;
+static QMutex fileProviderCacheMutex;
+
+static QVector<QSharedPointer<SchemaBundle>> mountedBundles;
+static QMutex mountedBundlesMutex;
+
+struct ImportPathIndex
+{
+    // Path relative to the import path -> absolute path of the file, the keys are
+    // case folded when the import path is on a case insensitive file system
+    QHash<QString, QString> files;
+    bool caseSensitive = true;
+
+    QString key(const QString &relativePath) const
+    {
+        return caseSensitive ? relativePath : relativePath.toCaseFolded();
+    }
+};
+
+static QHash<QString, ImportPathIndex> importPathIndex;
+static QMutex importPathIndexMutex;
+
+static ImportPathIndex buildImportPathIndex(const QString &importPath)
+{
+    ImportPathIndex index;
+    const QDir importDir(importPath);
+    QDirIterator it(importDir.absolutePath(), QDir::Files | QDir::Hidden,
+                    QDirIterator::Subdirectories | QDirIterator::FollowSymlinks);
+    while (it.hasNext()) {
+        const QString path = it.next();
+        index.files.insert(importDir.relativeFilePath(path), path);
+    }
+
+    // Like QFile::exists(), lookups follow the case sensitivity of the file system,
+    // which is probed with the upper case spelling of a listed file
+    for (auto fileIt = index.files.constBegin(); fileIt != index.files.constEnd(); ++fileIt) {
+        const QString upper = fileIt.key().toUpper();
+        if (upper != fileIt.key() && !index.files.contains(upper)) {
+            index.caseSensitive = !QFileInfo::exists(importDir.absoluteFilePath(upper));
+            break;
+        }
+    }
+    if (!index.caseSensitive) {
+        QHash<QString, QString> folded;
+        for (auto fileIt = index.files.constBegin(); fileIt != index.files.constEnd(); ++fileIt)
+            folded.insert(index.key(fileIt.key()), fileIt.value());
+        index.files = folded;
+    }
+    return index;
+}
+
+// Looks up host/path below @p importPath, listing the directory on first use
+static QString findInImportPath(const QString &importPath, const QString &relativePath)
+{
+    {
+        QMutexLocker locker(&importPathIndexMutex);
+        const auto it = importPathIndex.constFind(importPath);
+        if (it != importPathIndex.constEnd())
+            return it->files.value(it->key(relativePath));
+    }
+
+    // Listing a large import path takes a while, don't block the lookups of other threads.
+    // If another thread indexed the same path meanwhile, its index is kept.
+    const ImportPathIndex index = buildImportPathIndex(importPath);
+    QMutexLocker locker(&importPathIndexMutex);
+    auto it = importPathIndex.find(importPath);
+    if (it == importPathIndex.end())
+        it = importPathIndex.insert(importPath, index);
+    return it->files.value(it->key(relativePath));
+}
 
 FileProvider::FileProvider(bool useLocalFilesOnly, const QStringList &importPathList,
                            const QMap<QUrl, QString> &localSchemas)
@@ -59,12 +136,25 @@ void FileProvider::cleanUp()
     }
 }
 
-bool FileProvider::get(const QUrl &url, QString &target)
+bool FileProvider::isTemporary() const
 {
-    if (!mFileName.isEmpty()) {
-        cleanUp();
-    }
+    return !mFileName.isEmpty();
+}
 
+void FileProvider::setCatalog(const XmlCatalog &catalog)
+{
+    mCatalog = catalog;
+}
+
+QUrl FileProvider::resolve(const QUrl &url) const
+{
+    const QUrl location = mCatalog.resolve(url);
+    return location.isEmpty() ? url : location;
+}
+
+bool FileProvider::findLocal(const QUrl &location, QString &target) const
+{
+    const QUrl url = resolve(location);
     if (url.isLocalFile()) {
         target = url.toLocalFile();
         return true;
@@ -80,17 +170,101 @@ bool FileProvider::get(const QUrl &url, QString &target)
         return true;
     }
 
-    Q_FOREACH (const QString &importPath, mImportPathList) {
-        QDir importDir(importPath);
-        QString path = importDir.absoluteFilePath(url.host() + QDir::separator() + url.path());
-        if (QFile::exists(path)) {
-            qDebug("Using import path '%s'", qPrintable(path));
-            target = path;
+    if (!mImportPathList.isEmpty()) {
+        QString relativePath = QDir::cleanPath(url.host() + QLatin1Char('/') + url.path());
+        while (relativePath.startsWith(QLatin1Char('/'))) {
+            relativePath.remove(0, 1);
+        }
+        for (const QString &importPath : mImportPathList) {
+            const QString path = findInImportPath(importPath, relativePath);
+            if (!path.isEmpty()) {
+                qDebug("Using import path '%s'", qPrintable(path));
+                target = path;
+                return true;
+            }
+        }
+    }
+
+    return false;
+}
+
+void FileProvider::addToCache(const QUrl &url, const QByteArray &data)
+{
+    QMutexLocker locker(&fileProviderCacheMutex);
+    fileProviderCache.insert(url, data);
+}
+
+bool FileProvider::findInCache(const QUrl &url, QByteArray *data)
+{
+    QMutexLocker locker(&fileProviderCacheMutex);
+    const auto it = fileProviderCache.constFind(url);
+    if (it == fileProviderCache.constEnd()) {
+        return false;
+    }
+    *data = it.value();
+    return true;
+}
+
+bool FileProvider::mountBundle(const QString &fileName, QString *errorString)
+{
+    QSharedPointer<SchemaBundle> bundle(new SchemaBundle);
+    if (!bundle->open(fileName)) {
+        if (errorString) {
+            *errorString = bundle->errorString();
+        }
+        return false;
+    }
+    QMutexLocker locker(&mountedBundlesMutex);
+    mountedBundles.prepend(bundle);
+    return true;
+}
+
+void FileProvider::unmountBundles()
+{
+    QMutexLocker locker(&mountedBundlesMutex);
+    mountedBundles.clear();
+}
+
+bool FileProvider::findInBundles(const QUrl &url, QByteArray *data)
+{
+    QMutexLocker locker(&mountedBundlesMutex);
+    for (const QSharedPointer<SchemaBundle> &bundle : std::as_const(mountedBundles)) {
+        const QByteArray document = bundle->document(url);
+        if (!document.isNull()) {
+            // Detached from the mapped file, which goes away when unmounting
+            *data = QByteArray(document.constData(), document.size());
             return true;
         }
     }
+    return false;
+}
+
+void FileProvider::invalidateImportPathIndex()
+{
+    QMutexLocker locker(&importPathIndexMutex);
+    importPathIndex.clear();
+}
+
+void FileProvider::setDownloadsEnabled(bool enabled)
+{
+    mDownloadsEnabled = enabled;
+}
 
-    if (mUseLocalFilesOnly) {
+bool FileProvider::get(const QUrl &location, QString &target)
+{
+    if (!mFileName.isEmpty()) {
+        cleanUp();
+    }
+
+    // Bundled documents are written to a temporary file, like downloaded ones
+    QByteArray data;
+    const bool bundled = findInBundles(location, &data);
+    if (!bundled && findLocal(location, target)) {
+        return true;
+    }
+    const QUrl url = resolve(location);
+
+    if (!bundled && mUseLocalFilesOnly) {
         qCritical("ERROR: Could not find the local file for '%s'", qPrintable(url.toEncoded()));
         qCritical("ERROR: Try to download the file using:");
         qCritical("ERROR:  $ cd %s", qPrintable(mImportPathList.first()));
@@ -108,11 +282,11 @@ bool FileProvider::get(const QUrl &url, QString &target)
         mFileName = target;
     }
 
-    QByteArray data;
-    const QHash<QUrl, QByteArray>::const_iterator it = fileProviderCache.constFind(url);
-    if (it != fileProviderCache.constEnd()) {
-        data = it.value();
-    } else {
+    if (!bundled && !findInCache(url, &data)) {
+        if (!mDownloadsEnabled) {
+            qWarning("'%s' is not in the cache", url.toEncoded().constData());
+            return false;
+        }
         qDebug("Downloading '%s'", url.toEncoded().constData());
 
         QNetworkAccessManager manager;
@@ -132,7 +306,7 @@ bool FileProvider::get(const QUrl &url, QString &target)
 
         qDebug("Download successful");
         data = job->readAll();
-        fileProviderCache[url] = data;
+        addToCache(url, data);
     }
 
     QFile file(mFileName);
@@ -26,7 +26,10 @@
 
 #include <kode_export.h>
 
+#include "xmlcatalog.h"
+
 QT_BEGIN_NAMESPACE
+class QByteArray;
 class QUrl;
 QT_END_NAMESPACE
 
@@ -40,11 +43,71 @@ public:
     bool get(const QUrl &url, QString &target);
     void cleanUp();
 
+    /**
+     * Sets the XML catalog consulted before anything else, see resolve().
+     */
+    void setCatalog(const XmlCatalog &catalog);
+
+    /**
+     * Returns the location the catalog maps @p url to, or @p url if the
+     * catalog does not know it. get() and findLocal() look for that location.
+     */
+    QUrl resolve(const QUrl &url) const;
+
+    /**
+     * When downloads are disabled, get() only returns remote documents which
+     * are in the cache or in a mounted bundle, and fails for the others
+     * instead of downloading them in a nested event loop.
+     */
+    void setDownloadsEnabled(bool enabled);
+
+    /**
+     * Finds the file for @p url without downloading anything: local files,
+     * Qt resources, the local schemas and the files in the import paths.
+     */
+    bool findLocal(const QUrl &url, QString &target) const;
+
+    /**
+     * Downloaded files are kept in a cache shared by all providers, which can
+     * be used from several threads. Files added to it in advance, for instance
+     * by SchemaFetcher, are not downloaded by get() anymore.
+     */
+    static void addToCache(const QUrl &url, const QByteArray &data);
+    static bool findInCache(const QUrl &url, QByteArray *data);
+
+    /**
+     * Mounts the SchemaBundle @p fileName for all providers. The documents in
+     * mounted bundles are found by the URL they were bundled with, before
+     * looking anywhere else. Bundles mounted later take precedence.
+     * findInBundles() returns a copy of the document, so that bundles can be
+     * unmounted while documents read from them are still in use.
+     */
+    static bool mountBundle(const QString &fileName, QString *errorString = nullptr);
+    static void unmountBundles();
+    static bool findInBundles(const QUrl &url, QByteArray *data);
+
+    /**
+     * The files below each import path are listed once, the first time a URL
+     * is looked up in that path, and the index is shared by all providers.
+     * Lookups are case insensitive when the import path is on a case
+     * insensitive file system.
+     * Call this after adding or removing files in an import path.
+     */
+    static void invalidateImportPathIndex();
+
+    /**
+     * Returns whether the file returned by the last get() is a temporary copy
+     * of a downloaded file, which is removed again by cleanUp().
+     */
+    bool isTemporary() const;
+
 private:
     QString mFileName;
     bool mUseLocalFilesOnly = false;
+    bool mDownloadsEnabled = true;
     const QStringList mImportPathList;
     const QMap<QUrl, QString> mLocalSchemas;
+    XmlCatalog mCatalog;
 };
 
 #endif
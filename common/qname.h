@@ -69,6 +69,19 @@ inline uint qHash(const QName &qn)
     return qHash(qn.nameSpace()) ^ qHash(qn.localName());
 }
 
+// Needed for hashing QName as part of a QPair
+#if QT_VERSION >= QT_VERSION_CHECK(6, 0, 0)
+inline size_t qHash(const QName &qn, size_t seed) noexcept
+{
+    return qHashMulti(seed, qn.nameSpace(), qn.localName());
+}
+#else
+inline uint qHash(const QName &qn, uint seed)
+{
+    return qHash(qn) ^ seed;
+}
+#endif
+
 QDebug operator<<(QDebug dbg, const QName &qn);
 
 #endif
@@ -0,0 +1,258 @@
+/*
+    This file is part of KDE.
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Library General Public
+    License as published by the Free Software Foundation; either
+    version 2 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Library General Public License for more details.
+
+    You should have received a copy of the GNU Library General Public License
+    along with this library; see the file COPYING.LIB.  If not, write to
+    the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+    Boston, MA 02110-1301, USA.
+ */
+
+#include "schemabundle.h"
+
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QVector>
+#include <QtEndian>
+
+#include <climits>
+#include <cstring>
+#include <utility>
+
+static const char bundleMagic[] = "KODESBDL";
+static const quint32 bundleVersion = 1;
+static const quint32 compressedFlag = 0x1;
+static const int headerSize = 24;
+static const int entrySize = 32;
+
+static void appendLittleEndian32(QByteArray &data, quint32 value)
+{
+    uchar bytes[4];
+    qToLittleEndian(value, bytes);
+    data.append(reinterpret_cast<const char *>(bytes), sizeof(bytes));
+}
+
+static void appendLittleEndian64(QByteArray &data, quint64 value)
+{
+    uchar bytes[8];
+    qToLittleEndian(value, bytes);
+    data.append(reinterpret_cast<const char *>(bytes), sizeof(bytes));
+}
+
+SchemaBundle::SchemaBundle() = default;
+
+SchemaBundle::~SchemaBundle()
+{
+    close();
+}
+
+bool SchemaBundle::fail(const QString &message)
+{
+    close();
+    mErrorString = message;
+    return false;
+}
+
+static QByteArray bundleKey(const QUrl &url)
+{
+    return url.adjusted(QUrl::NormalizePathSegments).toEncoded();
+}
+
+bool SchemaBundle::open(const QString &fileName)
+{
+    close();
+    mErrorString.clear();
+
+    mFile.setFileName(fileName);
+    if (!mFile.open(QIODevice::ReadOnly)) {
+        return fail(QStringLiteral("Unable to open bundle '%1': %2")
+                            .arg(fileName, mFile.errorString()));
+    }
+    const quint64 fileSize = quint64(mFile.size());
+    if (fileSize < quint64(headerSize)) {
+        return fail(QStringLiteral("'%1' is not a schema bundle").arg(fileName));
+    }
+    mData = mFile.map(0, mFile.size());
+    if (!mData) {
+        return fail(QStringLiteral("Unable to map bundle '%1': %2")
+                            .arg(fileName, mFile.errorString()));
+    }
+
+    if (std::memcmp(mData, bundleMagic, 8) != 0) {
+        return fail(QStringLiteral("'%1' is not a schema bundle").arg(fileName));
+    }
+    if (qFromLittleEndian<quint32>(mData + 8) != bundleVersion) {
+        return fail(QStringLiteral("Unsupported version of schema bundle '%1'").arg(fileName));
+    }
+    const quint32 count = qFromLittleEndian<quint32>(mData + 12);
+    if (qFromLittleEndian<quint64>(mData + 16) != fileSize || count > quint32(INT_MAX)
+        || quint64(headerSize) + quint64(count) * entrySize > fileSize) {
+        return fail(QStringLiteral("Schema bundle '%1' is truncated").arg(fileName));
+    }
+
+    // Relative URLs are relative to the directory of the bundle
+    const QUrl baseUrl = QUrl::fromLocalFile(QFileInfo(fileName).absolutePath() + QLatin1Char('/'));
+
+    mEntries.reserve(int(count));
+    const uchar *index = mData + headerSize;
+    for (quint32 i = 0; i < count; ++i, index += entrySize) {
+        const quint64 urlOffset = qFromLittleEndian<quint64>(index);
+        const quint32 urlSize = qFromLittleEndian<quint32>(index + 8);
+        Entry entry;
+        entry.compressed = qFromLittleEndian<quint32>(index + 12) & compressedFlag;
+        entry.offset = qFromLittleEndian<quint64>(index + 16);
+        entry.storedSize = qFromLittleEndian<quint32>(index + 24);
+        entry.size = qFromLittleEndian<quint32>(index + 28);
+        // Everything handed out as QByteArray has to stay inside the mapping and
+        // fit into an int, an uncompressed document is exactly what is stored
+        if (urlOffset > fileSize || urlSize > fileSize - urlOffset || entry.offset > fileSize
+            || entry.storedSize > fileSize - entry.offset || urlSize > quint32(INT_MAX)
+            || entry.storedSize > quint32(INT_MAX) || entry.size > quint32(INT_MAX)
+            || (!entry.compressed && entry.size != entry.storedSize)) {
+            return fail(QStringLiteral("Schema bundle '%1' is corrupt").arg(fileName));
+        }
+        QByteArray url = QByteArray::fromRawData(
+                reinterpret_cast<const char *>(mData + urlOffset), int(urlSize));
+        const QUrl parsedUrl = QUrl::fromEncoded(url);
+        if (parsedUrl.isRelative()) {
+            url = baseUrl.resolved(parsedUrl).toEncoded();
+        } else if (bundleKey(parsedUrl) != url) {
+            url = bundleKey(parsedUrl);
+        }
+        mEntries.insert(url, entry);
+    }
+    return true;
+}
+
+void SchemaBundle::close()
+{
+    mEntries.clear();
+    if (mData) {
+        mFile.unmap(const_cast<uchar *>(mData));
+        mData = nullptr;
+    }
+    mFile.close();
+}
+
+bool SchemaBundle::isOpen() const
+{
+    return mData != nullptr;
+}
+
+QString SchemaBundle::fileName() const
+{
+    return mFile.fileName();
+}
+
+QString SchemaBundle::errorString() const
+{
+    return mErrorString;
+}
+
+QList<QUrl> SchemaBundle::urls() const
+{
+    QList<QUrl> urls;
+    urls.reserve(mEntries.size());
+    for (auto it = mEntries.constBegin(); it != mEntries.constEnd(); ++it) {
+        urls.append(QUrl::fromEncoded(it.key()));
+    }
+    return urls;
+}
+
+bool SchemaBundle::contains(const QUrl &url) const
+{
+    return mEntries.contains(bundleKey(url));
+}
+
+QByteArray SchemaBundle::document(const QUrl &url) const
+{
+    const auto it = mEntries.constFind(bundleKey(url));
+    if (it == mEntries.constEnd()) {
+        return QByteArray();
+    }
+    const Entry &entry = it.value();
+    if (entry.compressed) {
+        return qUncompress(mData + entry.offset, int(entry.storedSize));
+    }
+    return QByteArray::fromRawData(reinterpret_cast<const char *>(mData + entry.offset),
+                                   int(entry.size));
+}
+
+bool SchemaBundle::write(const QString &fileName, const QMap<QUrl, QByteArray> &documents,
+                         Compression compression, QString *errorString)
+{
+    struct Stored
+    {
+        QByteArray url;
+        QByteArray data;
+        quint32 size;
+        bool compressed;
+    };
+    QVector<Stored> stored;
+    stored.reserve(documents.size());
+    for (auto it = documents.constBegin(); it != documents.constEnd(); ++it) {
+        Stored document { it.key().toEncoded(), it.value(), quint32(it.value().size()), false };
+        if (compression == Compressed) {
+            const QByteArray packed = qCompress(document.data);
+            if (packed.size() < document.data.size()) {
+                document.data = packed;
+                document.compressed = true;
+            }
+        }
+        stored.append(document);
+    }
+
+    // URLs first, so the index and the URLs are close together at the start of the file
+    quint64 urlOffset = headerSize + quint64(stored.size()) * entrySize;
+    quint64 dataOffset = urlOffset;
+    for (const Stored &document : std::as_const(stored)) {
+        dataOffset += quint64(document.url.size());
+    }
+
+    QByteArray index;
+    index.reserve(stored.size() * entrySize);
+    for (const Stored &document : std::as_const(stored)) {
+        appendLittleEndian64(index, urlOffset);
+        appendLittleEndian32(index, quint32(document.url.size()));
+        appendLittleEndian32(index, document.compressed ? compressedFlag : 0);
+        appendLittleEndian64(index, dataOffset);
+        appendLittleEndian32(index, quint32(document.data.size()));
+        appendLittleEndian32(index, document.size);
+        urlOffset += quint64(document.url.size());
+        dataOffset += quint64(document.data.size());
+    }
+
+    QByteArray header(bundleMagic, 8);
+    appendLittleEndian32(header, bundleVersion);
+    appendLittleEndian32(header, quint32(stored.size()));
+    appendLittleEndian64(header, dataOffset);
+
+    QSaveFile file(fileName);
+    if (file.open(QIODevice::WriteOnly)) {
+        file.write(header);
+        file.write(index);
+        for (const Stored &document : std::as_const(stored)) {
+            file.write(document.url);
+        }
+        for (const Stored &document : std::as_const(stored)) {
+            file.write(document.data);
+        }
+        if (file.commit()) {
+            return true;
+        }
+    }
+    if (errorString) {
+        *errorString = QStringLiteral("Unable to write bundle '%1': %2")
+                               .arg(fileName, file.errorString());
+    }
+    return false;
+}
@@ -0,0 +1,103 @@
+/*
+    This file is part of KDE.
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Library General Public
+    License as published by the Free Software Foundation; either
+    version 2 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Library General Public License for more details.
+
+    You should have received a copy of the GNU Library General Public License
+    along with this library; see the file COPYING.LIB.  If not, write to
+    the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+    Boston, MA 02110-1301, USA.
+ */
+
+#ifndef SCHEMABUNDLE_H
+#define SCHEMABUNDLE_H
+
+#include <QByteArray>
+#include <QFile>
+#include <QHash>
+#include <QMap>
+#include <QUrl>
+
+#include <kode_export.h>
+
+/**
+  A single file holding many schema documents, indexed by their URL.
+
+  A bundle starts with a fixed size header and an index of fixed size
+  entries, followed by the URLs and the documents, all little endian:
+
+    magic "KODESBDL", quint32 version, quint32 entry count, quint64 file size
+    per entry: quint64 URL offset, quint32 URL size, quint32 flags,
+               quint64 data offset, quint32 stored size, quint32 size
+
+  Documents are stored as they are or compressed with qCompress(). Opening
+  a bundle maps the file into memory, so reading uncompressed documents
+  copies nothing and the whole bundle costs one open() and one mmap().
+
+  Relative URLs are relative to the directory of the bundle file, so a
+  bundle of local schemas can be moved along with them. URLs are compared
+  after removing "." and ".." segments.
+ */
+class KXMLCOMMON_EXPORT SchemaBundle
+{
+public:
+    enum Compression { Uncompressed, Compressed };
+
+    SchemaBundle();
+    ~SchemaBundle();
+
+    /**
+      Maps the bundle @p fileName into memory and reads its index. Returns
+      false if the file cannot be mapped or is not a valid bundle.
+     */
+    bool open(const QString &fileName);
+    void close();
+    bool isOpen() const;
+    QString fileName() const;
+    QString errorString() const;
+
+    QList<QUrl> urls() const;
+    bool contains(const QUrl &url) const;
+
+    /**
+      Returns the document stored for @p url, or a null QByteArray. An
+      uncompressed document refers to the mapped file and is only valid while
+      the bundle is open, copy it to keep it longer.
+     */
+    QByteArray document(const QUrl &url) const;
+
+    /**
+      Writes @p documents to the bundle @p fileName. With Compressed, each
+      document is compressed when that makes it smaller.
+     */
+    static bool write(const QString &fileName, const QMap<QUrl, QByteArray> &documents,
+                      Compression compression = Uncompressed, QString *errorString = nullptr);
+
+private:
+    Q_DISABLE_COPY(SchemaBundle)
+
+    struct Entry
+    {
+        quint64 offset;
+        quint32 storedSize;
+        quint32 size;
+        bool compressed;
+    };
+
+    bool fail(const QString &message);
+
+    QFile mFile;
+    const uchar *mData = nullptr;
+    QHash<QByteArray, Entry> mEntries; // keys refer to the mapped file
+    QString mErrorString;
+};
+
+#endif
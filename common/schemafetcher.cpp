@@ -0,0 +1,184 @@
+/*
+    This file is part of KDE.
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Library General Public
+    License as published by the Free Software Foundation; either
+    version 2 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Library General Public License for more details.
+
+    You should have received a copy of the GNU Library General Public License
+    along with this library; see the file COPYING.LIB.  If not, write to
+    the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+    Boston, MA 02110-1301, USA.
+ */
+
+#include "schemafetcher.h"
+
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QNetworkAccessManager>
+#include <QNetworkReply>
+#include <QNetworkRequest>
+#include <QTimer>
+#include <QXmlStreamReader>
+
+// Same rules as the schema parser: relative locations are local files next to the document
+static QUrl urlForLocation(const QUrl &documentUrl, const QString &location)
+{
+    const QUrl url(location);
+    if (url.isRelative() || url.scheme() == QLatin1String("file")) {
+        QString path = documentUrl.path();
+        path.truncate(path.lastIndexOf(QLatin1Char('/')));
+        return QUrl::fromLocalFile(QDir(path).filePath(location));
+    }
+    return url;
+}
+
+SchemaFetcher::SchemaFetcher(const QStringList &importPathList,
+                             const QMap<QUrl, QString> &localSchemas, QObject *parent)
+    : QObject(parent),
+      mProvider(false, importPathList, localSchemas),
+      mManager(new QNetworkAccessManager(this))
+{
+    mManager->setRedirectPolicy(QNetworkRequest::NoLessSafeRedirectPolicy);
+}
+
+SchemaFetcher::~SchemaFetcher()
+{
+    for (QNetworkReply *reply : mReplies.keys()) {
+        reply->disconnect(this);
+        reply->abort();
+    }
+}
+
+void SchemaFetcher::fetch(const QUrl &url)
+{
+    if (mCanceled || mSeen.contains(url)) {
+        return;
+    }
+    mSeen.insert(url);
+    mFinished = false;
+
+    QString fileName;
+    QByteArray data;
+    const QUrl location = mProvider.resolve(url);
+    if (FileProvider::findInBundles(url, &data)) {
+        scan(url, data);
+    } else if (mProvider.findLocal(url, fileName)) {
+        QFile file(fileName);
+        if (file.open(QIODevice::ReadOnly)) {
+            scan(url, file.readAll());
+        }
+    } else if (FileProvider::findInCache(location, &data)) {
+        scan(url, data);
+    } else {
+        qDebug("Downloading '%s'", location.toEncoded().constData());
+        QNetworkReply *reply = mManager->get(QNetworkRequest(location));
+        mReplies.insert(reply, url);
+        connect(reply, &QNetworkReply::finished, this,
+                [this, reply]() { downloadFinished(reply); });
+    }
+
+    Q_EMIT progress(mSeen.count() - mReplies.count(), mSeen.count());
+    // Also when everything was local, finished() is only emitted after returning
+    QTimer::singleShot(0, this, &SchemaFetcher::checkFinished);
+}
+
+void SchemaFetcher::setCatalog(const XmlCatalog &catalog)
+{
+    mProvider.setCatalog(catalog);
+}
+
+void SchemaFetcher::cancel()
+{
+    if (mCanceled) {
+        return;
+    }
+    mCanceled = true;
+
+    const QList<QNetworkReply *> replies = mReplies.keys();
+    mReplies.clear();
+    for (QNetworkReply *reply : replies) {
+        reply->disconnect(this);
+        reply->abort();
+        reply->deleteLater();
+    }
+    checkFinished();
+}
+
+bool SchemaFetcher::isFinished() const
+{
+    return mFinished;
+}
+
+bool SchemaFetcher::isCanceled() const
+{
+    return mCanceled;
+}
+
+QStringList SchemaFetcher::errors() const
+{
+    return mErrors;
+}
+
+void SchemaFetcher::scan(const QUrl &url, const QByteArray &data)
+{
+    QXmlStreamReader reader(data);
+    while (!reader.atEnd()) {
+        if (reader.readNext() != QXmlStreamReader::StartElement) {
+            continue;
+        }
+        const QString name = reader.name().toString();
+        if (name != QLatin1String("import") && name != QLatin1String("include")
+            && name != QLatin1String("redefine")) {
+            continue;
+        }
+
+        // schemaLocation for schemas, location for WSDL imports
+        const QXmlStreamAttributes attributes = reader.attributes();
+        QString location = attributes.value(QLatin1String("schemaLocation")).toString();
+        if (location.isEmpty()) {
+            location = attributes.value(QLatin1String("location")).toString();
+        }
+        if (location.isEmpty() || location == QLatin1String("http://schemas.xmlsoap.org/wsdl/")
+            || location.startsWith(QLatin1String("urn:"))) {
+            continue;
+        }
+        fetch(urlForLocation(url, location));
+    }
+}
+
+void SchemaFetcher::downloadFinished(QNetworkReply *reply)
+{
+    const QUrl url = mReplies.take(reply);
+    reply->deleteLater();
+
+    if (reply->error()) {
+        const QString message = QStringLiteral("Error downloading '%1': %2")
+                                        .arg(url.toString(), reply->errorString());
+        qWarning("%s", qPrintable(message));
+        mErrors.append(message);
+    } else {
+        const QByteArray data = reply->readAll();
+        FileProvider::addToCache(mProvider.resolve(url), data);
+        scan(url, data);
+    }
+
+    Q_EMIT progress(mSeen.count() - mReplies.count(), mSeen.count());
+    checkFinished();
+}
+
+void SchemaFetcher::checkFinished()
+{
+    if (mFinished || !mReplies.isEmpty()) {
+        return;
+    }
+    mFinished = true;
+    Q_EMIT finished(!mCanceled && mErrors.isEmpty());
+}
@@ -0,0 +1,106 @@
+/*
+    This file is part of KDE.
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Library General Public
+    License as published by the Free Software Foundation; either
+    version 2 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Library General Public License for more details.
+
+    You should have received a copy of the GNU Library General Public License
+    along with this library; see the file COPYING.LIB.  If not, write to
+    the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+    Boston, MA 02110-1301, USA.
+ */
+
+#ifndef SCHEMAFETCHER_H
+#define SCHEMAFETCHER_H
+
+#include <QHash>
+#include <QObject>
+#include <QSet>
+#include <QStringList>
+#include <QUrl>
+
+#include <kode_export.h>
+
+#include "fileprovider.h"
+
+QT_BEGIN_NAMESPACE
+class QNetworkAccessManager;
+class QNetworkReply;
+QT_END_NAMESPACE
+
+/**
+  Downloads a schema or WSDL document and all documents it imports or
+  includes, without blocking and without nested event loops. The downloaded
+  files are added to the cache of FileProvider, so parsing them afterwards
+  does not download anything.
+
+  Documents found locally by FileProvider are read to follow their imports,
+  but not cached. The fetcher needs a running event loop in its thread.
+ */
+class KXMLCOMMON_EXPORT SchemaFetcher : public QObject
+{
+    Q_OBJECT
+public:
+    explicit SchemaFetcher(const QStringList &importPathList = QStringList(),
+                           const QMap<QUrl, QString> &localSchemas = {},
+                           QObject *parent = nullptr);
+    ~SchemaFetcher() override;
+
+    /**
+      Starts fetching @p url and the documents it refers to. Returns
+      immediately, finished() is emitted once nothing is pending anymore.
+     */
+    void fetch(const QUrl &url);
+
+    /**
+      Sets the XML catalog used to map the locations before fetching them.
+     */
+    void setCatalog(const XmlCatalog &catalog);
+
+    /**
+      Aborts the pending downloads, finished() is emitted with false.
+     */
+    void cancel();
+
+    bool isFinished() const;
+    bool isCanceled() const;
+
+    /**
+      Returns the messages of the failed downloads.
+     */
+    QStringList errors() const;
+
+Q_SIGNALS:
+    /**
+      Emitted whenever a document arrived or was discovered.
+     */
+    void progress(int done, int total);
+
+    /**
+      Emitted once all documents are fetched, @p success is false if a
+      download failed or the fetcher was canceled.
+     */
+    void finished(bool success);
+
+private:
+    void scan(const QUrl &url, const QByteArray &data);
+    void downloadFinished(QNetworkReply *reply);
+    void checkFinished();
+
+    FileProvider mProvider;
+    QNetworkAccessManager *mManager;
+    QSet<QUrl> mSeen;
+    QHash<QNetworkReply *, QUrl> mReplies;
+    QStringList mErrors;
+    bool mCanceled = false;
+    bool mFinished = false;
+};
+
+#endif
@@ -0,0 +1,332 @@
+/*
+    This file is part of KDE.
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Library General Public
+    License as published by the Free Software Foundation; either
+    version 2 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Library General Public License for more details.
+
+    You should have received a copy of the GNU Library General Public License
+    along with this library; see the file COPYING.LIB.  If not, write to
+    the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+    Boston, MA 02110-1301, USA.
+ */
+
+#include "xmlcatalog.h"
+
+#include <QFile>
+#include <QFileInfo>
+#include <QXmlStreamReader>
+
+#include <algorithm>
+#include <functional>
+
+static const int maximumDelegationDepth = 32;
+
+static QString catalogNamespace()
+{
+    return QStringLiteral("urn:oasis:names:tc:entity:xmlns:xml:catalog");
+}
+
+static QString xmlNamespace()
+{
+    return QStringLiteral("http://www.w3.org/XML/1998/namespace");
+}
+
+static QString absoluteFileName(const QString &fileName)
+{
+    const QFileInfo info(fileName);
+    const QString canonical = info.canonicalFilePath();
+    return canonical.isEmpty() ? info.absoluteFilePath() : canonical;
+}
+
+void XmlCatalog::AffixTable::insert(const QString &key, const QString &value)
+{
+    const int length = key.size();
+    const auto it = std::lower_bound(mLengths.begin(), mLengths.end(), length, std::greater<int>());
+    if (it == mLengths.end() || *it != length) {
+        mLengths.insert(it, length);
+    }
+    mEntries[key].append(value);
+}
+
+QStringList XmlCatalog::AffixTable::findPrefix(const QString &string, int *length) const
+{
+    for (int keyLength : mLengths) {
+        if (keyLength > string.size()) {
+            continue;
+        }
+        const auto it = mEntries.constFind(string.left(keyLength));
+        if (it != mEntries.constEnd()) {
+            *length = keyLength;
+            return it.value();
+        }
+    }
+    return QStringList();
+}
+
+QStringList XmlCatalog::AffixTable::findSuffix(const QString &string) const
+{
+    for (int keyLength : mLengths) {
+        if (keyLength > string.size()) {
+            continue;
+        }
+        const auto it = mEntries.constFind(string.right(keyLength));
+        if (it != mEntries.constEnd()) {
+            return it.value();
+        }
+    }
+    return QStringList();
+}
+
+QStringList XmlCatalog::AffixTable::allPrefixes(const QString &string) const
+{
+    QStringList values;
+    for (int keyLength : mLengths) {
+        if (keyLength > string.size()) {
+            continue;
+        }
+        const auto it = mEntries.constFind(string.left(keyLength));
+        if (it != mEntries.constEnd()) {
+            for (const QString &value : it.value()) {
+                if (!values.contains(value)) {
+                    values.append(value);
+                }
+            }
+        }
+    }
+    return values;
+}
+
+XmlCatalog::XmlCatalog() = default;
+
+bool XmlCatalog::load(const QString &fileName)
+{
+    mErrorString.clear();
+    const int catalog = loadFile(fileName);
+    if (catalog < 0) {
+        return false;
+    }
+    if (!mRoots.contains(catalog)) {
+        mRoots.append(catalog);
+    }
+    return true;
+}
+
+bool XmlCatalog::isEmpty() const
+{
+    return mRoots.isEmpty();
+}
+
+void XmlCatalog::clear()
+{
+    mCatalogs.clear();
+    mCatalogIndex.clear();
+    mRoots.clear();
+    mErrorString.clear();
+}
+
+QString XmlCatalog::errorString() const
+{
+    return mErrorString;
+}
+
+int XmlCatalog::loadFile(const QString &fileName)
+{
+    const QString key = absoluteFileName(fileName);
+    const auto existing = mCatalogIndex.constFind(key);
+    if (existing != mCatalogIndex.constEnd()) {
+        return existing.value();
+    }
+
+    QFile file(key);
+    if (!file.open(QIODevice::ReadOnly)) {
+        mErrorString = QStringLiteral("Unable to open catalog '%1': %2")
+                               .arg(fileName, file.errorString());
+        return -1;
+    }
+
+    // Registered before reading, so catalogs referring to each other are loaded once
+    const int index = mCatalogs.size();
+    mCatalogs.append(Catalog());
+    mCatalogIndex.insert(key, index);
+
+    // Referenced catalogs are loaded right away, the catalog is then read-only
+    const auto referencedCatalog = [this](const QUrl &url) {
+        const QString referenced = url.isLocalFile() ? url.toLocalFile() : url.toString();
+        const QString previousError = mErrorString;
+        if (loadFile(referenced) < 0) {
+            qWarning("Skipping catalog: %s", qPrintable(mErrorString));
+            mErrorString = previousError;
+            return QString();
+        }
+        return absoluteFileName(referenced);
+    };
+
+    Catalog catalog;
+    QVector<QUrl> bases;
+    bases.append(QUrl::fromLocalFile(key));
+
+    QXmlStreamReader reader(&file);
+    while (!reader.atEnd()) {
+        const QXmlStreamReader::TokenType token = reader.readNext();
+        if (token == QXmlStreamReader::EndElement) {
+            bases.removeLast();
+            continue;
+        }
+        if (token != QXmlStreamReader::StartElement) {
+            continue;
+        }
+
+        const QXmlStreamAttributes attributes = reader.attributes();
+        QUrl base = bases.last();
+        const QString xmlBase = attributes.value(xmlNamespace(), QStringLiteral("base")).toString();
+        if (!xmlBase.isEmpty()) {
+            base = base.resolved(QUrl(xmlBase));
+        }
+        bases.append(base);
+
+        if (reader.namespaceUri() != catalogNamespace()) {
+            continue;
+        }
+        const auto attribute = [&attributes](const char *name) {
+            return attributes.value(QLatin1String(name)).toString();
+        };
+        const auto resolved = [&base](const QString &uri) {
+            return base.resolved(QUrl(uri)).toString();
+        };
+
+        const QString name = reader.name().toString();
+        if (name == QLatin1String("uri")) {
+            if (!catalog.uris.exact.contains(attribute("name"))) {
+                catalog.uris.exact.insert(attribute("name"), resolved(attribute("uri")));
+            }
+        } else if (name == QLatin1String("system")) {
+            if (!catalog.systems.exact.contains(attribute("systemId"))) {
+                catalog.systems.exact.insert(attribute("systemId"), resolved(attribute("uri")));
+            }
+        } else if (name == QLatin1String("rewriteURI")) {
+            catalog.uris.rewrite.insert(attribute("uriStartString"),
+                                        resolved(attribute("rewritePrefix")));
+        } else if (name == QLatin1String("rewriteSystem")) {
+            catalog.systems.rewrite.insert(attribute("systemIdStartString"),
+                                           resolved(attribute("rewritePrefix")));
+        } else if (name == QLatin1String("uriSuffix")) {
+            catalog.uris.suffix.insert(attribute("uriSuffix"), resolved(attribute("uri")));
+        } else if (name == QLatin1String("systemSuffix")) {
+            catalog.systems.suffix.insert(attribute("systemIdSuffix"), resolved(attribute("uri")));
+        } else if (name == QLatin1String("delegateURI")) {
+            const QString delegate = referencedCatalog(base.resolved(QUrl(attribute("catalog"))));
+            if (!delegate.isEmpty()) {
+                catalog.uris.delegate.insert(attribute("uriStartString"), delegate);
+            }
+        } else if (name == QLatin1String("delegateSystem")) {
+            const QString delegate = referencedCatalog(base.resolved(QUrl(attribute("catalog"))));
+            if (!delegate.isEmpty()) {
+                catalog.systems.delegate.insert(attribute("systemIdStartString"), delegate);
+            }
+        } else if (name == QLatin1String("nextCatalog")) {
+            const QString next = referencedCatalog(base.resolved(QUrl(attribute("catalog"))));
+            if (!next.isEmpty()) {
+                catalog.nextCatalogs.append(next);
+            }
+        }
+    }
+
+    if (reader.hasError()) {
+        mErrorString = QStringLiteral("Error[%1:%2] in catalog '%3': %4")
+                               .arg(reader.lineNumber())
+                               .arg(reader.columnNumber())
+                               .arg(fileName, reader.errorString());
+        // Catalogs referring to this one skip it, see resolveIn()
+        mCatalogIndex.remove(key);
+        return -1;
+    }
+
+    mCatalogs[index] = catalog;
+    return index;
+}
+
+QUrl XmlCatalog::resolveIn(int catalogIndex, const QString &identifier, bool system,
+                           int depth) const
+{
+    if (catalogIndex < 0 || depth > maximumDelegationDepth) {
+        return QUrl();
+    }
+    const Catalog &catalog = mCatalogs.at(catalogIndex);
+    const Entries &entries = system ? catalog.systems : catalog.uris;
+
+    const auto exact = entries.exact.constFind(identifier);
+    if (exact != entries.exact.constEnd()) {
+        return QUrl(exact.value());
+    }
+
+    int length = 0;
+    const QStringList rewrite = entries.rewrite.findPrefix(identifier, &length);
+    if (!rewrite.isEmpty()) {
+        return QUrl(rewrite.first() + identifier.mid(length));
+    }
+
+    const QStringList suffix = entries.suffix.findSuffix(identifier);
+    if (!suffix.isEmpty()) {
+        return QUrl(suffix.first());
+    }
+
+    // With a matching delegate, the next catalogs are not consulted anymore
+    const QStringList delegates = entries.delegate.allPrefixes(identifier);
+    if (!delegates.isEmpty()) {
+        for (const QString &delegate : delegates) {
+            const QUrl url =
+                    resolveIn(mCatalogIndex.value(delegate, -1), identifier, system, depth + 1);
+            if (!url.isEmpty()) {
+                return url;
+            }
+        }
+        return QUrl();
+    }
+
+    for (const QString &next : catalog.nextCatalogs) {
+        const QUrl url = resolveIn(mCatalogIndex.value(next, -1), identifier, system, depth + 1);
+        if (!url.isEmpty()) {
+            return url;
+        }
+    }
+    return QUrl();
+}
+
+QUrl XmlCatalog::resolveUri(const QString &uri) const
+{
+    for (int root : mRoots) {
+        const QUrl url = resolveIn(root, uri, false, 0);
+        if (!url.isEmpty()) {
+            return url;
+        }
+    }
+    return QUrl();
+}
+
+QUrl XmlCatalog::resolveSystem(const QString &systemId) const
+{
+    for (int root : mRoots) {
+        const QUrl url = resolveIn(root, systemId, true, 0);
+        if (!url.isEmpty()) {
+            return url;
+        }
+    }
+    return QUrl();
+}
+
+QUrl XmlCatalog::resolve(const QUrl &url) const
+{
+    if (mRoots.isEmpty()) {
+        return QUrl();
+    }
+    const QString location = url.toString();
+    const QUrl resolved = resolveUri(location);
+    return resolved.isEmpty() ? resolveSystem(location) : resolved;
+}
@@ -0,0 +1,119 @@
+/*
+    This file is part of KDE.
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Library General Public
+    License as published by the Free Software Foundation; either
+    version 2 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Library General Public License for more details.
+
+    You should have received a copy of the GNU Library General Public License
+    along with this library; see the file COPYING.LIB.  If not, write to
+    the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+    Boston, MA 02110-1301, USA.
+ */
+
+#ifndef XMLCATALOG_H
+#define XMLCATALOG_H
+
+#include <QHash>
+#include <QStringList>
+#include <QUrl>
+#include <QVector>
+
+#include <kode_export.h>
+
+/**
+  An OASIS XML catalog, used to map the locations of schemas to local copies.
+
+  The uri, rewriteURI, uriSuffix, delegateURI, system, rewriteSystem,
+  systemSuffix, delegateSystem and nextCatalog entries are supported, also
+  inside group elements and with xml:base. Delegated and next catalogs are
+  loaded together with the catalog, so a loaded catalog is not modified
+  anymore and can be used from several threads.
+
+  Exact entries are looked up in a hash. Prefix and suffix entries are hashed
+  by their length, so a lookup costs one hash lookup per distinct length
+  instead of a comparison with every entry.
+ */
+class KXMLCOMMON_EXPORT XmlCatalog
+{
+public:
+    XmlCatalog();
+
+    /**
+      Loads the catalog file @p fileName in addition to the catalogs loaded
+      before. Returns false if the file cannot be read or parsed, see
+      errorString(). Delegated and next catalogs which cannot be read are
+      skipped with a warning, as the specification asks for.
+     */
+    bool load(const QString &fileName);
+
+    bool isEmpty() const;
+    void clear();
+    QString errorString() const;
+
+    /**
+      Returns the URI the catalog maps the URI reference @p uri to, or an
+      empty URL if the catalog does not know it.
+     */
+    QUrl resolveUri(const QString &uri) const;
+
+    /**
+      Returns the URI the catalog maps the system identifier @p systemId to,
+      or an empty URL if the catalog does not know it.
+     */
+    QUrl resolveSystem(const QString &systemId) const;
+
+    /**
+      Resolves a schema location, as URI reference first and as system
+      identifier if that fails. Returns an empty URL if nothing matches.
+     */
+    QUrl resolve(const QUrl &url) const;
+
+private:
+    // Entries mapping a prefix or a suffix, hashed by the length of the key
+    class AffixTable
+    {
+    public:
+        void insert(const QString &key, const QString &value);
+        // Returns the values of the longest matching key
+        QStringList findPrefix(const QString &string, int *length) const;
+        QStringList findSuffix(const QString &string) const;
+        // Returns the values of all matching keys, longest key first
+        QStringList allPrefixes(const QString &string) const;
+
+    private:
+        QVector<int> mLengths; // descending
+        QHash<QString, QStringList> mEntries;
+    };
+
+    struct Entries
+    {
+        QHash<QString, QString> exact;
+        AffixTable rewrite;
+        AffixTable suffix;
+        AffixTable delegate; // values are catalog file names
+    };
+
+    struct Catalog
+    {
+        Entries uris;
+        Entries systems;
+        QStringList nextCatalogs;
+    };
+
+    int loadFile(const QString &fileName);
+    QUrl resolveIn(int catalog, const QString &identifier, bool system, int depth) const;
+
+    QVector<Catalog> mCatalogs;
+    QHash<QString, int> mCatalogIndex; // absolute file name -> index in mCatalogs
+    QVector<int> mRoots;
+    QString mErrorString;
+};
+
+#endif
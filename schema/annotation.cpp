@@ -20,12 +20,13 @@
  */
 
 #include "annotation.h"
+#include "arena.h"
 
 #include <common/qname.h>
 
 namespace XSD {
 
-class Annotation::Private
+class Annotation::Private : public ArenaAllocated
 {
 public:
     QDomElement mDomElement;
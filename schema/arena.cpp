@@ -0,0 +1,191 @@
+/*
+    This file is part of KDE Schema Parser
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Library General Public
+    License as published by the Free Software Foundation; either
+    version 2 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Library General Public License for more details.
+
+    You should have received a copy of the GNU Library General Public License
+    along with this library; see the file COPYING.LIB.  If not, write to
+    the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+    Boston, MA 02110-1301, USA.
+ */
+
+#include "arena.h"
+
+#include <atomic>
+#include <cstdint>
+#include <new>
+#include <vector>
+
+namespace XSD {
+
+// An object of an arena follows a header pointing to its arena. The objects start at
+// an odd multiple of the pointer size, while heap allocations are aligned to at least
+// two pointers, so the address tells who owns an object without any lookup.
+static const std::size_t headerSize = sizeof(void *);
+static const std::size_t chunkAlignment = 2 * sizeof(void *);
+static_assert(__STDCPP_DEFAULT_NEW_ALIGNMENT__ % chunkAlignment == 0,
+              "heap allocations must not look like arena objects");
+static const std::size_t blockSize = 64 * 1024;
+// Freed chunks up to this size are reused by the arena
+static const std::size_t freeListCount = 64;
+
+static bool isArenaObject(const void *pointer)
+{
+    return (reinterpret_cast<std::uintptr_t>(pointer) & headerSize) != 0;
+}
+
+// Size of the header and the object, keeping the next object at an odd multiple
+static std::size_t chunkSize(std::size_t size)
+{
+    return (size + headerSize + chunkAlignment - 1) & ~(chunkAlignment - 1);
+}
+
+class Arena::Private
+{
+public:
+    ~Private()
+    {
+        for (char *block : mBlocks)
+            ::operator delete(block);
+    }
+
+    void ref() { mReferences.fetch_add(1, std::memory_order_relaxed); }
+    void deref()
+    {
+        if (mReferences.fetch_sub(1, std::memory_order_acq_rel) == 1)
+            delete this;
+    }
+
+    void *allocate(std::size_t size);
+    void recycle(void *object, std::size_t size);
+
+    // One for each Arena sharing this and one for each live object
+    std::atomic<int> mReferences{ 1 };
+    std::atomic<int> mLiveObjects{ 0 };
+    std::vector<char *> mBlocks;
+    char *mCurrent = nullptr;
+    std::size_t mRemaining = 0;
+    qint64 mAllocatedBytes = 0;
+    // Chunks freed while the arena was active, by chunk size. Only touched by the
+    // thread with the active scope, so they need no lock.
+    void *mFreeChunks[freeListCount] = {};
+};
+
+// The Arena::Private of the active scope of the thread
+static thread_local void *currentArena = nullptr;
+
+void *Arena::Private::allocate(std::size_t size)
+{
+    const std::size_t needed = chunkSize(size);
+    char *chunk = nullptr;
+    const std::size_t freeList = needed / chunkAlignment;
+    if (freeList < freeListCount && mFreeChunks[freeList]) {
+        chunk = static_cast<char *>(mFreeChunks[freeList]);
+        mFreeChunks[freeList] = *reinterpret_cast<void **>(chunk);
+    } else {
+        if (needed > mRemaining) {
+            const std::size_t bytes = needed > blockSize ? needed : blockSize;
+            mCurrent = static_cast<char *>(::operator new(bytes));
+            mRemaining = bytes;
+            mBlocks.push_back(mCurrent);
+            mAllocatedBytes += bytes;
+        }
+        chunk = mCurrent;
+        mCurrent += needed;
+        mRemaining -= needed;
+    }
+
+    *reinterpret_cast<Private **>(chunk) = this;
+    ref();
+    mLiveObjects.fetch_add(1, std::memory_order_relaxed);
+    return chunk + headerSize;
+}
+
+void Arena::Private::recycle(void *object, std::size_t size)
+{
+    const std::size_t freeList = chunkSize(size) / chunkAlignment;
+    if (freeList >= freeListCount)
+        return;
+    char *chunk = static_cast<char *>(object) - headerSize;
+    *reinterpret_cast<void **>(chunk) = mFreeChunks[freeList];
+    mFreeChunks[freeList] = chunk;
+}
+
+Arena::Arena() : d(new Private) {}
+
+Arena::Arena(const Arena &other) : d(other.d)
+{
+    d->ref();
+}
+
+Arena::~Arena()
+{
+    d->deref();
+}
+
+Arena &Arena::operator=(const Arena &other)
+{
+    if (d == other.d) {
+        return *this;
+    }
+
+    other.d->ref();
+    d->deref();
+    d = other.d;
+
+    return *this;
+}
+
+qint64 Arena::allocatedBytes() const
+{
+    return d->mAllocatedBytes;
+}
+
+int Arena::liveObjectCount() const
+{
+    return d->mLiveObjects.load(std::memory_order_relaxed);
+}
+
+Arena::Scope::Scope(const Arena *arena) : mPrevious(currentArena), mActive(arena != nullptr)
+{
+    if (mActive)
+        currentArena = arena->d;
+}
+
+Arena::Scope::~Scope()
+{
+    if (mActive)
+        currentArena = mPrevious;
+}
+
+void *Arena::allocate(std::size_t size)
+{
+    if (currentArena)
+        return static_cast<Private *>(currentArena)->allocate(size);
+    return ::operator new(size);
+}
+
+void Arena::deallocate(void *pointer, std::size_t size) noexcept
+{
+    if (!isArenaObject(pointer)) {
+        ::operator delete(pointer);
+        return;
+    }
+
+    Private *arena = *reinterpret_cast<Private **>(static_cast<char *>(pointer) - headerSize);
+    // The active scope keeps a reference, the chunk can be reused right away
+    if (arena == currentArena)
+        arena->recycle(pointer, size);
+    arena->mLiveObjects.fetch_sub(1, std::memory_order_relaxed);
+    arena->deref();
+}
+
+}
@@ -0,0 +1,91 @@
+/*
+    This file is part of KDE Schema Parser
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Library General Public
+    License as published by the Free Software Foundation; either
+    version 2 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Library General Public License for more details.
+
+    You should have received a copy of the GNU Library General Public License
+    along with this library; see the file COPYING.LIB.  If not, write to
+    the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+    Boston, MA 02110-1301, USA.
+ */
+
+#ifndef SCHEMA_ARENA_H
+#define SCHEMA_ARENA_H
+
+#include <QtGlobal>
+#include <kode_export.h>
+
+#include <cstddef>
+
+namespace XSD {
+
+// Monotonic allocator for the private data of the schema model. While a scope
+// of an arena is active, the private objects created by the thread are carved
+// out of large blocks of the arena. Objects deleted while the scope is still
+// active are reused for the next allocations of the same size, others only free
+// their memory once the arena and all objects allocated in it are gone.
+// Copies of an arena share the blocks.
+// Objects in an arena follow a pointer to it, and their address tells them apart
+// from heap allocations, which carry no header. Deleting needs no lock.
+class SCHEMA_EXPORT Arena
+{
+public:
+    Arena();
+    Arena(const Arena &other);
+    ~Arena();
+
+    Arena &operator=(const Arena &other);
+
+    // Bytes of the blocks allocated so far
+    qint64 allocatedBytes() const;
+
+    // Number of objects allocated in the arena which still exist
+    int liveObjectCount() const;
+
+    // Makes the arena the current arena of the thread for its lifetime, or
+    // leaves the current arena as it is for a null arena. Scopes of the same
+    // arena must not be active in several threads at once.
+    class SCHEMA_EXPORT Scope
+    {
+    public:
+        explicit Scope(const Arena *arena);
+        ~Scope();
+
+    private:
+        Q_DISABLE_COPY(Scope)
+        void *mPrevious;
+        bool mActive;
+    };
+
+    // Allocates from the current arena of the thread, or from the heap if there is none
+    static void *allocate(std::size_t size);
+    // Frees memory from allocate() of @p size bytes, in any thread
+    static void deallocate(void *pointer, std::size_t size) noexcept;
+
+private:
+    class Private;
+    Private *d;
+};
+
+// Base class for the private classes of the model, allocating them in the current arena
+class ArenaAllocated
+{
+public:
+    static void *operator new(std::size_t size) { return Arena::allocate(size); }
+    static void operator delete(void *pointer, std::size_t size) noexcept
+    {
+        Arena::deallocate(pointer, size);
+    }
+};
+
+}
+
+#endif
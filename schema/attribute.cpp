@@ -21,10 +21,11 @@
  */
 
 #include "attribute.h"
+#include "arena.h"
 
 namespace XSD {
 
-class Attribute::Private
+class Attribute::Private : public ArenaAllocated
 {
 public:
     Private() : mQualified(false), mUse(Optional) {}
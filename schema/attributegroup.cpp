@@ -19,10 +19,11 @@
 */
 
 #include "attributegroup.h"
+#include "arena.h"
 
 namespace XSD {
 
-class AttributeGroup::Private
+class AttributeGroup::Private : public ArenaAllocated
 {
 public:
     QName mReference;
@@ -0,0 +1,932 @@
+/*
+    This file is part of KDE Schema Parser
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Library General Public
+    License as published by the Free Software Foundation; either
+    version 2 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Library General Public License for more details.
+
+    You should have received a copy of the GNU Library General Public License
+    along with this library; see the file COPYING.LIB.  If not, write to
+    the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+    Boston, MA 02110-1301, USA.
+ */
+
+#include "builtintypes.h"
+
+#include <QChar>
+#include <QtAlgorithms>
+#include <QtNumeric>
+
+#include <limits>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+namespace XSD {
+
+namespace {
+
+// Indexed by BuiltinTypes::Type
+const char *const typeNames[] = {
+    nullptr,
+    "string",
+    "normalizedString",
+    "token",
+    "language",
+    "NMTOKEN",
+    "Name",
+    "NCName",
+    "QName",
+    "anyURI",
+    "boolean",
+    "decimal",
+    "float",
+    "double",
+    "integer",
+    "nonPositiveInteger",
+    "negativeInteger",
+    "long",
+    "int",
+    "short",
+    "byte",
+    "nonNegativeInteger",
+    "positiveInteger",
+    "unsignedLong",
+    "unsignedInt",
+    "unsignedShort",
+    "unsignedByte",
+    "duration",
+    "dateTime",
+    "date",
+    "time",
+    "hexBinary",
+    "base64Binary",
+};
+Q_STATIC_ASSERT(sizeof(typeNames) / sizeof(*typeNames) == BuiltinTypes::Base64Binary + 1);
+
+#ifdef __SSE2__
+// Lanes of @p chunk with a value in [low, low + span]
+inline __m128i inRange8(__m128i chunk, char low, char span)
+{
+    const __m128i offset = _mm_sub_epi8(chunk, _mm_set1_epi8(low));
+    const __m128i limit = _mm_set1_epi8(span);
+    return _mm_cmpeq_epi8(_mm_max_epu8(offset, limit), limit);
+}
+
+inline __m128i inRange16(__m128i chunk, short low, short span)
+{
+    const __m128i offset = _mm_sub_epi16(chunk, _mm_set1_epi16(low));
+    return _mm_cmpeq_epi16(_mm_subs_epu16(offset, _mm_set1_epi16(span)), _mm_setzero_si128());
+}
+
+// Lanes of @p chunk with a value of at least @p low
+inline __m128i atLeast8(__m128i chunk, char low)
+{
+    return _mm_cmpeq_epi8(_mm_max_epu8(chunk, _mm_set1_epi8(low)), chunk);
+}
+
+inline __m128i atLeast16(__m128i chunk, short low)
+{
+    return _mm_cmpeq_epi16(_mm_subs_epu16(_mm_set1_epi16(low), chunk), _mm_setzero_si128());
+}
+
+inline __m128i equal8(__m128i chunk, char c)
+{
+    return _mm_cmpeq_epi8(chunk, _mm_set1_epi8(c));
+}
+
+inline __m128i equal16(__m128i chunk, short c)
+{
+    return _mm_cmpeq_epi16(chunk, _mm_set1_epi16(c));
+}
+#endif
+
+// Character classes: a scalar test, and tests of 16 UTF-8 bytes or of
+// 8 UTF-16 code units setting the lanes of the matching characters
+
+struct DigitClass
+{
+    static bool match(uint c) { return c - '0' <= 9; }
+#ifdef __SSE2__
+    static __m128i match8(__m128i c) { return inRange8(c, '0', 9); }
+    static __m128i match16(__m128i c) { return inRange16(c, '0', 9); }
+#endif
+};
+
+struct HexClass
+{
+    static bool match(uint c) { return c - '0' <= 9 || (c | 0x20) - 'a' <= 5; }
+#ifdef __SSE2__
+    static __m128i match8(__m128i c)
+    {
+        return _mm_or_si128(inRange8(c, '0', 9),
+                            inRange8(_mm_or_si128(c, _mm_set1_epi8(0x20)), 'a', 5));
+    }
+    static __m128i match16(__m128i c)
+    {
+        return _mm_or_si128(inRange16(c, '0', 9),
+                            inRange16(_mm_or_si128(c, _mm_set1_epi16(0x20)), 'a', 5));
+    }
+#endif
+};
+
+struct Base64Class
+{
+    static bool match(uint c)
+    {
+        return c - 'A' <= 25 || c - 'a' <= 25 || c - '0' <= 9 || c == '+' || c == '/';
+    }
+#ifdef __SSE2__
+    static __m128i match8(__m128i c)
+    {
+        const __m128i letters = _mm_or_si128(inRange8(c, 'A', 25), inRange8(c, 'a', 25));
+        const __m128i symbols = _mm_or_si128(equal8(c, '+'), equal8(c, '/'));
+        return _mm_or_si128(_mm_or_si128(letters, inRange8(c, '0', 9)), symbols);
+    }
+    static __m128i match16(__m128i c)
+    {
+        const __m128i letters = _mm_or_si128(inRange16(c, 'A', 25), inRange16(c, 'a', 25));
+        const __m128i symbols = _mm_or_si128(equal16(c, '+'), equal16(c, '/'));
+        return _mm_or_si128(_mm_or_si128(letters, inRange16(c, '0', 9)), symbols);
+    }
+#endif
+};
+
+// ASCII name characters, without the colon
+struct NameClass
+{
+    static bool match(uint c)
+    {
+        return (c | 0x20) - 'a' <= 25 || c - '0' <= 9 || c == '.' || c == '-' || c == '_';
+    }
+#ifdef __SSE2__
+    static __m128i match8(__m128i c)
+    {
+        const __m128i letters = inRange8(_mm_or_si128(c, _mm_set1_epi8(0x20)), 'a', 25);
+        const __m128i symbols =
+                _mm_or_si128(_mm_or_si128(equal8(c, '.'), equal8(c, '-')), equal8(c, '_'));
+        return _mm_or_si128(_mm_or_si128(letters, inRange8(c, '0', 9)), symbols);
+    }
+    static __m128i match16(__m128i c)
+    {
+        const __m128i letters = inRange16(_mm_or_si128(c, _mm_set1_epi16(0x20)), 'a', 25);
+        const __m128i symbols =
+                _mm_or_si128(_mm_or_si128(equal16(c, '.'), equal16(c, '-')), equal16(c, '_'));
+        return _mm_or_si128(_mm_or_si128(letters, inRange16(c, '0', 9)), symbols);
+    }
+#endif
+};
+
+// Anything but spaces and control characters
+struct NonSpaceClass
+{
+    static bool match(uint c) { return c > 0x20; }
+#ifdef __SSE2__
+    static __m128i match8(__m128i c) { return atLeast8(c, 0x21); }
+    static __m128i match16(__m128i c) { return atLeast16(c, 0x21); }
+#endif
+};
+
+// Anything but control characters
+struct PrintableClass
+{
+    static bool match(uint c) { return c >= 0x20; }
+#ifdef __SSE2__
+    static __m128i match8(__m128i c) { return atLeast8(c, 0x20); }
+    static __m128i match16(__m128i c) { return atLeast16(c, 0x20); }
+#endif
+};
+
+// Anything but tabs and line breaks
+struct NoLineBreakClass
+{
+    static bool match(uint c) { return c != '\t' && c != '\n' && c != '\r'; }
+#ifdef __SSE2__
+    static __m128i match8(__m128i c)
+    {
+        const __m128i breaks =
+                _mm_or_si128(_mm_or_si128(equal8(c, '\t'), equal8(c, '\n')), equal8(c, '\r'));
+        return _mm_cmpeq_epi8(breaks, _mm_setzero_si128());
+    }
+    static __m128i match16(__m128i c)
+    {
+        const __m128i breaks = _mm_or_si128(_mm_or_si128(equal16(c, '\t'), equal16(c, '\n')),
+                                            equal16(c, '\r'));
+        return _mm_cmpeq_epi16(breaks, _mm_setzero_si128());
+    }
+#endif
+};
+
+// Returns the length of the prefix of @p data made of characters of the class
+template<typename Class>
+int classPrefix(const uchar *data, int length)
+{
+    int i = 0;
+#ifdef __SSE2__
+    for (; i + 16 <= length; i += 16) {
+        const __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + i));
+        const uint mask = uint(_mm_movemask_epi8(Class::match8(chunk)));
+        if (mask != 0xffff)
+            return i + int(qCountTrailingZeroBits(~mask));
+    }
+#endif
+    while (i < length && Class::match(data[i]))
+        ++i;
+    return i;
+}
+
+template<typename Class>
+int classPrefix(const ushort *data, int length)
+{
+    int i = 0;
+#ifdef __SSE2__
+    for (; i + 8 <= length; i += 8) {
+        const __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + i));
+        const uint mask = uint(_mm_movemask_epi8(Class::match16(chunk)));
+        if (mask != 0xffff)
+            return i + int(qCountTrailingZeroBits(~mask)) / 2;
+    }
+#endif
+    while (i < length && Class::match(data[i]))
+        ++i;
+    return i;
+}
+
+template<typename Char>
+struct Scanner
+{
+    Scanner(const Char *characters, int count) : data(characters), length(count) {}
+
+    bool atEnd() const { return pos == length; }
+    uint peek() const { return pos < length ? uint(data[pos]) : 0; }
+    bool accept(char c)
+    {
+        if (pos < length && uint(data[pos]) == uint(c)) {
+            ++pos;
+            return true;
+        }
+        return false;
+    }
+
+    const Char *data;
+    int length;
+    int pos = 0;
+};
+
+template<typename Class, typename Char>
+int skip(Scanner<Char> &s)
+{
+    const int count = classPrefix<Class>(s.data + s.pos, s.length - s.pos);
+    s.pos += count;
+    return count;
+}
+
+// Reads exactly @p count digits
+template<typename Char>
+bool number(Scanner<Char> &s, int count, int *value)
+{
+    if (s.length - s.pos < count)
+        return false;
+    int result = 0;
+    for (int i = 0; i < count; ++i) {
+        const uint digit = uint(s.data[s.pos + i]) - '0';
+        if (digit > 9)
+            return false;
+        result = result * 10 + int(digit);
+    }
+    s.pos += count;
+    *value = result;
+    return true;
+}
+
+template<typename Char>
+bool equals(const Char *data, int length, const char *text)
+{
+    int i = 0;
+    for (; i < length && text[i]; ++i) {
+        if (uint(data[i]) != uint(uchar(text[i])))
+            return false;
+    }
+    return i == length && !text[i];
+}
+
+// [+-]?[0-9]+
+template<typename Char>
+bool scanInteger(const Char *data, int length, bool *negative, bool *zero)
+{
+    Scanner<Char> s(data, length);
+    *negative = s.accept('-');
+    if (!*negative)
+        s.accept('+');
+    const int start = s.pos;
+    if (skip<DigitClass>(s) == 0 || !s.atEnd())
+        return false;
+    *zero = true;
+    for (int i = start; i < length; ++i) {
+        if (data[i] != '0') {
+            *zero = false;
+            break;
+        }
+    }
+    return true;
+}
+
+#ifdef __SSE2__
+// Value of eight digit values in 16-bit lanes, most significant first
+inline quint32 eightDigits(__m128i digits)
+{
+    const __m128i pairs = _mm_madd_epi16(digits, _mm_setr_epi16(10, 1, 10, 1, 10, 1, 10, 1));
+    const __m128i packed = _mm_packs_epi32(pairs, pairs);
+    const __m128i quads = _mm_madd_epi16(packed, _mm_setr_epi16(100, 1, 100, 1, 0, 0, 0, 0));
+    return quint32(_mm_cvtsi128_si32(quads)) * 10000
+            + quint32(_mm_cvtsi128_si32(_mm_srli_si128(quads, 4)));
+}
+
+inline quint32 eightDigits(const uchar *data)
+{
+    const __m128i bytes = _mm_loadl_epi64(reinterpret_cast<const __m128i *>(data));
+    const __m128i digits = _mm_sub_epi8(bytes, _mm_set1_epi8('0'));
+    return eightDigits(_mm_unpacklo_epi8(digits, _mm_setzero_si128()));
+}
+
+inline quint32 eightDigits(const ushort *data)
+{
+    const __m128i units = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data));
+    return eightDigits(_mm_sub_epi16(units, _mm_set1_epi16('0')));
+}
+#endif
+
+// Value of digits which have been checked already, false on overflow
+template<typename Char>
+bool digitsValue(const Char *data, int length, quint64 *result)
+{
+    const quint64 maximum = std::numeric_limits<quint64>::max();
+    quint64 value = 0;
+    int i = 0;
+    while (i < length && data[i] == '0')
+        ++i;
+    if (length - i > 20)
+        return false;
+#ifdef __SSE2__
+    for (; i + 8 <= length; i += 8) {
+        const quint32 chunk = eightDigits(data + i);
+        if (value > (maximum - chunk) / 100000000)
+            return false;
+        value = value * 100000000 + chunk;
+    }
+#endif
+    for (; i < length; ++i) {
+        const uint digit = uint(data[i]) - '0';
+        if (value > (maximum - digit) / 10)
+            return false;
+        value = value * 10 + digit;
+    }
+    *result = value;
+    return true;
+}
+
+template<typename Char>
+bool parseSigned(const Char *data, int length, qint64 *result)
+{
+    bool negative = false;
+    bool zero = false;
+    if (!scanInteger(data, length, &negative, &zero))
+        return false;
+    const int sign = data[0] == '-' || data[0] == '+' ? 1 : 0;
+    quint64 magnitude = 0;
+    if (!digitsValue(data + sign, length - sign, &magnitude))
+        return false;
+    const quint64 maximum = quint64(std::numeric_limits<qint64>::max());
+    if (magnitude > (negative ? maximum + 1 : maximum))
+        return false;
+    if (magnitude == 0)
+        *result = 0;
+    else
+        *result = negative ? -qint64(magnitude - 1) - 1 : qint64(magnitude);
+    return true;
+}
+
+template<typename Char>
+bool parseUnsigned(const Char *data, int length, quint64 *result)
+{
+    bool negative = false;
+    bool zero = false;
+    if (!scanInteger(data, length, &negative, &zero))
+        return false;
+    if (negative) {
+        *result = 0;
+        return zero;
+    }
+    const int sign = data[0] == '+' ? 1 : 0;
+    return digitsValue(data + sign, length - sign, result);
+}
+
+template<typename Char>
+bool isValidInteger(BuiltinTypes::Type type, const Char *data, int length)
+{
+    qint64 value = 0;
+    quint64 unsignedValue = 0;
+    switch (type) {
+    case BuiltinTypes::Long:
+        return parseSigned(data, length, &value);
+    case BuiltinTypes::Int:
+        return parseSigned(data, length, &value) && value >= -2147483647 - 1
+                && value <= 2147483647;
+    case BuiltinTypes::Short:
+        return parseSigned(data, length, &value) && value >= -32768 && value <= 32767;
+    case BuiltinTypes::Byte:
+        return parseSigned(data, length, &value) && value >= -128 && value <= 127;
+    case BuiltinTypes::UnsignedLong:
+        return parseUnsigned(data, length, &unsignedValue);
+    case BuiltinTypes::UnsignedInt:
+        return parseUnsigned(data, length, &unsignedValue) && unsignedValue <= 4294967295u;
+    case BuiltinTypes::UnsignedShort:
+        return parseUnsigned(data, length, &unsignedValue) && unsignedValue <= 65535;
+    case BuiltinTypes::UnsignedByte:
+        return parseUnsigned(data, length, &unsignedValue) && unsignedValue <= 255;
+    default:
+        break;
+    }
+
+    bool negative = false;
+    bool zero = false;
+    if (!scanInteger(data, length, &negative, &zero))
+        return false;
+    switch (type) {
+    case BuiltinTypes::NonPositiveInteger:
+        return negative || zero;
+    case BuiltinTypes::NegativeInteger:
+        return negative && !zero;
+    case BuiltinTypes::NonNegativeInteger:
+        return !negative || zero;
+    case BuiltinTypes::PositiveInteger:
+        return !negative && !zero;
+    default:
+        return true;
+    }
+}
+
+template<typename Char>
+bool parseBoolean(const Char *data, int length, bool *result)
+{
+    if (equals(data, length, "true") || equals(data, length, "1")) {
+        *result = true;
+        return true;
+    }
+    if (equals(data, length, "false") || equals(data, length, "0")) {
+        *result = false;
+        return true;
+    }
+    return false;
+}
+
+// [+-]?([0-9]+(\.[0-9]*)?|\.[0-9]+)
+template<typename Char>
+bool scanDecimal(Scanner<Char> &s)
+{
+    if (!s.accept('-'))
+        s.accept('+');
+    int digits = skip<DigitClass>(s);
+    if (s.accept('.'))
+        digits += skip<DigitClass>(s);
+    return digits > 0;
+}
+
+template<typename Char>
+bool isDouble(const Char *data, int length)
+{
+    if (equals(data, length, "INF") || equals(data, length, "-INF")
+        || equals(data, length, "+INF") || equals(data, length, "NaN")) {
+        return true;
+    }
+    Scanner<Char> s(data, length);
+    if (!scanDecimal(s))
+        return false;
+    if (s.accept('e') || s.accept('E')) {
+        if (!s.accept('-'))
+            s.accept('+');
+        if (skip<DigitClass>(s) == 0)
+            return false;
+    }
+    return s.atEnd();
+}
+
+int daysInMonth(int month, bool leap)
+{
+    static const int days[] = { 31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31 };
+    return month == 2 && leap ? 29 : days[month - 1];
+}
+
+// -?YYYY-MM-DD, with more year digits if needed
+template<typename Char>
+bool scanDate(Scanner<Char> &s)
+{
+    s.accept('-');
+    const int start = s.pos;
+    const int yearDigits = skip<DigitClass>(s);
+    if (yearDigits < 4 || (yearDigits > 4 && s.data[start] == '0'))
+        return false;
+    int yearMod400 = 0;
+    for (int i = start; i < s.pos; ++i)
+        yearMod400 = (yearMod400 * 10 + int(s.data[i] - '0')) % 400;
+    const bool leap = yearMod400 % 4 == 0 && (yearMod400 % 100 != 0 || yearMod400 == 0);
+
+    int month = 0;
+    int day = 0;
+    if (!s.accept('-') || !number(s, 2, &month) || !s.accept('-') || !number(s, 2, &day))
+        return false;
+    return month >= 1 && month <= 12 && day >= 1 && day <= daysInMonth(month, leap);
+}
+
+// hh:mm:ss(.s+)?
+template<typename Char>
+bool scanTime(Scanner<Char> &s)
+{
+    int hour = 0;
+    int minute = 0;
+    int second = 0;
+    if (!number(s, 2, &hour) || !s.accept(':') || !number(s, 2, &minute) || !s.accept(':')
+        || !number(s, 2, &second)) {
+        return false;
+    }
+    bool zeroFraction = true;
+    if (s.accept('.')) {
+        const int start = s.pos;
+        if (skip<DigitClass>(s) == 0)
+            return false;
+        for (int i = start; i < s.pos; ++i) {
+            if (s.data[i] != '0')
+                zeroFraction = false;
+        }
+    }
+    if (hour == 24)
+        return minute == 0 && second == 0 && zeroFraction;
+    return hour < 24 && minute < 60 && second < 60;
+}
+
+// (Z|[+-]hh:mm)?
+template<typename Char>
+bool scanTimeZone(Scanner<Char> &s)
+{
+    if (s.atEnd() || s.accept('Z'))
+        return true;
+    if (!s.accept('+') && !s.accept('-'))
+        return false;
+    int hours = 0;
+    int minutes = 0;
+    if (!number(s, 2, &hours) || !s.accept(':') || !number(s, 2, &minutes))
+        return false;
+    return minutes < 60 && (hours < 14 || (hours == 14 && minutes == 0));
+}
+
+// -?P(nY)?(nM)?(nD)?(T(nH)?(nM)?(n(.n)?S)?)?
+template<typename Char>
+bool scanDuration(Scanner<Char> &s)
+{
+    s.accept('-');
+    if (!s.accept('P'))
+        return false;
+
+    const char *designators = "YMD";
+    int next = 0;
+    bool components = false;
+    bool time = false;
+    bool timeComponents = false;
+    while (!s.atEnd()) {
+        if (s.accept('T')) {
+            if (time)
+                return false;
+            time = true;
+            designators = "HMS";
+            next = 0;
+            continue;
+        }
+        if (skip<DigitClass>(s) == 0)
+            return false;
+        bool fraction = false;
+        if (s.accept('.')) {
+            if (skip<DigitClass>(s) == 0)
+                return false;
+            fraction = true;
+        }
+        int index = next;
+        while (index < 3 && !s.accept(designators[index]))
+            ++index;
+        if (index == 3 || (fraction && !(time && index == 2)))
+            return false;
+        next = index + 1;
+        components = true;
+        timeComponents = time;
+    }
+    return components && (!time || timeComponents);
+}
+
+// Whitespace separated groups of four characters, padded with '='
+template<typename Char>
+bool isBase64(const Char *data, int length)
+{
+    Scanner<Char> s(data, length);
+    int count = 0;
+    int padding = 0;
+    while (!s.atEnd()) {
+        if (padding == 0) {
+            count += skip<Base64Class>(s);
+            if (s.atEnd())
+                break;
+        }
+        const uint c = s.peek();
+        if (c == '=') {
+            if (++padding > 2)
+                return false;
+            ++count;
+        } else if (c != ' ') {
+            return false;
+        }
+        ++s.pos;
+    }
+    return count % 4 == 0;
+}
+
+// UTF-8 sequences are not decoded, all non-ASCII bytes are accepted
+inline bool isNonAsciiNameChar(uchar, bool)
+{
+    return true;
+}
+
+inline bool isNonAsciiNameChar(ushort c, bool start)
+{
+    const QChar ch(c);
+    if (ch.isSurrogate() || ch.isLetter())
+        return true;
+    return !start && (ch.isNumber() || ch.isMark() || c == 0xb7);
+}
+
+// Scans a name, with colons if @p colons, starting with a name start character
+// if @p nameStart. Returns its length.
+template<typename Char>
+int scanName(Scanner<Char> &s, bool colons, bool nameStart)
+{
+    const int begin = s.pos;
+    if (nameStart) {
+        const uint c = s.peek();
+        const bool start = (c | 0x20) - 'a' <= 25 || c == '_' || (colons && c == ':')
+                || (c >= 0x80 && isNonAsciiNameChar(s.data[s.pos], true));
+        if (!start)
+            return 0;
+        ++s.pos;
+    }
+    while (!s.atEnd()) {
+        skip<NameClass>(s);
+        const uint c = s.peek();
+        if ((colons && c == ':') || (c >= 0x80 && isNonAsciiNameChar(s.data[s.pos], false)))
+            ++s.pos;
+        else
+            break;
+    }
+    return s.pos - begin;
+}
+
+template<typename Char>
+bool isToken(const Char *data, int length)
+{
+    Scanner<Char> s(data, length);
+    while (!s.atEnd()) {
+        if (skip<NonSpaceClass>(s) == 0)
+            return false;
+        if (s.atEnd())
+            break;
+        if (!s.accept(' ') || s.atEnd())
+            return false;
+    }
+    return true;
+}
+
+// [a-zA-Z]{1,8}(-[a-zA-Z0-9]{1,8})*
+template<typename Char>
+bool isLanguage(const Char *data, int length)
+{
+    int partLength = 0;
+    bool first = true;
+    for (int i = 0; i < length; ++i) {
+        const uint c = data[i];
+        if (c == '-') {
+            if (partLength == 0)
+                return false;
+            partLength = 0;
+            first = false;
+            continue;
+        }
+        const bool letter = (c | 0x20) - 'a' <= 25;
+        if (!(letter || (!first && c - '0' <= 9)) || ++partLength > 8)
+            return false;
+    }
+    return partLength > 0;
+}
+
+template<typename Char>
+bool validate(BuiltinTypes::Type type, const Char *data, int length)
+{
+    Scanner<Char> s(data, length);
+    bool boolean = false;
+    switch (type) {
+    case BuiltinTypes::Unknown:
+    case BuiltinTypes::String:
+        return true;
+    case BuiltinTypes::NormalizedString:
+        return classPrefix<NoLineBreakClass>(data, length) == length;
+    case BuiltinTypes::Token:
+        return isToken(data, length);
+    case BuiltinTypes::Language:
+        return isLanguage(data, length);
+    case BuiltinTypes::NMToken:
+        return scanName(s, true, false) > 0 && s.atEnd();
+    case BuiltinTypes::Name:
+        return scanName(s, true, true) > 0 && s.atEnd();
+    case BuiltinTypes::NCName:
+        return scanName(s, false, true) > 0 && s.atEnd();
+    case BuiltinTypes::QualifiedName:
+        return scanName(s, false, true) > 0 && (!s.accept(':') || scanName(s, false, true) > 0)
+                && s.atEnd();
+    case BuiltinTypes::AnyURI:
+        return classPrefix<PrintableClass>(data, length) == length;
+    case BuiltinTypes::Boolean:
+        return parseBoolean(data, length, &boolean);
+    case BuiltinTypes::Decimal:
+        return scanDecimal(s) && s.atEnd();
+    case BuiltinTypes::Float:
+    case BuiltinTypes::Double:
+        return isDouble(data, length);
+    case BuiltinTypes::Integer:
+    case BuiltinTypes::NonPositiveInteger:
+    case BuiltinTypes::NegativeInteger:
+    case BuiltinTypes::Long:
+    case BuiltinTypes::Int:
+    case BuiltinTypes::Short:
+    case BuiltinTypes::Byte:
+    case BuiltinTypes::NonNegativeInteger:
+    case BuiltinTypes::PositiveInteger:
+    case BuiltinTypes::UnsignedLong:
+    case BuiltinTypes::UnsignedInt:
+    case BuiltinTypes::UnsignedShort:
+    case BuiltinTypes::UnsignedByte:
+        return isValidInteger(type, data, length);
+    case BuiltinTypes::Duration:
+        return scanDuration(s);
+    case BuiltinTypes::DateTime:
+        return scanDate(s) && s.accept('T') && scanTime(s) && scanTimeZone(s) && s.atEnd();
+    case BuiltinTypes::Date:
+        return scanDate(s) && scanTimeZone(s) && s.atEnd();
+    case BuiltinTypes::Time:
+        return scanTime(s) && scanTimeZone(s) && s.atEnd();
+    case BuiltinTypes::HexBinary:
+        return length % 2 == 0 && classPrefix<HexClass>(data, length) == length;
+    case BuiltinTypes::Base64Binary:
+        return isBase64(data, length);
+    }
+    return true;
+}
+
+inline uint hexValue(uint c)
+{
+    return c - '0' <= 9 ? c - '0' : (c | 0x20) - 'a' + 10;
+}
+
+template<typename Char>
+bool decodeHex(const Char *data, int length, QByteArray *result)
+{
+    if (length % 2 != 0 || classPrefix<HexClass>(data, length) != length)
+        return false;
+    QByteArray bytes(length / 2, Qt::Uninitialized);
+    for (int i = 0; i < bytes.size(); ++i)
+        bytes[i] = char(hexValue(data[2 * i]) << 4 | hexValue(data[2 * i + 1]));
+    *result = bytes;
+    return true;
+}
+
+inline const uchar *utf8Data(const QByteArray &utf8)
+{
+    return reinterpret_cast<const uchar *>(utf8.constData());
+}
+
+inline const ushort *utf16Data(const QString &value)
+{
+    return reinterpret_cast<const ushort *>(value.constData());
+}
+
+}
+
+BuiltinTypes::Type BuiltinTypes::type(const QString &name)
+{
+    for (int i = String; i <= Base64Binary; ++i) {
+        if (name == QLatin1String(typeNames[i]))
+            return Type(i);
+    }
+    return Unknown;
+}
+
+QString BuiltinTypes::name(Type type)
+{
+    return type == Unknown ? QString() : QString::fromLatin1(typeNames[type]);
+}
+
+bool BuiltinTypes::isValid(Type type, const QString &value)
+{
+    return validate(type, utf16Data(value), value.length());
+}
+
+bool BuiltinTypes::isValid(Type type, const QByteArray &utf8)
+{
+    return validate(type, utf8Data(utf8), utf8.size());
+}
+
+bool BuiltinTypes::toBoolean(const QString &value, bool *result)
+{
+    return parseBoolean(utf16Data(value), value.length(), result);
+}
+
+bool BuiltinTypes::toBoolean(const QByteArray &utf8, bool *result)
+{
+    return parseBoolean(utf8Data(utf8), utf8.size(), result);
+}
+
+bool BuiltinTypes::toLongLong(const QString &value, qint64 *result)
+{
+    return parseSigned(utf16Data(value), value.length(), result);
+}
+
+bool BuiltinTypes::toLongLong(const QByteArray &utf8, qint64 *result)
+{
+    return parseSigned(utf8Data(utf8), utf8.size(), result);
+}
+
+bool BuiltinTypes::toULongLong(const QString &value, quint64 *result)
+{
+    return parseUnsigned(utf16Data(value), value.length(), result);
+}
+
+bool BuiltinTypes::toULongLong(const QByteArray &utf8, quint64 *result)
+{
+    return parseUnsigned(utf8Data(utf8), utf8.size(), result);
+}
+
+bool BuiltinTypes::toDouble(const QString &value, double *result)
+{
+    if (!isDouble(utf16Data(value), value.length()))
+        return false;
+    if (value == QLatin1String("INF") || value == QLatin1String("+INF")) {
+        *result = qInf();
+    } else if (value == QLatin1String("-INF")) {
+        *result = -qInf();
+    } else if (value == QLatin1String("NaN")) {
+        *result = qQNaN();
+    } else {
+        bool ok = false;
+        *result = value.toDouble(&ok);
+        return ok;
+    }
+    return true;
+}
+
+bool BuiltinTypes::toDouble(const QByteArray &utf8, double *result)
+{
+    // The lexical space is ASCII only
+    if (!isDouble(utf8Data(utf8), utf8.size()))
+        return false;
+    return toDouble(QString::fromLatin1(utf8), result);
+}
+
+bool BuiltinTypes::fromHexBinary(const QString &value, QByteArray *result)
+{
+    return decodeHex(utf16Data(value), value.length(), result);
+}
+
+bool BuiltinTypes::fromHexBinary(const QByteArray &utf8, QByteArray *result)
+{
+    return decodeHex(utf8Data(utf8), utf8.size(), result);
+}
+
+bool BuiltinTypes::fromBase64Binary(const QString &value, QByteArray *result)
+{
+    if (!isBase64(utf16Data(value), value.length()))
+        return false;
+    // fromBase64() skips the spaces
+    *result = QByteArray::fromBase64(value.toLatin1());
+    return true;
+}
+
+bool BuiltinTypes::fromBase64Binary(const QByteArray &utf8, QByteArray *result)
+{
+    if (!isBase64(utf8Data(utf8), utf8.size()))
+        return false;
+    *result = QByteArray::fromBase64(utf8);
+    return true;
+}
+
+}
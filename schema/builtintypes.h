@@ -0,0 +1,99 @@
+/*
+    This file is part of KDE Schema Parser
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Library General Public
+    License as published by the Free Software Foundation; either
+    version 2 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Library General Public License for more details.
+
+    You should have received a copy of the GNU Library General Public License
+    along with this library; see the file COPYING.LIB.  If not, write to
+    the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+    Boston, MA 02110-1301, USA.
+ */
+
+#ifndef SCHEMA_BUILTINTYPES_H
+#define SCHEMA_BUILTINTYPES_H
+
+#include <QByteArray>
+#include <QString>
+#include <kode_export.h>
+
+namespace XSD {
+
+// Lexical checks and conversions for the built-in XML schema types, on
+// UTF-16 and UTF-8 input. The values are expected with their whitespace
+// already collapsed. Character classes are scanned 16 bytes at a time with
+// SSE2 where available, with a scalar fallback elsewhere.
+class SCHEMA_EXPORT BuiltinTypes
+{
+public:
+    enum Type {
+        Unknown,
+        String,
+        NormalizedString,
+        Token,
+        Language,
+        NMToken,
+        Name,
+        NCName,
+        QualifiedName,
+        AnyURI,
+        Boolean,
+        Decimal,
+        Float,
+        Double,
+        Integer,
+        NonPositiveInteger,
+        NegativeInteger,
+        Long,
+        Int,
+        Short,
+        Byte,
+        NonNegativeInteger,
+        PositiveInteger,
+        UnsignedLong,
+        UnsignedInt,
+        UnsignedShort,
+        UnsignedByte,
+        Duration,
+        DateTime,
+        Date,
+        Time,
+        HexBinary,
+        Base64Binary
+    };
+
+    // Returns the type for the local name of a type in the XML schema namespace,
+    // or Unknown
+    static Type type(const QString &name);
+    static QString name(Type type);
+
+    // Returns whether @p value is in the lexical space of @p type and, for the
+    // bounded integer types, in their value space. Unknown types accept anything.
+    static bool isValid(Type type, const QString &value);
+    static bool isValid(Type type, const QByteArray &utf8);
+
+    // The conversions return false if the value is not valid or does not fit
+    static bool toBoolean(const QString &value, bool *result);
+    static bool toBoolean(const QByteArray &utf8, bool *result);
+    static bool toLongLong(const QString &value, qint64 *result);
+    static bool toLongLong(const QByteArray &utf8, qint64 *result);
+    static bool toULongLong(const QString &value, quint64 *result);
+    static bool toULongLong(const QByteArray &utf8, quint64 *result);
+    static bool toDouble(const QString &value, double *result);
+    static bool toDouble(const QByteArray &utf8, double *result);
+    static bool fromHexBinary(const QString &value, QByteArray *result);
+    static bool fromHexBinary(const QByteArray &utf8, QByteArray *result);
+    static bool fromBase64Binary(const QString &value, QByteArray *result);
+    static bool fromBase64Binary(const QByteArray &utf8, QByteArray *result);
+};
+
+}
+
+#endif
@@ -21,11 +21,12 @@
  */
 
 #include "complextype.h"
+#include "arena.h"
 #include <QDebug>
 
 namespace XSD {
 
-class ComplexType::Private
+class ComplexType::Private : public ArenaAllocated
 {
 public:
     Private() : mAnonymous(false), mConflicting(false), mBaseDerivation(Restriction) {}
@@ -45,6 +46,11 @@ public:
     QName mArrayType;
     QList<QName> mDerivedTypes;
 
+    mutable uint mStructuralHash = 0;
+    mutable bool mStructuralHashValid = false;
+
+    uint contentHash() const;
+
     bool operator==(const ComplexType::Private &other) const
     {
         return mElements == other.mElements && mAttributes == other.mAttributes
@@ -55,6 +61,52 @@ public:
     inline bool operator!=(const ComplexType::Private &other) const { return !(*this == other); }
 };
 
+static inline uint hashCombine(uint seed, uint value)
+{
+    return seed ^ (value + 0x9e3779b9 + (seed << 6) + (seed >> 2));
+}
+
+static uint attributeHash(const Attribute &attribute)
+{
+    uint hash = qHash(attribute.qualifiedName());
+    hash = hashCombine(hash, qHash(attribute.type()));
+    hash = hashCombine(hash, qHash(attribute.defaultValue()));
+    hash = hashCombine(hash, qHash(attribute.fixedValue()));
+    hash = hashCombine(hash, uint(attribute.isQualified()));
+    hash = hashCombine(hash, uint(attribute.attributeUse()));
+    hash = hashCombine(hash, qHash(attribute.reference()));
+    return hash;
+}
+
+uint ComplexType::Private::contentHash() const
+{
+    if (mStructuralHashValid)
+        return mStructuralHash;
+
+    uint hash = mElements.structuralHash();
+    for (const Attribute &attribute : mAttributes)
+        hash = hashCombine(hash, attributeHash(attribute));
+    for (const Group &group : mGroups) {
+        hash = hashCombine(hash, qHash(group.qualifiedName()));
+        hash = hashCombine(hash, qHash(group.reference()));
+        hash = hashCombine(hash, group.elements().structuralHash());
+    }
+    for (const AttributeGroup &group : mAttributeGroups) {
+        hash = hashCombine(hash, qHash(group.qualifiedName()));
+        hash = hashCombine(hash, qHash(group.reference()));
+        const Attribute::List attributes = group.attributes();
+        for (const Attribute &attribute : attributes)
+            hash = hashCombine(hash, attributeHash(attribute));
+    }
+    hash = hashCombine(hash, uint(mBaseDerivation));
+    hash = hashCombine(hash, qHash(mBaseTypeName));
+    hash = hashCombine(hash, qHash(mArrayType));
+
+    mStructuralHash = hash;
+    mStructuralHashValid = true;
+    return hash;
+}
+
 ComplexType::ComplexType(const QString &nameSpace) : XSDType(nameSpace), d(new Private) {}
 
 ComplexType::ComplexType() : XSDType(), d(new Private) {}
@@ -95,6 +147,7 @@ QString ComplexType::documentation() const
 void ComplexType::setBaseTypeName(const QName &baseTypeName)
 {
     d->mBaseTypeName = baseTypeName;
+    d->mStructuralHashValid = false;
 }
 
 QName ComplexType::baseTypeName() const
@@ -115,6 +168,7 @@ QList<QName> ComplexType::derivedTypes() const
 void ComplexType::setBaseDerivation(Derivation derivation)
 {
     d->mBaseDerivation = derivation;
+    d->mStructuralHashValid = false;
 }
 
 ComplexType::Derivation ComplexType::baseDerivation() const
@@ -135,6 +189,7 @@ bool ComplexType::isPolymorphicBaseClass() const
 void ComplexType::setArrayType(const QName &arrayType)
 {
     d->mArrayType = arrayType;
+    d->mStructuralHashValid = false;
 }
 
 QName ComplexType::arrayType() const
@@ -170,6 +225,7 @@ bool ComplexType::isConflicting() const
 void ComplexType::setElements(const Element::List &elements)
 {
     d->mElements = elements;
+    d->mStructuralHashValid = false;
 }
 
 Element::List ComplexType::elements() const
@@ -180,11 +236,13 @@ Element::List ComplexType::elements() const
 void ComplexType::setGroups(const Group::List &groups)
 {
     d->mGroups = groups;
+    d->mStructuralHashValid = false;
 }
 
 void ComplexType::addGroup(const Group &group)
 {
     d->mGroups.append(group);
+    d->mStructuralHashValid = false;
 }
 
 Group::List ComplexType::groups() const
@@ -195,6 +253,7 @@ Group::List ComplexType::groups() const
 void ComplexType::setAttributes(const Attribute::List &attributes)
 {
     d->mAttributes = attributes;
+    d->mStructuralHashValid = false;
 }
 
 Attribute::List ComplexType::attributes() const
@@ -205,11 +264,13 @@ Attribute::List ComplexType::attributes() const
 void ComplexType::addAttributeGroups(const AttributeGroup &attributeGroups)
 {
     d->mAttributeGroups.append(attributeGroups);
+    d->mStructuralHashValid = false;
 }
 
 void ComplexType::setAttributeGroups(const AttributeGroup::List &attributeGroups)
 {
     d->mAttributeGroups = attributeGroups;
+    d->mStructuralHashValid = false;
 }
 
 AttributeGroup::List ComplexType::attributeGroups() const
@@ -220,6 +281,7 @@ AttributeGroup::List ComplexType::attributeGroups() const
 void ComplexType::addAttribute(const Attribute &attribute)
 {
     d->mAttributes.append(attribute);
+    d->mStructuralHashValid = false;
 }
 
 Attribute ComplexType::attribute(const QName &attrName) const
@@ -235,6 +297,7 @@ Attribute ComplexType::attribute(const QName &attrName) const
 void ComplexType::addElement(const Element &element)
 {
     d->mElements.append(element);
+    d->mStructuralHashValid = false;
 }
 
 bool ComplexType::isEmpty() const
@@ -248,6 +311,16 @@ bool ComplexType::operator==(const ComplexType &other) const
     return XSDType::operator==(other) && *d == *other.d;
 }
 
+uint ComplexType::structuralHash() const
+{
+    // The name is deliberately left out
+    uint hash = d->contentHash();
+    hash = hashCombine(hash, qHash(nameSpace()));
+    hash = hashCombine(hash, uint(contentModel()));
+    hash = hashCombine(hash, qHash(substitutionElementName()));
+    return hash;
+}
+
 ComplexType ComplexTypeList::complexType(const QName &qualifiedName) const
 {
     // qDebug() << "looking for" << typeName << "ns=" << typeName.nameSpace();
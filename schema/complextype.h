@@ -103,6 +103,13 @@ public:
     bool operator==(const ComplexType &other) const;
     inline bool operator!=(const ComplexType &other) const { return !(*this == other); }
 
+    /**
+     * Returns a hash over everything operator==() compares except the name,
+     * so that structurally identical types with different names have the
+     * same hash. The hash of the content is cached.
+     */
+    uint structuralHash() const;
+
 private:
     class Private;
     std::unique_ptr<Private> d;
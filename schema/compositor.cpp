@@ -22,10 +22,11 @@
 #include <QMetaEnum>
 
 #include "compositor.h"
+#include "arena.h"
 
 namespace XSD {
 
-class Compositor::Private
+class Compositor::Private : public ArenaAllocated
 {
 public:
     Private() : mType(Invalid), mMinOccurs(1), mMaxOccurs(1) {}
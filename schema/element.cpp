@@ -21,11 +21,12 @@
  */
 
 #include "element.h"
+#include "arena.h"
 #include <QDebug>
 
 namespace XSD {
 
-class Element::Private
+class Element::Private : public ArenaAllocated
 {
 public:
     Private()
@@ -263,6 +264,46 @@ void ElementList::dump()
     }
 }
 
+static inline uint hashCombine(uint seed, uint value)
+{
+    return seed ^ (value + 0x9e3779b9 + (seed << 6) + (seed >> 2));
+}
+
+static uint elementHash(const Element &element)
+{
+    uint hash = qHash(element.qualifiedName());
+    hash = hashCombine(hash, qHash(element.type()));
+    hash = hashCombine(hash, uint(element.groupId()));
+    hash = hashCombine(hash, uint(element.minOccurs()));
+    hash = hashCombine(hash, uint(element.maxOccurs()));
+    hash = hashCombine(hash, uint(element.isQualified()));
+    hash = hashCombine(hash, uint(element.nillable()));
+    hash = hashCombine(hash, uint(element.hasSubstitutions()));
+    hash = hashCombine(hash, qHash(element.defaultValue()));
+    hash = hashCombine(hash, qHash(element.fixedValue()));
+    hash = hashCombine(hash, uint(element.occurrence()));
+    hash = hashCombine(hash, qHash(element.reference()));
+    hash = hashCombine(hash, uint(element.compositor().type()));
+    return hash;
+}
+
+uint ElementList::structuralHash() const
+{
+    uint hash = uint(count());
+
+    // operator== only compares the position of elements of sequences, and as the
+    // compositor type is part of the element comparison, two equal lists either both
+    // consist of sequence elements only or both not. Hash the elements in order in the
+    // first case, and only the count in the second.
+    for (const Element &e : *this) {
+        if (e.compositor().type() != Compositor::Sequence)
+            return hashCombine(hash, 1);
+    }
+    for (const Element &e : *this)
+        hash = hashCombine(hash, elementHash(e));
+    return hash;
+}
+
 bool ElementList::operator==(const ElementList &other) const
 {
     if (count() != other.count())
@@ -122,6 +122,9 @@ public:
 
     bool operator==(const ElementList &other) const;
     inline bool operator!=(const ElementList &other) const { return !(*this == other); }
+
+    // Hash consistent with operator==, i.e. equal lists have equal hashes
+    uint structuralHash() const;
 };
 
 }
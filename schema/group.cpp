@@ -19,10 +19,11 @@
 */
 
 #include "group.h"
+#include "arena.h"
 
 namespace XSD {
 
-class Group::Private
+class Group::Private : public ArenaAllocated
 {
 public:
     QName mReference;
@@ -0,0 +1,679 @@
+/*
+    This file is part of KDE Schema Parser
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Library General Public
+    License as published by the Free Software Foundation; either
+    version 2 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Library General Public License for more details.
+
+    You should have received a copy of the GNU Library General Public License
+    along with this library; see the file COPYING.LIB.  If not, write to
+    the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+    Boston, MA 02110-1301, USA.
+ */
+
+#include "instancevalidator.h"
+#include "compositor.h"
+#include "parser.h"
+#include "simpletypevalidator.h"
+
+#include <QHash>
+#include <QIODevice>
+#include <QPair>
+#include <QVector>
+#include <QXmlStreamReader>
+
+namespace XSD {
+
+static const QString xmlSchemaUri = QStringLiteral("http://www.w3.org/2001/XMLSchema");
+static const QString xmlSchemaInstanceUri =
+        QStringLiteral("http://www.w3.org/2001/XMLSchema-instance");
+
+// Bounds the walk up the base types, in case of cyclic derivations
+static const int maximumDerivationDepth = 32;
+
+namespace {
+
+// A child element allowed by a particle
+struct ChildDeclaration
+{
+    QString nameSpace;
+    bool qualified = false;
+    QName type;
+};
+
+// Matched by xs:any, the content of such elements is validated against a
+// global declaration if there is one and skipped otherwise
+static const ChildDeclaration anyDeclaration;
+
+// A step of a content model: an element, a choice of elements or a wildcard
+struct Particle
+{
+    const ChildDeclaration *match(const QString &nameSpace, const QString &localName) const
+    {
+        // The declared elements of a choice take precedence over its wildcard
+        const auto it = elements.constFind(localName);
+        if (it == elements.constEnd()) {
+            return any ? &anyDeclaration : nullptr;
+        }
+        if (it->nameSpace != nameSpace) {
+            // Unqualified local elements are in no namespace
+            if (!nameSpace.isEmpty() || it->qualified) {
+                return any ? &anyDeclaration : nullptr;
+            }
+        }
+        return &it.value();
+    }
+
+    QString description() const
+    {
+        if (any && names.isEmpty()) {
+            return QStringLiteral("any element");
+        }
+        if (names.count() == 1 && !any) {
+            return QStringLiteral("element %1").arg(names.first());
+        }
+        QStringList alternatives = names;
+        if (any) {
+            alternatives.append(QStringLiteral("any element"));
+        }
+        return QStringLiteral("one of %1").arg(alternatives.join(QLatin1String(", ")));
+    }
+
+    QHash<QString, ChildDeclaration> elements; // by local name
+    QStringList names;
+    bool any = false;
+    int minOccurs = 1;
+    int maxOccurs = 1;
+};
+
+struct AttributeDeclaration
+{
+    QName type;
+    QString fixedValue;
+};
+
+struct ContentModel
+{
+    QVector<Particle> particles;
+    bool all = false; // the particles may occur in any order
+    bool textAllowed = false;
+    bool mixed = false;
+    const SimpleTypeValidator *textValidator = nullptr;
+
+    QHash<QString, AttributeDeclaration> attributes; // by local name
+    QStringList requiredAttributes;
+    bool anyAttribute = false;
+};
+
+// The state of an open element
+struct Frame
+{
+    QString name;
+    const ContentModel *model = nullptr; // null for simple types
+    const SimpleTypeValidator *textValidator = nullptr;
+    bool lax = false; // the content is not checked
+    int particle = 0;
+    int count = 0;
+    QVector<int> allCounts;
+    QString text;
+    int namespaceCount = 0;
+};
+
+}
+
+class InstanceValidator::Private
+{
+public:
+    explicit Private(const Types &types);
+
+    void reset();
+    bool stopped() const { return mErrors.count() >= mMaximumErrorCount; }
+    void addError(const QXmlStreamReader &reader, const QString &message);
+
+    void startElement(const QXmlStreamReader &reader);
+    void endElement(const QXmlStreamReader &reader);
+    void characters(const QXmlStreamReader &reader);
+
+    const ChildDeclaration *matchChild(Frame &frame, const QXmlStreamReader &reader,
+                                       const QString &nameSpace, const QString &localName);
+    void checkComplete(Frame &frame, const QXmlStreamReader &reader);
+    void validateAttributes(const QXmlStreamReader &reader, const Frame &frame);
+    QName resolveQName(const QString &value) const;
+
+    const ContentModel *contentModel(const QName &typeName);
+    std::shared_ptr<ContentModel> compile(const ComplexType &type);
+    void addDeclarations(Particle &particle, const Element &element);
+    const SimpleTypeValidator *simpleTypeValidator(const QName &typeName);
+
+    Types mTypes;
+    int mMaximumErrorCount = 100;
+    QList<Error> mErrors;
+
+    QHash<QName, QName> mGlobalElements; // element name to type name
+    Element::List mSubstitutes; // global elements which can substitute another one
+    QHash<QName, std::shared_ptr<ContentModel>> mModels; // null for non-complex types
+    QHash<QName, std::shared_ptr<SimpleTypeValidator>> mValidators;
+
+    QVector<Frame> mStack;
+    QVector<QPair<QString, QString>> mNamespaces; // prefix, uri of the open elements
+    int mSkipDepth = 0; // depth inside a subtree which is not validated
+};
+
+InstanceValidator::Private::Private(const Types &types) : mTypes(types)
+{
+    const Element::List elements = mTypes.elements();
+    for (const Element &element : elements) {
+        const QName name = element.qualifiedName();
+        mGlobalElements.insert(name, element.type());
+
+        // The parser notes the substituting element in its type
+        const ComplexType complexType = mTypes.complexType(element.type());
+        const QName substitution = complexType.isNull()
+                ? mTypes.simpleType(element.type()).substitutionElementName()
+                : complexType.substitutionElementName();
+        if (substitution == name) {
+            mSubstitutes.append(element);
+        }
+    }
+}
+
+void InstanceValidator::Private::reset()
+{
+    mErrors.clear();
+    mStack.clear();
+    mNamespaces.clear();
+    mSkipDepth = 0;
+}
+
+void InstanceValidator::Private::addError(const QXmlStreamReader &reader, const QString &message)
+{
+    Error error;
+    error.message = message;
+    error.lineNumber = reader.lineNumber();
+    error.columnNumber = reader.columnNumber();
+    mErrors.append(error);
+}
+
+void InstanceValidator::Private::startElement(const QXmlStreamReader &reader)
+{
+    if (mSkipDepth > 0) {
+        ++mSkipDepth;
+        return;
+    }
+
+    const QString nameSpace = reader.namespaceUri().toString();
+    const QString localName = reader.name().toString();
+
+    QName typeName;
+    if (mStack.isEmpty()) {
+        const auto it = mGlobalElements.constFind(QName(nameSpace, localName));
+        if (it == mGlobalElements.constEnd()) {
+            addError(reader, QStringLiteral("No declaration for element %1").arg(localName));
+            ++mSkipDepth;
+            return;
+        }
+        typeName = it.value();
+    } else {
+        Frame &parent = mStack.last();
+        if (parent.lax) {
+            ++mSkipDepth;
+            return;
+        }
+        if (!parent.model || (parent.model->textAllowed && !parent.model->mixed)) {
+            addError(reader,
+                     QStringLiteral("Element %1 is not allowed in %2").arg(localName, parent.name));
+            parent.lax = true;
+            ++mSkipDepth;
+            return;
+        }
+        const ChildDeclaration *declaration = matchChild(parent, reader, nameSpace, localName);
+        if (!declaration) {
+            parent.lax = true;
+            ++mSkipDepth;
+            return;
+        }
+        typeName = declaration->type;
+        if (declaration == &anyDeclaration) {
+            typeName = mGlobalElements.value(QName(nameSpace, localName));
+        }
+    }
+
+    Frame frame;
+    frame.name = localName;
+    const QXmlStreamNamespaceDeclarations declarations = reader.namespaceDeclarations();
+    frame.namespaceCount = declarations.count();
+    for (const QXmlStreamNamespaceDeclaration &declaration : declarations) {
+        mNamespaces.append(qMakePair(declaration.prefix().toString(),
+                                     declaration.namespaceUri().toString()));
+    }
+
+    const QXmlStreamAttributes attributes = reader.attributes();
+    const QString xsiType = QStringLiteral("type");
+    if (attributes.hasAttribute(xmlSchemaInstanceUri, xsiType)) {
+        const QName derivedName =
+                resolveQName(attributes.value(xmlSchemaInstanceUri, xsiType).toString());
+        if (derivedName != typeName && !mTypes.isDerivedFrom(derivedName, typeName)
+            && typeName != QName(xmlSchemaUri, QStringLiteral("anyType"))
+            && !mTypes.complexType(typeName).isNull()) {
+            addError(reader,
+                     QStringLiteral("Type %1 is not derived from %2")
+                             .arg(derivedName.qname(), typeName.qname()));
+        }
+        typeName = derivedName;
+    }
+
+    if (const ContentModel *model = contentModel(typeName)) {
+        frame.model = model;
+        frame.textValidator = model->textValidator;
+        if (model->all) {
+            frame.allCounts.fill(0, model->particles.count());
+        }
+    } else if (const SimpleTypeValidator *validator = simpleTypeValidator(typeName)) {
+        frame.textValidator = validator;
+    } else {
+        frame.lax = true;
+    }
+
+    if (!frame.lax) {
+        validateAttributes(reader, frame);
+    }
+    mStack.append(frame);
+}
+
+void InstanceValidator::Private::endElement(const QXmlStreamReader &reader)
+{
+    if (mSkipDepth > 0) {
+        --mSkipDepth;
+        return;
+    }
+    if (mStack.isEmpty()) {
+        return;
+    }
+
+    Frame &frame = mStack.last();
+    if (!frame.lax) {
+        if (frame.model) {
+            checkComplete(frame, reader);
+        }
+        QString message;
+        if (frame.textValidator && !frame.textValidator->validate(frame.text, &message)) {
+            addError(reader, QStringLiteral("Invalid value of %1: %2").arg(frame.name, message));
+        }
+    }
+
+    mNamespaces.resize(mNamespaces.count() - frame.namespaceCount);
+    mStack.removeLast();
+}
+
+void InstanceValidator::Private::characters(const QXmlStreamReader &reader)
+{
+    if (mSkipDepth > 0 || mStack.isEmpty()) {
+        return;
+    }
+
+    Frame &frame = mStack.last();
+    if (frame.lax) {
+        return;
+    }
+    if (!frame.model || frame.model->textAllowed) {
+        if (frame.textValidator) {
+            frame.text += reader.text();
+        }
+    } else if (!frame.model->mixed && !reader.isWhitespace()) {
+        addError(reader, QStringLiteral("Text is not allowed in %1").arg(frame.name));
+        frame.lax = true;
+    }
+}
+
+const ChildDeclaration *InstanceValidator::Private::matchChild(Frame &frame,
+                                                               const QXmlStreamReader &reader,
+                                                               const QString &nameSpace,
+                                                               const QString &localName)
+{
+    const QVector<Particle> &particles = frame.model->particles;
+
+    if (frame.model->all) {
+        for (int i = 0; i < particles.count(); ++i) {
+            if (const ChildDeclaration *declaration = particles.at(i).match(nameSpace, localName)) {
+                if (++frame.allCounts[i] > particles.at(i).maxOccurs) {
+                    addError(reader, QStringLiteral("Element %1 occurs too often").arg(localName));
+                    return nullptr;
+                }
+                return declaration;
+            }
+        }
+        addError(reader,
+                 QStringLiteral("Unexpected element %1 in %2").arg(localName, frame.name));
+        return nullptr;
+    }
+
+    while (frame.particle < particles.count()) {
+        const Particle &particle = particles.at(frame.particle);
+        if (frame.count < particle.maxOccurs) {
+            if (const ChildDeclaration *declaration = particle.match(nameSpace, localName)) {
+                ++frame.count;
+                return declaration;
+            }
+        }
+        if (frame.count < particle.minOccurs) {
+            addError(reader,
+                     QStringLiteral("Expected %1 instead of %2")
+                             .arg(particle.description(), localName));
+            return nullptr;
+        }
+        ++frame.particle;
+        frame.count = 0;
+    }
+
+    addError(reader, QStringLiteral("Unexpected element %1 in %2").arg(localName, frame.name));
+    return nullptr;
+}
+
+void InstanceValidator::Private::checkComplete(Frame &frame, const QXmlStreamReader &reader)
+{
+    const QVector<Particle> &particles = frame.model->particles;
+
+    if (frame.model->all) {
+        for (int i = 0; i < particles.count(); ++i) {
+            if (frame.allCounts.at(i) < particles.at(i).minOccurs) {
+                addError(reader,
+                         QStringLiteral("Missing %1 in %2")
+                                 .arg(particles.at(i).description(), frame.name));
+            }
+        }
+        return;
+    }
+
+    for (; frame.particle < particles.count(); ++frame.particle) {
+        const Particle &particle = particles.at(frame.particle);
+        if (frame.count < particle.minOccurs) {
+            addError(reader,
+                     QStringLiteral("Missing %1 in %2").arg(particle.description(), frame.name));
+            return;
+        }
+        frame.count = 0;
+    }
+}
+
+void InstanceValidator::Private::validateAttributes(const QXmlStreamReader &reader,
+                                                    const Frame &frame)
+{
+    const ContentModel *model = frame.model;
+    const QXmlStreamAttributes attributes = reader.attributes();
+
+    for (const QXmlStreamAttribute &attribute : attributes) {
+        const QString nameSpace = attribute.namespaceUri().toString();
+        if (nameSpace == xmlSchemaInstanceUri
+            || nameSpace == QLatin1String("http://www.w3.org/XML/1998/namespace")) {
+            continue;
+        }
+        const QString name = attribute.name().toString();
+        const auto it = model ? model->attributes.constFind(name)
+                              : QHash<QString, AttributeDeclaration>::const_iterator();
+        if (!model || it == model->attributes.constEnd()) {
+            if (!model || !model->anyAttribute) {
+                addError(reader,
+                         QStringLiteral("Attribute %1 is not allowed in %2").arg(name, frame.name));
+            }
+            continue;
+        }
+
+        const QString value = attribute.value().toString();
+        if (!it->fixedValue.isNull() && value != it->fixedValue) {
+            addError(reader,
+                     QStringLiteral("Attribute %1 must have the value %2")
+                             .arg(name, it->fixedValue));
+            continue;
+        }
+        QString message;
+        const SimpleTypeValidator *validator = simpleTypeValidator(it->type);
+        if (validator && !validator->validate(value, &message)) {
+            addError(reader,
+                     QStringLiteral("Invalid value of attribute %1: %2").arg(name, message));
+        }
+    }
+
+    if (model) {
+        for (const QString &name : model->requiredAttributes) {
+            if (!attributes.hasAttribute(name)) {
+                addError(reader,
+                         QStringLiteral("Missing attribute %1 in %2").arg(name, frame.name));
+            }
+        }
+    }
+}
+
+QName InstanceValidator::Private::resolveQName(const QString &value) const
+{
+    const int colon = value.indexOf(QLatin1Char(':'));
+    const QString prefix = colon < 0 ? QString() : value.left(colon);
+    const QString localName = value.mid(colon + 1).trimmed();
+
+    for (int i = mNamespaces.count() - 1; i >= 0; --i) {
+        if (mNamespaces.at(i).first == prefix) {
+            return QName(mNamespaces.at(i).second, localName);
+        }
+    }
+    return QName(QString(), localName);
+}
+
+const ContentModel *InstanceValidator::Private::contentModel(const QName &typeName)
+{
+    const auto it = mModels.constFind(typeName);
+    if (it != mModels.constEnd()) {
+        return it->get();
+    }
+
+    std::shared_ptr<ContentModel> model;
+    const ComplexType type = mTypes.complexType(typeName);
+    if (!type.isNull()) {
+        model = compile(type);
+    }
+    mModels.insert(typeName, model);
+    return model.get();
+}
+
+std::shared_ptr<ContentModel> InstanceValidator::Private::compile(const ComplexType &type)
+{
+    auto model = std::make_shared<ContentModel>();
+
+    // Extensions append their particles to the ones of the base type,
+    // restrictions repeat the content they keep
+    Element::List elements = type.elements();
+    ComplexType derived = type;
+    QName simpleBaseName;
+    for (int depth = 0; depth < maximumDerivationDepth; ++depth) {
+        const Attribute::List attributes = derived.attributes();
+        for (const Attribute &attribute : attributes) {
+            if (attribute.name() == QLatin1String("anyAttribute")
+                && attribute.type() == QName(xmlSchemaUri, QStringLiteral("anyType"))) {
+                model->anyAttribute = true;
+                continue;
+            }
+            if (model->attributes.contains(attribute.name())) {
+                continue;
+            }
+            AttributeDeclaration declaration;
+            declaration.type = attribute.type();
+            declaration.fixedValue = attribute.fixedValue();
+            model->attributes.insert(attribute.name(), declaration);
+            if (attribute.attributeUse() == Attribute::Required) {
+                model->requiredAttributes.append(attribute.name());
+            }
+        }
+
+        const ComplexType base = mTypes.complexType(derived.baseTypeName());
+        if (base.isNull()) {
+            simpleBaseName = derived.baseTypeName();
+            break;
+        }
+        if (derived.baseDerivation() == ComplexType::Extension) {
+            Element::List inherited = base.elements();
+            inherited += elements;
+            elements = inherited;
+        }
+        derived = base;
+    }
+
+    model->mixed = type.contentModel() == XSDType::MIXED;
+    model->textAllowed = model->mixed
+            || (type.contentModel() == XSDType::SIMPLE && elements.isEmpty());
+    if (model->textAllowed && !simpleBaseName.isEmpty()) {
+        model->textValidator = simpleTypeValidator(simpleBaseName);
+    }
+
+    model->all = !type.isArray() && !elements.isEmpty();
+    // The members of a choice follow each other. Each one carries the choice as it
+    // was parsed before the member, so its number of children is its position
+    int choiceMembers = 0;
+    for (const Element &element : std::as_const(elements)) {
+        const Compositor compositor = element.compositor();
+        if (compositor.type() != Compositor::Invalid) {
+            model->all = false;
+        }
+
+        // The elements of a choice are flattened with the choice's occurrences
+        const bool choice = compositor.type() == Compositor::Choice;
+        const int position = compositor.children().count();
+        if (!choice || position == 0 || position != choiceMembers) {
+            Particle particle;
+            particle.minOccurs = element.minOccurs();
+            particle.maxOccurs = element.maxOccurs();
+            if (type.isArray()) {
+                particle.minOccurs = 0;
+                particle.maxOccurs = Parser::UNBOUNDED;
+            }
+            model->particles.append(particle);
+        }
+        choiceMembers = choice ? position + 1 : 0;
+
+        if (element.type() == QName(xmlSchemaUri, QStringLiteral("any"))) {
+            model->particles.last().any = true;
+        } else {
+            addDeclarations(model->particles.last(), element);
+        }
+    }
+
+    return model;
+}
+
+void InstanceValidator::Private::addDeclarations(Particle &particle, const Element &element)
+{
+    ChildDeclaration declaration;
+    declaration.nameSpace = element.nameSpace();
+    declaration.qualified = element.isQualified();
+    declaration.type = element.type();
+    if (!particle.elements.contains(element.name())) {
+        particle.elements.insert(element.name(), declaration);
+        particle.names.append(element.name());
+    }
+
+    if (!element.hasSubstitutions()) {
+        return;
+    }
+    for (const Element &substitute : std::as_const(mSubstitutes)) {
+        if (substitute.qualifiedName() == element.qualifiedName()
+            || particle.elements.contains(substitute.name())) {
+            continue;
+        }
+        if (substitute.type() != element.type()
+            && !mTypes.isDerivedFrom(substitute.type(), element.type())) {
+            continue;
+        }
+        ChildDeclaration member;
+        member.nameSpace = substitute.nameSpace();
+        member.qualified = true;
+        member.type = substitute.type();
+        particle.elements.insert(substitute.name(), member);
+        particle.names.append(substitute.name());
+    }
+}
+
+const SimpleTypeValidator *InstanceValidator::Private::simpleTypeValidator(const QName &typeName)
+{
+    const auto it = mValidators.constFind(typeName);
+    if (it != mValidators.constEnd()) {
+        return it->get();
+    }
+
+    std::shared_ptr<SimpleTypeValidator> validator;
+    const SimpleType &type = mTypes.simpleType(typeName);
+    if (!type.isNull()) {
+        validator = std::make_shared<SimpleTypeValidator>(type, mTypes);
+    } else if (typeName.nameSpace() == xmlSchemaUri
+               && typeName.localName() != QLatin1String("anyType")
+               && typeName.localName() != QLatin1String("any")) {
+        // Built-in types are checked through a restriction without facets
+        SimpleType builtin(xmlSchemaUri);
+        builtin.setName(typeName.localName() + QLatin1String("_restriction"));
+        builtin.setBaseTypeName(typeName);
+        validator = std::make_shared<SimpleTypeValidator>(builtin);
+    }
+    mValidators.insert(typeName, validator);
+    return validator.get();
+}
+
+InstanceValidator::InstanceValidator(const Types &types) : d(new Private(types)) {}
+
+InstanceValidator::~InstanceValidator() = default;
+
+void InstanceValidator::setMaximumErrorCount(int count)
+{
+    d->mMaximumErrorCount = count;
+}
+
+int InstanceValidator::maximumErrorCount() const
+{
+    return d->mMaximumErrorCount;
+}
+
+bool InstanceValidator::validate(QIODevice *device)
+{
+    QXmlStreamReader reader(device);
+    return validate(reader);
+}
+
+bool InstanceValidator::validate(const QByteArray &data)
+{
+    QXmlStreamReader reader(data);
+    return validate(reader);
+}
+
+bool InstanceValidator::validate(QXmlStreamReader &reader)
+{
+    d->reset();
+
+    while (!reader.atEnd() && !d->stopped()) {
+        switch (reader.readNext()) {
+        case QXmlStreamReader::StartElement:
+            d->startElement(reader);
+            break;
+        case QXmlStreamReader::EndElement:
+            d->endElement(reader);
+            break;
+        case QXmlStreamReader::Characters:
+            d->characters(reader);
+            break;
+        default:
+            break;
+        }
+    }
+    if (reader.hasError() && !d->stopped()) {
+        d->addError(reader, reader.errorString());
+    }
+
+    return d->mErrors.isEmpty();
+}
+
+QList<InstanceValidator::Error> InstanceValidator::errors() const
+{
+    return d->mErrors;
+}
+
+}
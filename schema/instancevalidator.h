@@ -0,0 +1,72 @@
+/*
+    This file is part of KDE Schema Parser
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Library General Public
+    License as published by the Free Software Foundation; either
+    version 2 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Library General Public License for more details.
+
+    You should have received a copy of the GNU Library General Public License
+    along with this library; see the file COPYING.LIB.  If not, write to
+    the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+    Boston, MA 02110-1301, USA.
+ */
+
+#ifndef SCHEMA_INSTANCEVALIDATOR_H
+#define SCHEMA_INSTANCEVALIDATOR_H
+
+#include "types.h"
+#include <kode_export.h>
+
+#include <memory>
+
+class QIODevice;
+class QXmlStreamReader;
+
+namespace XSD {
+
+// Validates XML documents against resolved schema types while streaming them.
+// The content model of each complex type is compiled once, on first use, into
+// a list of particles which is matched greedily against the child elements,
+// so only a small state is kept per open element.
+// A validator must only be used by one thread at a time.
+class SCHEMA_EXPORT InstanceValidator
+{
+public:
+    struct Error
+    {
+        QString message;
+        qint64 lineNumber = 0;
+        qint64 columnNumber = 0;
+    };
+
+    explicit InstanceValidator(const Types &types);
+    ~InstanceValidator();
+
+    // Validation stops after this many errors, 100 by default
+    void setMaximumErrorCount(int count);
+    int maximumErrorCount() const;
+
+    // Validates the document read from @p device, returns true if it is valid
+    bool validate(QIODevice *device);
+    bool validate(const QByteArray &data);
+    // Reads @p reader up to the end of the document
+    bool validate(QXmlStreamReader &reader);
+
+    // The errors of the last validation, in document order
+    QList<Error> errors() const;
+
+private:
+    Q_DISABLE_COPY(InstanceValidator)
+    class Private;
+    std::unique_ptr<Private> d;
+};
+
+}
+
+#endif
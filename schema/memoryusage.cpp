@@ -0,0 +1,403 @@
+/*
+    This file is part of KDE Schema Parser
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Library General Public
+    License as published by the Free Software Foundation; either
+    version 2 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Library General Public License for more details.
+
+    You should have received a copy of the GNU Library General Public License
+    along with this library; see the file COPYING.LIB.  If not, write to
+    the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+    Boston, MA 02110-1301, USA.
+ */
+
+#include "memoryusage.h"
+#include "types.h"
+
+#include <QDebug>
+#include <QDomDocument>
+#include <QSet>
+
+namespace XSD {
+
+namespace {
+
+// Bookkeeping of the allocator for each heap block
+const qint64 heapOverhead = 16;
+
+// The private classes are not visible here, so their sizes are computed from their members
+const qint64 compositorPrivateSize = 3 * sizeof(int) + sizeof(QName::List);
+const qint64 xmlElementPrivateSize = 2 * sizeof(QString) + sizeof(Annotation::List);
+const qint64 xsdTypePrivateSize = sizeof(int) + sizeof(QName);
+const qint64 elementPrivateSize = 2 * sizeof(QName) + 3 * sizeof(QString) + 5 * sizeof(int)
+        + sizeof(Compositor) + compositorPrivateSize + heapOverhead;
+const qint64 attributePrivateSize = 2 * sizeof(QName) + 3 * sizeof(QString) + 2 * sizeof(int);
+const qint64 simpleTypePrivateSize =
+        2 * sizeof(QName) + 2 * sizeof(QString) + 3 * sizeof(int) + sizeof(QStringList);
+// The pattern and the four range values as written
+const qint64 facetsSize = 10 * sizeof(int) + 5 * sizeof(QString);
+const qint64 complexTypePrivateSize = sizeof(QString) + sizeof(Element::List)
+        + sizeof(Attribute::List) + sizeof(Group::List) + sizeof(AttributeGroup::List)
+        + 2 * sizeof(QName) + sizeof(QName::List) + 4 * sizeof(int);
+const qint64 annotationPrivateSize = sizeof(QDomElement);
+// QDomNodePrivate: pointers to the neighbours, four strings and the position
+const qint64 domNodeSize = 7 * sizeof(void *) + 4 * sizeof(QString) + 4 * sizeof(int);
+
+template<typename T>
+qint64 listSize(const QList<T> &list)
+{
+    if (list.isEmpty())
+        return 0;
+#if QT_VERSION < QT_VERSION_CHECK(6, 0, 0)
+    // Large types are allocated separately and stored as pointers
+    return heapOverhead + 16 + list.size() * sizeof(void *)
+            + (QTypeInfo<T>::isLarge || QTypeInfo<T>::isStatic
+                       ? list.size() * (sizeof(T) + heapOverhead)
+                       : 0);
+#else
+    return heapOverhead + 16 + list.capacity() * sizeof(T);
+#endif
+}
+
+}
+
+class MemoryUsage::Private
+{
+public:
+    void addString(const QString &string, Category category = Strings);
+    void addQName(const QName &name);
+    void addXmlElement(const XmlElement &element, qint64 privateSize, Category category);
+    void addElement(const Element &element);
+    void addAttribute(const Attribute &attribute);
+    void addAnnotation(const Annotation &annotation);
+    void addDomNode(const QDomNode &node);
+
+    qint64 mBytes[CategoryCount] = {};
+    int mSimpleTypeCount = 0;
+    int mComplexTypeCount = 0;
+    int mElementCount = 0;
+    int mAttributeCount = 0;
+    int mAnnotationCount = 0;
+    int mStringCount = 0;
+    int mDuplicateStringCount = 0;
+    qint64 mDuplicateStringBytes = 0;
+
+    QSet<const void *> mStringData;
+    QSet<QString> mStrings;
+    QList<QDomDocument> mDocuments;
+    // Annotation elements already counted, by document and position
+    QSet<QPair<int, QPair<int, int>>> mAnnotationElements;
+};
+
+void MemoryUsage::Private::addString(const QString &string, Category category)
+{
+    if (string.isEmpty())
+        return;
+    // Copies share the data, so only count it once
+    if (mStringData.contains(string.constData()))
+        return;
+    mStringData.insert(string.constData());
+
+    const qint64 size =
+            heapOverhead + sizeof(QArrayData) + (string.capacity() + 1) * sizeof(QChar);
+    mBytes[category] += size;
+    if (category != Strings)
+        return;
+    ++mStringCount;
+    if (mStrings.contains(string)) {
+        ++mDuplicateStringCount;
+        mDuplicateStringBytes += size;
+    } else {
+        mStrings.insert(string);
+    }
+}
+
+void MemoryUsage::Private::addQName(const QName &name)
+{
+    addString(name.nameSpace());
+    addString(name.localName());
+    addString(name.prefix());
+}
+
+void MemoryUsage::Private::addXmlElement(const XmlElement &element, qint64 privateSize,
+                                         Category category)
+{
+    mBytes[category] += privateSize + xmlElementPrivateSize + 2 * heapOverhead;
+    addString(element.name());
+    addString(element.nameSpace());
+    const Annotation::List annotations = element.annotations();
+    mBytes[Annotations] += listSize(annotations);
+    for (const Annotation &annotation : annotations)
+        addAnnotation(annotation);
+}
+
+void MemoryUsage::Private::addElement(const Element &element)
+{
+    ++mElementCount;
+    addXmlElement(element, elementPrivateSize, Elements);
+    addQName(element.type());
+    addQName(element.reference());
+    addString(element.documentation());
+    addString(element.defaultValue());
+    addString(element.fixedValue());
+    const QName::List children = element.compositor().children();
+    mBytes[Elements] += listSize(children);
+    for (const QName &child : children)
+        addQName(child);
+}
+
+void MemoryUsage::Private::addAttribute(const Attribute &attribute)
+{
+    ++mAttributeCount;
+    addXmlElement(attribute, attributePrivateSize, Attributes);
+    addQName(attribute.type());
+    addQName(attribute.reference());
+    addString(attribute.documentation());
+    addString(attribute.defaultValue());
+    addString(attribute.fixedValue());
+}
+
+void MemoryUsage::Private::addAnnotation(const Annotation &annotation)
+{
+    ++mAnnotationCount;
+    mBytes[Annotations] += annotationPrivateSize + heapOverhead;
+
+    const QDomElement element = annotation.domElement();
+    if (element.isNull())
+        return;
+    const QDomDocument document = element.ownerDocument();
+    int documentIndex = mDocuments.indexOf(document);
+    if (documentIndex < 0) {
+        documentIndex = mDocuments.count();
+        mDocuments.append(document);
+    }
+    // Copies of the annotation share the DOM nodes
+    const auto key = qMakePair(documentIndex,
+                               qMakePair(element.lineNumber(), element.columnNumber()));
+    if (mAnnotationElements.contains(key))
+        return;
+    mAnnotationElements.insert(key);
+    addDomNode(element);
+}
+
+void MemoryUsage::Private::addDomNode(const QDomNode &node)
+{
+    mBytes[Annotations] += domNodeSize + heapOverhead;
+    addString(node.nodeName(), Annotations);
+    addString(node.nodeValue(), Annotations);
+    const QDomNamedNodeMap attributes = node.attributes();
+    for (int i = 0; i < attributes.count(); ++i)
+        addDomNode(attributes.item(i));
+    for (QDomNode child = node.firstChild(); !child.isNull(); child = child.nextSibling())
+        addDomNode(child);
+}
+
+MemoryUsage::MemoryUsage() : d(new Private) {}
+
+MemoryUsage::MemoryUsage(const MemoryUsage &other) : d(new Private)
+{
+    *d = *other.d;
+}
+
+MemoryUsage::MemoryUsage(MemoryUsage &&other) = default;
+
+MemoryUsage::~MemoryUsage() = default;
+
+MemoryUsage &MemoryUsage::operator=(const MemoryUsage &other)
+{
+    if (this == &other) {
+        return *this;
+    }
+
+    *d = *other.d;
+
+    return *this;
+}
+
+MemoryUsage &MemoryUsage::operator=(MemoryUsage &&other) noexcept = default;
+
+void MemoryUsage::addTypes(const Types &types)
+{
+    const SimpleType::List simpleTypes = types.simpleTypes();
+    d->mBytes[SimpleTypes] += listSize(simpleTypes);
+    for (const SimpleType &type : simpleTypes) {
+        ++d->mSimpleTypeCount;
+        d->addXmlElement(type, xsdTypePrivateSize + simpleTypePrivateSize + heapOverhead,
+                         SimpleTypes);
+        d->addQName(type.substitutionElementName());
+        d->addQName(type.baseTypeName());
+        d->addQName(type.listTypeName());
+        d->addString(type.documentation());
+        d->addString(type.elementName());
+
+        d->mBytes[Facets] += facetsSize;
+        d->addString(type.facetPattern(), Facets);
+        for (SimpleType::FacetType facet : { SimpleType::MININC, SimpleType::MAXINC,
+                                             SimpleType::MINEX, SimpleType::MAXEX })
+            d->addString(type.facetRangeValue(facet), Facets);
+        const QStringList enums = type.facetEnums();
+        d->mBytes[Facets] += listSize(enums);
+        for (const QString &value : enums)
+            d->addString(value, Facets);
+    }
+
+    const ComplexType::List complexTypes = types.complexTypes();
+    d->mBytes[ComplexTypes] += listSize(complexTypes);
+    for (const ComplexType &type : complexTypes) {
+        ++d->mComplexTypeCount;
+        d->addXmlElement(type, xsdTypePrivateSize + complexTypePrivateSize + heapOverhead,
+                         ComplexTypes);
+        d->addQName(type.substitutionElementName());
+        d->addQName(type.baseTypeName());
+        d->addQName(type.arrayType());
+        d->addString(type.documentation());
+        const QName::List derivedTypes = type.derivedTypes();
+        d->mBytes[ComplexTypes] += listSize(derivedTypes);
+        for (const QName &name : derivedTypes)
+            d->addQName(name);
+
+        addElements(type.elements());
+        addAttributes(type.attributes());
+        const Group::List groups = type.groups();
+        d->mBytes[Elements] += listSize(groups);
+        for (const Group &group : groups) {
+            d->addXmlElement(group, sizeof(QName) + sizeof(Element::List), Elements);
+            d->addQName(group.reference());
+            addElements(group.elements());
+        }
+        const AttributeGroup::List attributeGroups = type.attributeGroups();
+        d->mBytes[Attributes] += listSize(attributeGroups);
+        for (const AttributeGroup &group : attributeGroups) {
+            d->addXmlElement(group, sizeof(QName) + sizeof(Attribute::List), Attributes);
+            d->addQName(group.reference());
+            addAttributes(group.attributes());
+        }
+    }
+
+    addElements(types.elements());
+    addAttributes(types.attributes());
+}
+
+void MemoryUsage::addElements(const Element::List &elements)
+{
+    d->mBytes[Elements] += listSize(elements);
+    for (const Element &element : elements)
+        d->addElement(element);
+}
+
+void MemoryUsage::addAttributes(const Attribute::List &attributes)
+{
+    d->mBytes[Attributes] += listSize(attributes);
+    for (const Attribute &attribute : attributes)
+        d->addAttribute(attribute);
+}
+
+void MemoryUsage::addAnnotations(const Annotation::List &annotations)
+{
+    d->mBytes[Annotations] += listSize(annotations);
+    for (const Annotation &annotation : annotations)
+        d->addAnnotation(annotation);
+}
+
+qint64 MemoryUsage::bytes(Category category) const
+{
+    return d->mBytes[category];
+}
+
+qint64 MemoryUsage::totalBytes() const
+{
+    qint64 total = 0;
+    for (qint64 bytes : d->mBytes)
+        total += bytes;
+    return total;
+}
+
+int MemoryUsage::simpleTypeCount() const
+{
+    return d->mSimpleTypeCount;
+}
+
+int MemoryUsage::complexTypeCount() const
+{
+    return d->mComplexTypeCount;
+}
+
+int MemoryUsage::elementCount() const
+{
+    return d->mElementCount;
+}
+
+int MemoryUsage::attributeCount() const
+{
+    return d->mAttributeCount;
+}
+
+int MemoryUsage::annotationCount() const
+{
+    return d->mAnnotationCount;
+}
+
+int MemoryUsage::stringCount() const
+{
+    return d->mStringCount;
+}
+
+int MemoryUsage::duplicateStringCount() const
+{
+    return d->mDuplicateStringCount;
+}
+
+qint64 MemoryUsage::duplicateStringBytes() const
+{
+    return d->mDuplicateStringBytes;
+}
+
+int MemoryUsage::documentCount() const
+{
+    return d->mDocuments.count();
+}
+
+QString MemoryUsage::categoryName(Category category)
+{
+    switch (category) {
+    case Strings:
+        return QStringLiteral("strings");
+    case SimpleTypes:
+        return QStringLiteral("simple types");
+    case ComplexTypes:
+        return QStringLiteral("complex types");
+    case Elements:
+        return QStringLiteral("elements");
+    case Attributes:
+        return QStringLiteral("attributes");
+    case Annotations:
+        return QStringLiteral("annotations");
+    case Facets:
+        return QStringLiteral("facets");
+    case CategoryCount:
+        break;
+    }
+    return QString();
+}
+
+}
+
+QDebug operator<<(QDebug dbg, const XSD::MemoryUsage &usage)
+{
+    QDebugStateSaver saver(dbg);
+    dbg.nospace() << "MemoryUsage(" << usage.totalBytes() << " bytes";
+    for (int i = 0; i < XSD::MemoryUsage::CategoryCount; ++i) {
+        const auto category = static_cast<XSD::MemoryUsage::Category>(i);
+        dbg << ", " << XSD::MemoryUsage::categoryName(category) << ": " << usage.bytes(category);
+    }
+    dbg << ", " << usage.stringCount() << " strings, " << usage.duplicateStringCount()
+        << " duplicates (" << usage.duplicateStringBytes() << " bytes), "
+        << usage.documentCount() << " documents)";
+    return dbg;
+}
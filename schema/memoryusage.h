@@ -0,0 +1,97 @@
+/*
+    This file is part of KDE Schema Parser
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Library General Public
+    License as published by the Free Software Foundation; either
+    version 2 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Library General Public License for more details.
+
+    You should have received a copy of the GNU Library General Public License
+    along with this library; see the file COPYING.LIB.  If not, write to
+    the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+    Boston, MA 02110-1301, USA.
+ */
+
+#ifndef SCHEMA_MEMORYUSAGE_H
+#define SCHEMA_MEMORYUSAGE_H
+
+#include "annotation.h"
+#include "attribute.h"
+#include "element.h"
+#include <kode_export.h>
+
+#include <memory>
+
+QT_BEGIN_NAMESPACE
+class QDebug;
+QT_END_NAMESPACE
+
+namespace XSD {
+
+class Types;
+
+// Estimates the heap memory held by a schema model. Objects are counted as
+// often as they are copied, strings and DOM nodes are counted once, as they
+// are implicitly shared.
+class SCHEMA_EXPORT MemoryUsage
+{
+public:
+    enum Category {
+        Strings, // character data of names, documentation, values
+        SimpleTypes, // simple type objects, without their facets
+        ComplexTypes, // complex type objects, without their elements and attributes
+        Elements, // element objects, including groups and compositors
+        Attributes, // attribute objects, including attribute groups
+        Annotations, // annotation objects and the DOM nodes they reference
+        Facets, // facet data of simple types, including enumeration values
+        CategoryCount
+    };
+
+    MemoryUsage();
+    MemoryUsage(const MemoryUsage &other);
+    MemoryUsage(MemoryUsage &&other);
+    ~MemoryUsage();
+
+    MemoryUsage &operator=(const MemoryUsage &other);
+    MemoryUsage &operator=(MemoryUsage &&other) noexcept;
+
+    void addTypes(const Types &types);
+    void addElements(const Element::List &elements);
+    void addAttributes(const Attribute::List &attributes);
+    void addAnnotations(const Annotation::List &annotations);
+
+    qint64 bytes(Category category) const;
+    qint64 totalBytes() const;
+
+    int simpleTypeCount() const;
+    int complexTypeCount() const;
+    int elementCount() const;
+    int attributeCount() const;
+    int annotationCount() const;
+
+    // Number of separately allocated strings
+    int stringCount() const;
+    // Strings with the same content as an other string, which could be shared
+    int duplicateStringCount() const;
+    qint64 duplicateStringBytes() const;
+
+    // Number of DOM documents kept alive by annotations
+    int documentCount() const;
+
+    static QString categoryName(Category category);
+
+private:
+    class Private;
+    std::unique_ptr<Private> d;
+};
+
+}
+
+SCHEMA_EXPORT QDebug operator<<(QDebug dbg, const XSD::MemoryUsage &usage);
+
+#endif
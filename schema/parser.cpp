@@ -22,8 +22,17 @@
  */
 
 #include <QBuffer>
+#include <QCryptographicHash>
 #include <QDir>
+#include <QDomDocument>
 #include <QFile>
+#include <QFileInfo>
+#include <QFutureInterface>
+#include <QFutureWatcher>
+#include <QHash>
+#include <QRunnable>
+#include <QSet>
+#include <QThreadPool>
 #include <QUrl>
 #include <QtDebug>
 #include <QtCore/QLatin1String>
@@ -32,8 +41,13 @@
 #include <common/messagehandler.h>
 #include <common/nsmanager.h>
 #include <common/parsercontext.h>
+#include <common/schemabundle.h>
+#include <common/schemafetcher.h>
+#include <common/xmlcatalog.h>
 #include "parser.h"
 
+#include <functional>
+
 static const QString XMLSchemaURI(QLatin1String("http://www.w3.org/2001/XMLSchema"));
 static const QString WSDLSchemaURI(QLatin1String("http://schemas.xmlsoap.org/wsdl/"));
 static const QString soapEncNs = QLatin1String("http://schemas.xmlsoap.org/soap/encoding/");
@@ -51,27 +65,213 @@ static bool stringToBoolean(const QString &str)
 class Parser::Private
 {
 public:
+    // A global component of a schema parsed in lazy mode
+    struct LazyComponent
+    {
+        // The serialized element with the namespace declarations in its scope, so
+        // that the document it was found in can be released
+        QByteArray source;
+        QString nameSpace;
+        bool defaultQualifiedElements = false;
+        bool defaultQualifiedAttributes = false;
+        // Of the context the component was found with
+        MessageHandler *messageHandler = nullptr;
+        QUrl documentBaseUrl;
+    };
+
+    void addSourceFile(const QString &fileName);
+    // Reads the document at @p url from a mounted bundle or through FileProvider
+    bool readDocument(const QUrl &url, QByteArray *data, QString *sourceFile) const;
+    // Like readDocument(), also remembers the document for Parser::writeBundle()
+    bool loadDocument(const QUrl &url, QByteArray *data);
+    void addLoadedDocument(const QUrl &url);
+    void appendComplexType(const ComplexType &type);
+    // Replaces the complex type at @p index, keeping mComplexTypeStructures up to date
+    void replaceComplexType(int index, const ComplexType &type);
+    QHash<QName, LazyComponent> &lazyComponents(Parser::ComponentKind kind);
+
+    // Positions of the first component with each name in a list which only grows,
+    // catches up with the components appended since the last lookup
+    struct NameIndex
+    {
+        template<typename List>
+        int find(const List &list, const QName &name)
+        {
+            if (mIndexed > list.count())
+                clear();
+            for (; mIndexed < list.count(); ++mIndexed) {
+                const QName key = list.at(mIndexed).qualifiedName();
+                if (!mPositions.contains(key))
+                    mPositions.insert(key, mIndexed);
+            }
+            return mPositions.value(name, -1);
+        }
+        void clear()
+        {
+            mPositions.clear();
+            mIndexed = 0;
+        }
+
+        QHash<QName, int> mPositions;
+        int mIndexed = 0;
+    };
+
     QString mNameSpace;
 
     SimpleType::List mSimpleTypes;
     ComplexType::List mComplexTypes;
+    // Index of the first complex type of each name
+    QHash<QName, int> mComplexTypeIndex;
+    // Indexes of the complex types by structural hash
+    QMultiHash<uint, int> mComplexTypeStructures;
+    // Next number to try for naming the anonymous types of an element
+    QHash<QName, int> mAnonymousTypeSuffix;
     Element::List mElements;
     Attribute::List mAttributes;
     Group::List mGroups;
     AttributeGroup::List mAttributeGroups;
+    NameIndex mElementIndex;
+    NameIndex mAttributeIndex;
+    NameIndex mGroupIndex;
+    NameIndex mAttributeGroupIndex;
     Annotation::List mAnnotations;
 
-    QStringList mImportedSchemas;
-    QStringList mIncludedSchemas;
+    // Namespaces which are parsed already, and the canonical locations of the
+    // schemas which are imported or included already
+    QSet<QString> mImportedNamespaces;
+    QSet<QString> mImportedSchemas;
+    QSet<QString> mIncludedSchemas;
+    // Content hashes of the imported and included documents
+    QSet<QByteArray> mParsedDocuments;
+    QStringList mSourceFiles;
+    QList<QUrl> mLoadedDocuments;
 
     QMap<QUrl, QString> mLocalSchemas;
+    XmlCatalog mCatalog;
 
     bool mDefaultQualifiedElements = false;
     bool mDefaultQualifiedAttributes = false;
     bool mUseLocalFilesOnly = false;
+    // Off in parseAsync(), where the fetcher downloaded everything before
+    bool mDownloadsEnabled = true;
     QStringList mImportPathList;
+
+    bool mUseArena = false;
+    Arena mArena;
+    // The arena to activate while parsing and resolving, if any
+    const Arena *activeArena() const { return mUseArena ? &mArena : nullptr; }
+
+    bool mLazyParsing = false;
+    // Components which were not parsed yet, by name
+    QHash<QName, LazyComponent> mLazyElements;
+    QHash<QName, LazyComponent> mLazyTypes;
+    QHash<QName, LazyComponent> mLazyAttributes;
+    QHash<QName, LazyComponent> mLazyGroups;
+    QHash<QName, LazyComponent> mLazyAttributeGroups;
+    // Substituting elements by head element, derived complex types by base type
+    QMultiHash<QName, QName> mLazySubstitutions;
+    QMultiHash<QName, QName> mLazyDerivedTypes;
 };
 
+void Parser::Private::addSourceFile(const QString &fileName)
+{
+    if (fileName.isEmpty() || fileName.startsWith(QLatin1Char(':')))
+        return;
+
+    const QString path = QFileInfo(fileName).absoluteFilePath();
+    if (!mSourceFiles.contains(path))
+        mSourceFiles.append(path);
+}
+
+bool Parser::Private::readDocument(const QUrl &url, QByteArray *data, QString *sourceFile) const
+{
+    if (FileProvider::findInBundles(url, data)) {
+        return true;
+    }
+
+    FileProvider provider(mUseLocalFilesOnly, mImportPathList, mLocalSchemas);
+    provider.setCatalog(mCatalog);
+    provider.setDownloadsEnabled(mDownloadsEnabled);
+    QString fileName;
+    if (!provider.get(url, fileName)) {
+        return false;
+    }
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly)) {
+        qDebug("Unable to open file %s", qPrintable(file.fileName()));
+        return false;
+    }
+    *data = file.readAll();
+    if (sourceFile && !provider.isTemporary()) {
+        *sourceFile = fileName;
+    }
+    return true;
+}
+
+bool Parser::Private::loadDocument(const QUrl &url, QByteArray *data)
+{
+    QString sourceFile;
+    if (!readDocument(url, data, &sourceFile)) {
+        return false;
+    }
+    addSourceFile(sourceFile);
+    addLoadedDocument(url);
+    return true;
+}
+
+void Parser::Private::addLoadedDocument(const QUrl &url)
+{
+    if (!mLoadedDocuments.contains(url)) {
+        mLoadedDocuments.append(url);
+    }
+}
+
+void Parser::Private::appendComplexType(const ComplexType &type)
+{
+    const int index = mComplexTypes.count();
+    mComplexTypes.append(type);
+    if (!mComplexTypeIndex.contains(type.qualifiedName()))
+        mComplexTypeIndex.insert(type.qualifiedName(), index);
+    mComplexTypeStructures.insert(type.structuralHash(), index);
+}
+
+void Parser::Private::replaceComplexType(int index, const ComplexType &type)
+{
+    mComplexTypeStructures.remove(mComplexTypes.at(index).structuralHash(), index);
+    mComplexTypes[index] = type;
+    mComplexTypeStructures.insert(type.structuralHash(), index);
+}
+
+QHash<QName, Parser::Private::LazyComponent> &
+Parser::Private::lazyComponents(Parser::ComponentKind kind)
+{
+    switch (kind) {
+    case Parser::ElementComponent:
+        return mLazyElements;
+    case Parser::TypeComponent:
+        return mLazyTypes;
+    case Parser::AttributeComponent:
+        return mLazyAttributes;
+    case Parser::GroupComponent:
+        return mLazyGroups;
+    case Parser::AttributeGroupComponent:
+        break;
+    }
+    return mLazyAttributeGroups;
+}
+
+// Returns whether @p name is @p baseName, optionally followed by a number
+static bool isNumberedName(const QString &name, const QString &baseName)
+{
+    if (!name.startsWith(baseName))
+        return false;
+    for (int i = baseName.length(); i < name.length(); ++i) {
+        if (!name.at(i).isDigit())
+            return false;
+    }
+    return true;
+}
+
 Parser::Parser(ParserContext *context, const QString &nameSpace, bool useLocalFilesOnly,
                const QStringList &importPathList)
     : d(new Private)
@@ -90,6 +290,8 @@ Parser::Parser(const QString &nameSpace) : d(new Private)
 Parser::Parser(const Parser &other) : d(new Private)
 {
     *d = *other.d;
+    // Arenas must not be used by two threads at once
+    d->mArena = Arena();
 }
 
 Parser::Parser(Parser &&other) : d(std::move(other.d)) {}
@@ -106,26 +308,68 @@ Parser &Parser::operator=(const Parser &other)
     }
 
     *d = *other.d;
+    d->mArena = Arena();
 
     return *this;
 }
 
 Parser &Parser::operator=(Parser &&other) noexcept = default;
 
+void Parser::setUseArena(bool useArena)
+{
+    d->mUseArena = useArena;
+}
+
+bool Parser::useArena() const
+{
+    return d->mUseArena;
+}
+
+Arena Parser::arena() const
+{
+    return d->mArena;
+}
+
 void Parser::setLocalSchemas(const QMap<QUrl, QString> &localSchemas)
 {
     d->mLocalSchemas = localSchemas;
 }
 
+void Parser::setCatalog(const XmlCatalog &catalog)
+{
+    d->mCatalog = catalog;
+}
+
 void Parser::clear()
 {
+    d->mImportedNamespaces.clear();
     d->mImportedSchemas.clear();
+    d->mIncludedSchemas.clear();
+    d->mParsedDocuments.clear();
+    d->mSourceFiles.clear();
+    d->mLoadedDocuments.clear();
     d->mComplexTypes.clear();
+    d->mComplexTypeIndex.clear();
+    d->mComplexTypeStructures.clear();
+    d->mAnonymousTypeSuffix.clear();
     d->mSimpleTypes.clear();
     d->mElements.clear();
     d->mGroups.clear();
     d->mAttributes.clear();
     d->mAttributeGroups.clear();
+    d->mElementIndex.clear();
+    d->mAttributeIndex.clear();
+    d->mGroupIndex.clear();
+    d->mAttributeGroupIndex.clear();
+    d->mLazyElements.clear();
+    d->mLazyTypes.clear();
+    d->mLazyAttributes.clear();
+    d->mLazyGroups.clear();
+    d->mLazyAttributeGroups.clear();
+    d->mLazySubstitutions.clear();
+    d->mLazyDerivedTypes.clear();
+    // The blocks of the old arena are released once its objects are gone
+    d->mArena = Arena();
 }
 
 void Parser::init(ParserContext *context)
@@ -145,8 +389,8 @@ void Parser::init(ParserContext *context)
         schema.setType(QName(XMLSchemaURI, QLatin1String("anyType")));
         d->mElements.append(schema);
     }
-    d->mImportedSchemas.append(XMLSchemaURI);
-    d->mImportedSchemas.append(NSManager::xmlNamespace());
+    d->mImportedNamespaces.insert(XMLSchemaURI);
+    d->mImportedNamespaces.insert(NSManager::xmlNamespace());
 
     // Define xml:lang, since we don't parse xml.xsd
     {
@@ -159,6 +403,7 @@ void Parser::init(ParserContext *context)
 
 bool Parser::parseSchemaTag(ParserContext *context, const QDomElement &root)
 {
+    Arena::Scope arenaScope(d->activeArena());
     QName name(root.tagName());
     if (name.localName() != QLatin1String("schema")) {
         qDebug() << "ERROR localName=" << name.localName();
@@ -195,6 +440,8 @@ bool Parser::parseSchemaTag(ParserContext *context, const QDomElement &root)
 
         if (name.localName() == QLatin1String("import")) {
             parseImport(context, element);
+        } else if (d->mLazyParsing && addLazyComponent(context, element)) {
+            // parsed when used
         } else if (name.localName() == QLatin1String("element")) {
             addGlobalElement(parseElement(context, element, d->mNameSpace, element));
         } else if (name.localName() == QLatin1String("complexType")) {
@@ -203,7 +450,7 @@ bool Parser::parseSchemaTag(ParserContext *context, const QDomElement &root)
             for (const auto &subelem : ct.elements()) {
                 d->mElements.append(subelem);
             }
-            d->mComplexTypes.append(ct);
+            d->appendComplexType(ct);
         } else if (name.localName() == QLatin1String("simpleType")) {
             SimpleType st = parseSimpleType(context, element);
             d->mSimpleTypes.append(st);
@@ -226,7 +473,7 @@ bool Parser::parseSchemaTag(ParserContext *context, const QDomElement &root)
 
     resolveForwardDeclarations();
 
-    d->mImportedSchemas.append(d->mNameSpace);
+    d->mImportedNamespaces.insert(d->mNameSpace);
     d->mNameSpace = oldNamespace;
     d->mDefaultQualifiedElements = oldDefaultQualifiedElements;
     d->mDefaultQualifiedAttributes = oldDefaultQualifiedAttributes;
@@ -234,6 +481,69 @@ bool Parser::parseSchemaTag(ParserContext *context, const QDomElement &root)
     return true;
 }
 
+static QUrl urlForLocation(ParserContext *context, const QString &location)
+{
+    QUrl url(location);
+    if (url.isRelative() || url.scheme() == QLatin1String("file")) {
+        QDir dir(location);
+        url = context->documentBaseUrl();
+        return QUrl::fromLocalFile(QDir(url.path()).filePath(location));
+    }
+    return url;
+}
+
+// Spells the locations of the same document the same way: local files by
+// their canonical path, other URLs without "." and ".." segments
+static QString canonicalLocation(const QUrl &url)
+{
+    if (url.isLocalFile()) {
+        const QFileInfo info(url.toLocalFile());
+        const QString canonical = info.canonicalFilePath();
+        return QUrl::fromLocalFile(canonical.isEmpty() ? QDir::cleanPath(info.absoluteFilePath())
+                                                       : canonical)
+                .toString();
+    }
+    return url.adjusted(QUrl::NormalizePathSegments).toString();
+}
+
+// Whether the schema imports or includes documents by relative locations
+static bool hasRelativeReferences(const QDomElement &schema)
+{
+    for (QDomElement child = schema.firstChildElement(); !child.isNull();
+         child = child.nextSiblingElement()) {
+        const QString name = QName(child.tagName()).localName();
+        if (name != QLatin1String("import") && name != QLatin1String("include")
+            && name != QLatin1String("redefine")) {
+            continue;
+        }
+        const QString location = child.attribute(QLatin1String("schemaLocation"));
+        if (!location.isEmpty() && QUrl(location).isRelative())
+            return true;
+    }
+    return false;
+}
+
+// Returns false if the same document was imported or included already, under
+// any location. Included documents take the namespace of the including schema,
+// so they are only the same for the same namespace. Copies with relative
+// references are only the same in the same directory, as they may refer to
+// different documents.
+static bool isNewDocument(QSet<QByteArray> &parsedDocuments, const QByteArray &data,
+                          const QDomElement &schema, const QUrl &url, const QString &nameSpace)
+{
+    QCryptographicHash hash(QCryptographicHash::Sha256);
+    hash.addData(data);
+    hash.addData(nameSpace.toUtf8());
+    if (hasRelativeReferences(schema))
+        hash.addData(canonicalLocation(url.adjusted(QUrl::RemoveFilename)).toUtf8());
+    const QByteArray key = hash.result();
+    if (parsedDocuments.contains(key)) {
+        return false;
+    }
+    parsedDocuments.insert(key);
+    return true;
+}
+
 void Parser::parseImport(ParserContext *context, const QDomElement &element)
 {
     // https://www.w3.org/TR/2004/REC-xmlschema-1-20041028/structures.html#layer2
@@ -258,14 +568,17 @@ void Parser::parseImport(ParserContext *context, const QDomElement &element)
         } else {
             return; // <import/> means nothing to us
         }
+        if (d->mImportedNamespaces.contains(location)) {
+            return;
+        }
     }
 
     // don't import a schema twice
-    if (d->mImportedSchemas.contains(location)) {
+    const QString canonical = canonicalLocation(urlForLocation(context, location));
+    if (d->mImportedSchemas.contains(canonical)) {
         return;
-    } else {
-        d->mImportedSchemas.append(location);
     }
+    d->mImportedSchemas.insert(canonical);
 
     importSchema(context, location);
 }
@@ -276,11 +589,11 @@ void Parser::parseInclude(ParserContext *context, const QDomElement &element)
 
     if (!location.isEmpty()) {
         // don't include a schema twice
-        if (d->mIncludedSchemas.contains(location)) {
+        const QString canonical = canonicalLocation(urlForLocation(context, location));
+        if (d->mIncludedSchemas.contains(canonical)) {
             return;
-        } else {
-            d->mIncludedSchemas.append(location);
         }
+        d->mIncludedSchemas.insert(canonical);
 
         includeSchema(context, location);
     } else {
@@ -432,7 +745,10 @@ void Parser::parseCompositor(ParserContext *context, const QDomElement &element,
                 elements->append(newElement);
                 compositor.addChild(csName);
             } else if (localName == QLatin1String("any")) {
-                elements->append(parseAny(context, childElement, nameSpace));
+                Element newElement = parseAny(context, childElement, nameSpace);
+                newElement.setCompositor(compositor);
+                elements->append(newElement);
+                compositor.addChild(csName);
             } else if (localName == QLatin1String("choice")
                        || localName == QLatin1String("sequence")) {
                 parseCompositor(context, childElement, nameSpace, elements, groups);
@@ -492,9 +808,9 @@ Element Parser::parseElement(ParserContext *context, const QDomElement &element,
             QName baseElementName(element.attribute(QLatin1String("substitutionGroup")));
             baseElementName.setNameSpace(
                     context->namespaceManager()->uri(baseElementName.prefix()));
-            XSD::Element::List::iterator ctit_base = d->mElements.findElement(baseElementName);
-            if (ctit_base != d->mElements.end()) {
-                XSD::Element &baseElem = *ctit_base;
+            const int baseIndex = d->mElementIndex.find(d->mElements, baseElementName);
+            if (baseIndex >= 0) {
+                XSD::Element &baseElem = d->mElements[baseIndex];
                 // Record that the base element has substitutions
                 baseElem.setHasSubstitutions(true);
                 // Its type will need a virtual method _kd_substitutionElementName so fill in the
@@ -519,25 +835,33 @@ Element Parser::parseElement(ParserContext *context, const QDomElement &element,
                 ComplexType ct = parseComplexType(context, childElement);
                 ct.setAnonymous(true);
                 ct.setName(newElement.name());
-                int i = 0;
                 bool typeExists = false;
-                ComplexType existingType =
-                        d->mComplexTypes.complexType(QName(ct.nameSpace(), ct.name()));
-                while (!existingType.isNull()) {
-                    if (existingType == ct) {
-                        qCDebug(parser) << "  Nested complexType of name" << ct.name()
+                // Look for a structurally identical type named after the element,
+                // optionally followed by a number, only comparing on equal hashes
+                const uint hash = ct.structuralHash();
+                for (auto it = d->mComplexTypeStructures.constFind(hash);
+                     it != d->mComplexTypeStructures.constEnd() && it.key() == hash; ++it) {
+                    const ComplexType &existingType = d->mComplexTypes.at(it.value());
+                    if (!isNumberedName(existingType.name(), newElement.name()))
+                        continue;
+                    ComplexType candidate = ct;
+                    candidate.setName(existingType.name());
+                    if (existingType == candidate) {
+                        qCDebug(parser) << "  Nested complexType of name" << existingType.name()
                                         << "is structurally identical with existing complexType of "
                                            "the same name, skipping this instance...";
+                        ct.setName(existingType.name());
                         typeExists = true;
                         break;
-                    } else {
-                        ct.setName(newElement.name() + QString::number(++i));
-                        existingType =
-                                d->mComplexTypes.complexType(QName(ct.nameSpace(), ct.name()));
                     }
                 }
                 if (!typeExists) {
-                    d->mComplexTypes.append(ct);
+                    int &suffix = d->mAnonymousTypeSuffix[QName(ct.nameSpace(), newElement.name())];
+                    if (suffix > 0)
+                        ct.setName(newElement.name() + QString::number(suffix));
+                    while (d->mComplexTypeIndex.contains(QName(ct.nameSpace(), ct.name())))
+                        ct.setName(newElement.name() + QString::number(++suffix));
+                    d->appendComplexType(ct);
                     if (newElement.name() != ct.name())
                         qCDebug(parser)
                                 << "  Detected type collision for nested complexType, updated name"
@@ -571,7 +895,7 @@ Element Parser::parseElement(ParserContext *context, const QDomElement &element,
         ct.setNameSpace(newElement.nameSpace());
         ct.setName(newElement.name());
         ct.setAnonymous(true);
-        d->mComplexTypes.append(ct);
+        d->appendComplexType(ct);
         newElement.setType(ct.qualifiedName());
     }
 
@@ -580,10 +904,13 @@ Element Parser::parseElement(ParserContext *context, const QDomElement &element,
 
 void Parser::setSubstitutionElementName(const QName &typeName, const QName &elemName)
 {
-    XSD::ComplexType::List::iterator ctit = d->mComplexTypes.findComplexType(typeName);
-    if (ctit != d->mComplexTypes.end()) {
+    const int complexTypeIndex = d->mComplexTypeIndex.value(typeName, -1);
+    if (complexTypeIndex >= 0) {
         // If this type already has an element name associated, they are aliases, any one will do.
-        (*ctit).setSubstitutionElementName(elemName);
+        // The element name is part of the structural hash.
+        ComplexType complexType = d->mComplexTypes.at(complexTypeIndex);
+        complexType.setSubstitutionElementName(elemName);
+        d->replaceComplexType(complexTypeIndex, complexType);
     } else {
         XSD::SimpleType::List::iterator stit = d->mSimpleTypes.findSimpleType(typeName);
         if (stit != d->mSimpleTypes.end()) {
@@ -756,7 +1083,7 @@ SimpleType Parser::parseSimpleType(ParserContext *context, const QDomElement &el
                                 + QLatin1String("ListItem")); // need to make something up, so that
                                                               // the classname looks good
                         st.setListTypeName(ctItem.qualifiedName());
-                        d->mComplexTypes.append(ctItem);
+                        d->appendComplexType(ctItem);
                     } else if (typeName.localName() == QLatin1String("simpleType")) {
                         SimpleType stItem = parseSimpleType(context, typeElement);
                         stItem.setName(
@@ -895,6 +1222,9 @@ void Parser::parseComplexContent(ParserContext *context, const QDomElement &elem
                             QString::fromLatin1("anyType"))) { // don't do this for anyType or Array
                     complexType.setBaseTypeName(typeName);
                 }
+                complexType.setBaseDerivation(name.localName() == QLatin1String("extension")
+                                                      ? ComplexType::Extension
+                                                      : ComplexType::Restriction);
 
                 QDomElement ctElement = childElement.firstChildElement();
                 while (!ctElement.isNull()) {
@@ -967,6 +1297,7 @@ void Parser::parseSimpleContent(ParserContext *context, const QDomElement &eleme
                 QName typeName(childElement.attribute(QLatin1String("base")));
                 typeName.setNameSpace(context->namespaceManager()->uri(typeName.prefix()));
                 complexType.setBaseTypeName(typeName);
+                complexType.setBaseDerivation(ComplexType::Extension);
 
                 QDomElement ctElement = childElement.firstChildElement();
                 while (!ctElement.isNull()) {
@@ -991,15 +1322,7 @@ void Parser::addGlobalElement(const Element &newElement)
     // qDebug() << "Adding global element" << newElement.qualifiedName();
 
     // don't add elements twice
-    bool found = false;
-    for (int i = 0; i < d->mElements.count(); ++i) {
-        if (d->mElements[i].qualifiedName() == newElement.qualifiedName()) {
-            found = true;
-            break;
-        }
-    }
-
-    if (!found) {
+    if (d->mElementIndex.find(d->mElements, newElement.qualifiedName()) < 0) {
         d->mElements.append(newElement);
     }
 }
@@ -1007,15 +1330,7 @@ void Parser::addGlobalElement(const Element &newElement)
 void Parser::addGlobalAttribute(const Attribute &newAttribute)
 {
     // don't add attributes twice
-    bool found = false;
-    for (int i = 0; i < d->mAttributes.count(); ++i) {
-        if (d->mAttributes[i].qualifiedName() == newAttribute.qualifiedName()) {
-            found = true;
-            break;
-        }
-    }
-
-    if (!found) {
+    if (d->mAttributeIndex.find(d->mAttributes, newAttribute.qualifiedName()) < 0) {
         d->mAttributes.append(newAttribute);
     }
 }
@@ -1095,17 +1410,6 @@ QString Parser::targetNamespace() const
     return d->mNameSpace;
 }
 
-static QUrl urlForLocation(ParserContext *context, const QString &location)
-{
-    QUrl url(location);
-    if (url.isRelative() || url.scheme() == QLatin1String("file")) {
-        QDir dir(location);
-        url = context->documentBaseUrl();
-        return QUrl::fromLocalFile(QDir(url.path()).filePath(location));
-    }
-    return url;
-}
-
 // Note: https://www.w3.org/TR/xmlschema-0/#schemaLocation paragraph 3 (for <import>) says
 // "schemaLocation is only a hint"
 void Parser::importSchema(ParserContext *context, const QString &location)
@@ -1119,28 +1423,21 @@ void Parser::importSchema(ParserContext *context, const QString &location)
         return;
     }
 
-    FileProvider provider(d->mUseLocalFilesOnly, d->mImportPathList, d->mLocalSchemas);
-    QString fileName;
+    QByteArray data;
     const QUrl schemaLocation = urlForLocation(context, location);
     qDebug("importing schema at %s", schemaLocation.toEncoded().constData());
-    if (provider.get(schemaLocation, fileName)) {
-        QFile file(fileName);
-        if (!file.open(QIODevice::ReadOnly)) {
-            qDebug("Unable to open file %s", qPrintable(file.fileName()));
-            return;
-        }
-
+    if (d->loadDocument(schemaLocation, &data)) {
         QDomDocument doc(QLatin1String("kwsdl"));
 #if QT_VERSION < QT_VERSION_CHECK(6, 5, 0)
         QString errorMsg;
         int errorLine, errorColumn;
-        bool ok = doc.setContent(&file, false, &errorMsg, &errorLine, &errorColumn);
+        bool ok = doc.setContent(data, false, &errorMsg, &errorLine, &errorColumn);
         if (!ok) {
             qDebug("Error[%d:%d] %s", errorLine, errorColumn, qPrintable(errorMsg));
             return;
         }
 #else
-        if (auto result = doc.setContent(&file); !result) {
+        if (auto result = doc.setContent(data); !result) {
             qDebug("Error[%lld:%lld] %s", result.errorLine, result.errorColumn,
                    qPrintable(result.errorMessage));
             return;
@@ -1148,6 +1445,10 @@ void Parser::importSchema(ParserContext *context, const QString &location)
 #endif
 
         QDomElement node = doc.documentElement();
+        if (!isNewDocument(d->mParsedDocuments, data, node, schemaLocation, QString())) {
+            qDebug("Schema at %s was imported already", schemaLocation.toEncoded().constData());
+            return;
+        }
 
         NSManager namespaceManager(context, node);
 
@@ -1157,8 +1458,6 @@ void Parser::importSchema(ParserContext *context, const QString &location)
         } else {
             qDebug("No schema tag found in schema file %s", schemaLocation.toEncoded().constData());
         }
-
-        file.close();
     }
 }
 
@@ -1168,28 +1467,21 @@ void Parser::importSchema(ParserContext *context, const QString &location)
 //      target namespace is the same as the including schema's target namespace"
 void Parser::includeSchema(ParserContext *context, const QString &location)
 {
-    FileProvider provider(d->mUseLocalFilesOnly, d->mImportPathList, d->mLocalSchemas);
-    QString fileName;
+    QByteArray data;
     const QUrl schemaLocation = urlForLocation(context, location);
     qDebug("including schema at %s", schemaLocation.toEncoded().constData());
-    if (provider.get(schemaLocation, fileName)) {
-        QFile file(fileName);
-        if (!file.open(QIODevice::ReadOnly)) {
-            qDebug("Unable to open file %s", qPrintable(file.fileName()));
-            return;
-        }
-
+    if (d->loadDocument(schemaLocation, &data)) {
         QDomDocument doc(QLatin1String("kwsdl"));
 #if QT_VERSION < QT_VERSION_CHECK(6, 5, 0)
         QString errorMsg;
         int errorLine, errorColumn;
-        bool ok = doc.setContent(&file, false, &errorMsg, &errorLine, &errorColumn);
+        bool ok = doc.setContent(data, false, &errorMsg, &errorLine, &errorColumn);
         if (!ok) {
             qDebug("Error[%d:%d] %s", errorLine, errorColumn, qPrintable(errorMsg));
             return;
         }
 #else
-        if (auto result = doc.setContent(&file); !result) {
+        if (auto result = doc.setContent(data); !result) {
             qDebug("Error[%lld:%lld] %s", result.errorLine, result.errorColumn,
                    qPrintable(result.errorMessage));
             return;
@@ -1197,6 +1489,11 @@ void Parser::includeSchema(ParserContext *context, const QString &location)
 #endif
 
         QDomElement node = doc.documentElement();
+        if (!isNewDocument(d->mParsedDocuments, data, node, schemaLocation, d->mNameSpace)) {
+            qDebug("Schema at %s was included already", schemaLocation.toEncoded().constData());
+            return;
+        }
+
         NSManager namespaceManager(context, node);
         const QName tagName(node.tagName());
         if (tagName.localName() == QLatin1String("schema")) {
@@ -1213,8 +1510,6 @@ void Parser::includeSchema(ParserContext *context, const QString &location)
         } else {
             qDebug("No schema tag found in schema file %s", schemaLocation.toEncoded().constData());
         }
-
-        file.close();
     }
 }
 
@@ -1236,45 +1531,53 @@ QString Parser::schemaUri()
     return XMLSchemaURI;
 }
 
-Element Parser::findElement(const QName &name) const
+Element Parser::findElement(const QName &name)
 {
-    for (const Element &e : std::as_const(d->mElements)) {
-        if (e.nameSpace() == name.nameSpace() && e.name() == name.localName()) {
-            return e;
-        }
+    const int index = d->mElementIndex.find(d->mElements, name);
+    if (index >= 0) {
+        return d->mElements.at(index);
+    }
+    if (parseLazyComponent(ElementComponent, name)) {
+        return findElement(name);
     }
     qDebug() << "Element not found:" << name.nameSpace() << name.localName();
     return Element();
 }
 
-Group Parser::findGroup(const QName &name) const
+Group Parser::findGroup(const QName &name)
 {
-    for (const Group &g : std::as_const(d->mGroups)) {
-        if (g.nameSpace() == name.nameSpace() && g.name() == name.localName()) {
-            return g;
-        }
+    const int index = d->mGroupIndex.find(d->mGroups, name);
+    if (index >= 0) {
+        return d->mGroups.at(index);
+    }
+    if (parseLazyComponent(GroupComponent, name)) {
+        return findGroup(name);
     }
     qDebug() << "Group not found:" << name.nameSpace() << name.localName();
     return Group();
 }
 
-Attribute Parser::findAttribute(const QName &name) const
+Attribute Parser::findAttribute(const QName &name)
 {
-    for (const Attribute &attr : std::as_const(d->mAttributes)) {
-        if (attr.nameSpace() == name.nameSpace() && attr.name() == name.localName()) {
-            return attr;
-        }
+    const int index = d->mAttributeIndex.find(d->mAttributes, name);
+    if (index >= 0) {
+        return d->mAttributes.at(index);
+    }
+    if (parseLazyComponent(AttributeComponent, name)) {
+        return findAttribute(name);
     }
     qDebug() << "Attribute not found:" << name.nameSpace() << name.localName();
     return Attribute();
 }
 
-AttributeGroup Parser::findAttributeGroup(const QName &name) const
+AttributeGroup Parser::findAttributeGroup(const QName &name)
 {
-    for (const AttributeGroup &g : std::as_const(d->mAttributeGroups)) {
-        if (g.nameSpace() == name.nameSpace() && g.name() == name.localName()) {
-            return g;
-        }
+    const int index = d->mAttributeGroupIndex.find(d->mAttributeGroups, name);
+    if (index >= 0) {
+        return d->mAttributeGroups.at(index);
+    }
+    if (parseLazyComponent(AttributeGroupComponent, name)) {
+        return findAttributeGroup(name);
     }
     qDebug() << "Attribute Group not found:" << name.nameSpace() << name.localName();
     return AttributeGroup();
@@ -1282,11 +1585,13 @@ AttributeGroup Parser::findAttributeGroup(const QName &name) const
 
 bool Parser::resolveForwardDeclarations()
 {
+    Arena::Scope arenaScope(d->activeArena());
     const QName any(QLatin1String("http://www.w3.org/2001/XMLSchema"), QLatin1String("any"));
     // const QName anyType( "http://www.w3.org/2001/XMLSchema", "anyType" );
     for (int i = 0; i < d->mComplexTypes.count(); ++i) {
 
-        ComplexType &complexType = d->mComplexTypes[i];
+        // Work on a copy, resolving may parse lazy components and append complex types
+        ComplexType complexType = d->mComplexTypes.at(i);
 
         Element::List elements = complexType.elements();
         // qDebug() << i << "looking at" << complexType << " " << elements.count() << "elements";
@@ -1359,7 +1664,7 @@ bool Parser::resolveForwardDeclarations()
                 Attribute refAttribute = findAttribute(attribute.reference());
                 if (refAttribute.qualifiedName().isEmpty()) {
                     qWarning("ERROR in %s: resolving attribute ref to '%s': not found!",
-                             qPrintable(d->mComplexTypes[i].qualifiedName().qname()),
+                             qPrintable(complexType.qualifiedName().qname()),
                              qPrintable(attribute.reference().qname()));
                     if (qEnvironmentVariableIsSet("LIBKODE_VERBOSE_ERRORS")) {
                         d->mAttributes.dump();
@@ -1387,10 +1692,286 @@ bool Parser::resolveForwardDeclarations()
         // groups were resolved, don't do it again if resolveForwardDeclarations() is called again
         complexType.setAttributeGroups(AttributeGroup::List());
         complexType.setAttributes(attributes);
+        d->replaceComplexType(i, complexType);
+    }
+    return true;
+}
+
+void Parser::setLazyParsing(bool lazy)
+{
+    d->mLazyParsing = lazy;
+}
+
+bool Parser::lazyParsing() const
+{
+    return d->mLazyParsing;
+}
+
+bool Parser::addLazyComponent(ParserContext *context, const QDomElement &element)
+{
+    const QString localName = QName(element.tagName()).localName();
+    ComponentKind kind;
+    if (localName == QLatin1String("element")) {
+        kind = ElementComponent;
+    } else if (localName == QLatin1String("complexType")
+               || localName == QLatin1String("simpleType")) {
+        kind = TypeComponent;
+    } else if (localName == QLatin1String("attribute")) {
+        kind = AttributeComponent;
+    } else if (localName == QLatin1String("group")) {
+        kind = GroupComponent;
+    } else if (localName == QLatin1String("attributeGroup")) {
+        kind = AttributeGroupComponent;
+    } else {
+        return false;
+    }
+    if (!element.hasAttribute(QLatin1String("name"))) {
+        return false;
+    }
+
+    const QName name(d->mNameSpace, element.attribute(QLatin1String("name")));
+    QHash<QName, Private::LazyComponent> &components = d->lazyComponents(kind);
+    if (components.contains(name)) {
+        return true; // the first declaration wins, as with addGlobalElement()
     }
+    Private::LazyComponent component;
+    QDomDocument fragment;
+    QDomElement copy = fragment.importNode(element, true).toElement();
+    for (QDomNode node = element.parentNode(); node.isElement(); node = node.parentNode()) {
+        const QDomNamedNodeMap attributes = node.attributes();
+        for (int i = 0; i < attributes.count(); ++i) {
+            const QDomAttr attribute = attributes.item(i).toAttr();
+            const QString attributeName = attribute.name();
+            if ((attributeName == QLatin1String("xmlns")
+                 || attributeName.startsWith(QLatin1String("xmlns:")))
+                && !copy.hasAttribute(attributeName)) {
+                copy.setAttribute(attributeName, attribute.value());
+            }
+        }
+    }
+    fragment.appendChild(copy);
+    component.source = fragment.toByteArray(-1);
+    component.nameSpace = d->mNameSpace;
+    component.defaultQualifiedElements = d->mDefaultQualifiedElements;
+    component.defaultQualifiedAttributes = d->mDefaultQualifiedAttributes;
+    component.messageHandler = context->messageHandler();
+    component.documentBaseUrl = context->documentBaseUrl();
+    components.insert(name, component);
+
+    // Remember the relations which can't be found from the used component, the
+    // component may declare the prefixes it uses itself
+    NSManager namespaceManager(context, element);
+    auto resolvedName = [context](const QString &value) {
+        QName qualifiedName(value.trimmed());
+        qualifiedName.setNameSpace(context->namespaceManager()->uri(qualifiedName.prefix()));
+        return qualifiedName;
+    };
+    if (kind == ElementComponent && element.hasAttribute(QLatin1String("substitutionGroup"))) {
+        d->mLazySubstitutions.insert(
+                resolvedName(element.attribute(QLatin1String("substitutionGroup"))), name);
+    } else if (localName == QLatin1String("complexType")) {
+        for (QDomElement content = element.firstChildElement(); !content.isNull();
+             content = content.nextSiblingElement()) {
+            const QString contentName = QName(content.tagName()).localName();
+            if (contentName != QLatin1String("complexContent")
+                && contentName != QLatin1String("simpleContent")) {
+                continue;
+            }
+            NSManager namespaceManager(context, content);
+            for (QDomElement derivation = content.firstChildElement(); !derivation.isNull();
+                 derivation = derivation.nextSiblingElement()) {
+                if (derivation.hasAttribute(QLatin1String("base"))) {
+                    NSManager derivationNamespaceManager(context, derivation);
+                    d->mLazyDerivedTypes.insert(
+                            resolvedName(derivation.attribute(QLatin1String("base"))), name);
+                }
+            }
+        }
+    }
+    return true;
+}
+
+bool Parser::parseLazyComponent(ComponentKind kind, const QName &name)
+{
+    Arena::Scope arenaScope(d->activeArena());
+    QHash<QName, Private::LazyComponent> &components = d->lazyComponents(kind);
+    const auto it = components.find(name);
+    if (it == components.end()) {
+        return false;
+    }
+    // Removed before parsing, so that components using each other are parsed once
+    const Private::LazyComponent component = it.value();
+    components.erase(it);
+
+    // The element carries the namespace declarations which were in its scope
+    QDomDocument fragment;
+    fragment.setContent(component.source);
+    const QDomElement element = fragment.documentElement();
+    NSManager schemaNamespaceManager;
+    MessageHandler defaultMessageHandler;
+    ParserContext context;
+    context.setNamespaceManager(&schemaNamespaceManager);
+    context.setMessageHandler(component.messageHandler ? component.messageHandler
+                                                       : &defaultMessageHandler);
+    context.setDocumentBaseUrl(component.documentBaseUrl);
+
+    const QString oldNamespace = d->mNameSpace;
+    const bool oldDefaultQualifiedElements = d->mDefaultQualifiedElements;
+    const bool oldDefaultQualifiedAttributes = d->mDefaultQualifiedAttributes;
+    d->mNameSpace = component.nameSpace;
+    d->mDefaultQualifiedElements = component.defaultQualifiedElements;
+    d->mDefaultQualifiedAttributes = component.defaultQualifiedAttributes;
+
+    {
+        NSManager namespaceManager(&context, element);
+        const QString localName = QName(element.tagName()).localName();
+        if (localName == QLatin1String("element")) {
+            if (element.hasAttribute(QLatin1String("substitutionGroup"))
+                && element.hasAttribute(QLatin1String("type"))) {
+                // parseElement() marks the head element and both types
+                QName head(element.attribute(QLatin1String("substitutionGroup")));
+                head.setNameSpace(context.namespaceManager()->uri(head.prefix()));
+                parseLazyComponent(ElementComponent, head);
+                const int headIndex = d->mElementIndex.find(d->mElements, head);
+                if (headIndex >= 0) {
+                    parseLazyComponent(TypeComponent, d->mElements.at(headIndex).type());
+                }
+                QName typeName(element.attribute(QLatin1String("type")).trimmed());
+                typeName.setNameSpace(context.namespaceManager()->uri(typeName.prefix()));
+                parseLazyComponent(TypeComponent, typeName);
+            }
+            addGlobalElement(parseElement(&context, element, d->mNameSpace, element));
+        } else if (localName == QLatin1String("complexType")) {
+            ComplexType ct = parseComplexType(&context, element);
+            for (const auto &subelem : ct.elements()) {
+                d->mElements.append(subelem);
+            }
+            d->appendComplexType(ct);
+        } else if (localName == QLatin1String("simpleType")) {
+            d->mSimpleTypes.append(parseSimpleType(&context, element));
+        } else if (localName == QLatin1String("attribute")) {
+            addGlobalAttribute(parseAttribute(&context, element, d->mNameSpace));
+        } else if (localName == QLatin1String("attributeGroup")) {
+            d->mAttributeGroups.append(parseAttributeGroup(&context, element, d->mNameSpace));
+        } else if (localName == QLatin1String("group")) {
+            d->mGroups.append(parseGroup(&context, element, d->mNameSpace));
+        }
+    }
+
+    d->mNameSpace = oldNamespace;
+    d->mDefaultQualifiedElements = oldDefaultQualifiedElements;
+    d->mDefaultQualifiedAttributes = oldDefaultQualifiedAttributes;
     return true;
 }
 
+bool Parser::resolveLazyComponents(const QName::List &roots)
+{
+    Arena::Scope arenaScope(d->activeArena());
+    for (const QName &root : roots) {
+        parseLazyComponent(ElementComponent, root);
+        parseLazyComponent(TypeComponent, root);
+    }
+
+    auto parseType = [this](const QName &name) {
+        if (!name.isEmpty()) {
+            parseLazyComponent(TypeComponent, name);
+        }
+    };
+    auto parseElementUses = [this, &parseType](const Element &element) {
+        if (!element.reference().isEmpty()) {
+            parseLazyComponent(ElementComponent, element.reference());
+        }
+        parseType(element.type());
+    };
+    auto parseAttributeUses = [this, &parseType](const Attribute &attribute) {
+        if (!attribute.reference().isEmpty()) {
+            parseLazyComponent(AttributeComponent, attribute.reference());
+        }
+        parseType(attribute.type());
+    };
+
+    // Parse what the parsed components use, until nothing is added. The lists
+    // grow while doing so, so the components are copied.
+    int elementCount = 0;
+    int complexTypeCount = 0;
+    int simpleTypeCount = 0;
+    int attributeCount = 0;
+    int groupCount = 0;
+    int attributeGroupCount = 0;
+    bool changed = true;
+    while (changed) {
+        changed = false;
+        while (elementCount < d->mElements.count()) {
+            changed = true;
+            const Element element = d->mElements.at(elementCount++);
+            parseElementUses(element);
+            const QName::List substitutions =
+                    d->mLazySubstitutions.values(element.qualifiedName());
+            for (const QName &substitution : substitutions) {
+                parseLazyComponent(ElementComponent, substitution);
+            }
+        }
+        while (complexTypeCount < d->mComplexTypes.count()) {
+            changed = true;
+            const ComplexType type = d->mComplexTypes.at(complexTypeCount++);
+            parseType(type.baseTypeName());
+            parseType(type.arrayType());
+            const Element::List elements = type.elements();
+            for (const Element &element : elements) {
+                parseElementUses(element);
+            }
+            const Group::List groups = type.groups();
+            for (const Group &group : groups) {
+                if (!group.reference().isEmpty()) {
+                    parseLazyComponent(GroupComponent, group.reference());
+                }
+            }
+            const Attribute::List attributes = type.attributes();
+            for (const Attribute &attribute : attributes) {
+                parseAttributeUses(attribute);
+            }
+            const AttributeGroup::List attributeGroups = type.attributeGroups();
+            for (const AttributeGroup &group : attributeGroups) {
+                if (!group.reference().isEmpty()) {
+                    parseLazyComponent(AttributeGroupComponent, group.reference());
+                }
+            }
+            const QName::List derivedTypes = d->mLazyDerivedTypes.values(type.qualifiedName());
+            for (const QName &derivedType : derivedTypes) {
+                parseType(derivedType);
+            }
+        }
+        while (simpleTypeCount < d->mSimpleTypes.count()) {
+            changed = true;
+            const SimpleType type = d->mSimpleTypes.at(simpleTypeCount++);
+            parseType(type.baseTypeName());
+            parseType(type.listTypeName());
+        }
+        while (attributeCount < d->mAttributes.count()) {
+            changed = true;
+            const Attribute attribute = d->mAttributes.at(attributeCount++);
+            parseAttributeUses(attribute);
+        }
+        while (groupCount < d->mGroups.count()) {
+            changed = true;
+            const Element::List elements = d->mGroups.at(groupCount++).elements();
+            for (const Element &element : elements) {
+                parseElementUses(element);
+            }
+        }
+        while (attributeGroupCount < d->mAttributeGroups.count()) {
+            changed = true;
+            const Attribute::List attributes =
+                    d->mAttributeGroups.at(attributeGroupCount++).attributes();
+            for (const Attribute &attribute : attributes) {
+                parseAttributeUses(attribute);
+            }
+        }
+    }
+
+    return resolveForwardDeclarations();
+}
+
 Types Parser::types() const
 {
     Types types;
@@ -1407,6 +1988,54 @@ Types Parser::types() const
     return types;
 }
 
+MemoryUsage Parser::memoryUsage() const
+{
+    MemoryUsage usage;
+    usage.addTypes(types());
+    for (const Group &group : std::as_const(d->mGroups)) {
+        usage.addElements(group.elements());
+    }
+    for (const AttributeGroup &group : std::as_const(d->mAttributeGroups)) {
+        usage.addAttributes(group.attributes());
+    }
+    usage.addAnnotations(d->mAnnotations);
+    return usage;
+}
+
+QStringList Parser::sourceFiles() const
+{
+    return d->mSourceFiles;
+}
+
+bool Parser::writeBundle(const QString &fileName, SchemaBundle::Compression compression,
+                         QString *errorString) const
+{
+    // Local files are stored relative to the bundle, so they can be deployed together
+    const QDir bundleDir = QFileInfo(fileName).absoluteDir();
+    QMap<QUrl, QByteArray> documents;
+    for (const QUrl &url : std::as_const(d->mLoadedDocuments)) {
+        QByteArray data;
+        if (!d->readDocument(url, &data, nullptr)) {
+            if (errorString) {
+                *errorString = QStringLiteral("Unable to read '%1'").arg(url.toString());
+            }
+            return false;
+        }
+        QUrl key = url.adjusted(QUrl::NormalizePathSegments);
+        if (url.isLocalFile()) {
+            QString path = bundleDir.relativeFilePath(url.toLocalFile());
+            // Keep a colon in the first segment from being taken for a scheme
+            if (path.indexOf(QLatin1Char(':')) >= 0) {
+                path.prepend(QLatin1String("./"));
+            }
+            key = QUrl();
+            key.setPath(path);
+        }
+        documents.insert(key, data);
+    }
+    return SchemaBundle::write(fileName, documents, compression, errorString);
+}
+
 Annotation::List Parser::annotations() const
 {
     return d->mAnnotations;
@@ -1444,6 +2073,10 @@ bool Parser::parse(ParserContext *context, QIODevice *sourceDevice)
 
 bool Parser::parseFile(ParserContext *context, QFile &file)
 {
+    d->addSourceFile(file.fileName());
+    if (!file.fileName().startsWith(QLatin1Char(':'))) {
+        d->addLoadedDocument(QUrl::fromLocalFile(QFileInfo(file).absoluteFilePath()));
+    }
     return parse(context, &file);
 }
 
@@ -1454,4 +2087,106 @@ bool Parser::parseString(ParserContext *context, const QByteArray &data)
     return parse(context, &buffer);
 }
 
+namespace {
+class FunctionRunnable : public QRunnable
+{
+public:
+    explicit FunctionRunnable(const std::function<void()> &function) : mFunction(function) {}
+    void run() override { mFunction(); }
+
+private:
+    std::function<void()> mFunction;
+};
+}
+
+QFuture<Types> Parser::parseAsync(const QUrl &url, MessageHandler *messageHandler) const
+{
+    QFutureInterface<Types> future;
+    future.reportStarted();
+
+    // Runs after the fetcher filled the cache of FileProvider. What the fetcher could not
+    // download is not downloaded again, as that would need a nested event loop.
+    Parser parser(*this);
+    parser.d->mDownloadsEnabled = false;
+    const std::function<void(const QStringList &)> parse =
+            [parser, url, future, messageHandler](const QStringList &downloadErrors) mutable {
+                if (future.isCanceled()) {
+                    future.reportFinished();
+                    return;
+                }
+
+                NSManager namespaceManager;
+                MessageHandler defaultMessageHandler;
+                ParserContext context;
+                context.setNamespaceManager(&namespaceManager);
+                context.setMessageHandler(messageHandler ? messageHandler
+                                                         : &defaultMessageHandler);
+                context.setDocumentBaseUrlFromFileUrl(url);
+                for (const QString &error : downloadErrors)
+                    context.messageHandler()->warning(error);
+
+                FileProvider provider(parser.d->mUseLocalFilesOnly, parser.d->mImportPathList,
+                                      parser.d->mLocalSchemas);
+                provider.setCatalog(parser.d->mCatalog);
+                provider.setDownloadsEnabled(false);
+                QString fileName;
+                bool ok = provider.get(url, fileName);
+                if (ok) {
+                    QFile file(fileName);
+                    ok = file.open(QIODevice::ReadOnly);
+                    if (ok) {
+                        if (provider.isTemporary()) {
+                            parser.d->addLoadedDocument(url);
+                            ok = parser.parse(&context, &file);
+                        } else {
+                            ok = parser.parseFile(&context, file);
+                        }
+                    }
+                    if (!ok)
+                        context.messageHandler()->error(
+                                QStringLiteral("Can't parse schema %1").arg(url.toString()));
+                } else {
+                    context.messageHandler()->error(
+                            QStringLiteral("Can't load schema %1").arg(url.toString()));
+                }
+                if (ok && parser.resolveForwardDeclarations()) {
+                    future.reportResult(parser.types());
+                }
+                future.reportFinished();
+            };
+    const auto startParsing = [parse](const QStringList &downloadErrors) {
+        QThreadPool::globalInstance()->start(
+                new FunctionRunnable([parse, downloadErrors]() { parse(downloadErrors); }));
+    };
+
+    if (d->mUseLocalFilesOnly) {
+        startParsing(QStringList());
+        return future.future();
+    }
+
+    auto *fetcher = new SchemaFetcher(d->mImportPathList, d->mLocalSchemas);
+    fetcher->setCatalog(d->mCatalog);
+    auto *watcher = new QFutureWatcher<Types>(fetcher);
+    QObject::connect(watcher, &QFutureWatcherBase::canceled, fetcher, &SchemaFetcher::cancel);
+    watcher->setFuture(future.future());
+    QObject::connect(fetcher, &SchemaFetcher::progress, fetcher,
+                     [future](int done, int total) mutable {
+                         future.setProgressRange(0, total);
+                         future.setProgressValue(done);
+                     });
+    QObject::connect(fetcher, &SchemaFetcher::finished, fetcher,
+                     [fetcher, future, startParsing](bool) mutable {
+                         fetcher->deleteLater();
+                         if (fetcher->isCanceled() || future.isCanceled()) {
+                             future.reportFinished();
+                             return;
+                         }
+                         // Failed imports are only warned about, like when parsing synchronously
+                         startParsing(fetcher->errors());
+                     });
+    fetcher->fetch(url);
+
+    return future.future();
+}
+
 } // end namespace XSD
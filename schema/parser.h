@@ -25,19 +25,24 @@
 #define SCHEMA_PARSER_H
 
 #include <QDomElement>
+#include <QFuture>
 #include <QList>
 #include <QLoggingCategory>
 #include <QFile>
 
 #include "types.h"
 #include "annotation.h"
+#include "arena.h"
+#include <common/schemabundle.h>
 #include <kode_export.h>
 
 QT_BEGIN_NAMESPACE
 class QUrl;
 QT_END_NAMESPACE
 
+class MessageHandler;
 class ParserContext;
+class XmlCatalog;
 
 Q_DECLARE_LOGGING_CATEGORY(parser)
 
@@ -67,14 +72,98 @@ public:
      */
     void setLocalSchemas(const QMap<QUrl, QString> &localSchemas);
 
+    /**
+     * Configures the parser to map the locations of imported and included schemas
+     * through an OASIS XML catalog, before the local schemas and the import paths.
+     */
+    void setCatalog(const XmlCatalog &catalog);
+
     Types types() const;
 
+    /**
+     * Returns an estimate of the memory held by the parsed components,
+     * including groups, attribute groups and the schema annotations.
+     */
+    MemoryUsage memoryUsage() const;
+
+    /**
+     * Sets whether the global components of the schemas parsed afterwards are
+     * only indexed by name and parsed when they are first used, either by
+     * resolveLazyComponents() or when references to them are resolved.
+     * Imports and includes are still followed. Disabled by default.
+     * The messages about components parsed later go to the message handler of
+     * the context they were found with, which has to stay alive until then.
+     */
+    void setLazyParsing(bool lazy);
+    bool lazyParsing() const;
+
+    /**
+     * Parses the lazily indexed elements and types named in @p roots and
+     * all components they use, then resolves their references.
+     * Afterwards types() contains the parsed components.
+     * @return false if one of references has no declaration (error)
+     */
+    bool resolveLazyComponents(const QName::List &roots);
+
+    /**
+     * Sets whether the private data of the parsed model is allocated in an
+     * arena owned by the parser, see Arena. This replaces many small heap
+     * allocations by a few large blocks, which are released together once
+     * the parser is cleared or destroyed and all objects it parsed are gone.
+     * The arena is active while parsing and resolving, where the temporaries
+     * of parsing reuse the memory of each other; the copies returned by getters
+     * use the heap. Disabled by default.
+     */
+    void setUseArena(bool useArena);
+    bool useArena() const;
+
+    /**
+     * Returns the arena of the parser, to measure the memory it holds.
+     */
+    Arena arena() const;
+
+    /**
+     * Returns the absolute paths of the local files which were parsed, including
+     * all imported and included schemas. Downloaded schemas and schemas from the
+     * Qt resource system are not part of the list.
+     * This can be used to write the dependencies of generated files.
+     */
+    QStringList sourceFiles() const;
+
+    /**
+     * Writes the schema passed to parseFile() or parseAsync() and all imported
+     * and included schemas to a SchemaBundle. Downloaded schemas are stored
+     * under their URL, local files relative to @p fileName, so the bundle stays
+     * valid when it is moved together with the schemas. Once the bundle is
+     * mounted with FileProvider::mountBundle(), parsing the same schema again
+     * reads them from the bundle instead of the network or the import paths.
+     * Schemas passed to parseString() have no location and are not bundled.
+     */
+    bool writeBundle(const QString &fileName,
+                     SchemaBundle::Compression compression = SchemaBundle::Uncompressed,
+                     QString *errorString = nullptr) const;
+
     Annotation::List annotations() const;
 
     bool parseString(ParserContext *context, const QByteArray &data);
     bool parseFile(ParserContext *context, QFile &file);
     bool parseSchemaTag(ParserContext *context, const QDomElement &element);
 
+    /**
+     * Parses the schema at @p url without blocking the calling thread.
+     * The schema and the schemas it imports or includes are downloaded by a
+     * SchemaFetcher in the calling thread, which needs a running event loop.
+     * A copy of this parser then parses them in a thread of the global thread
+     * pool and resolves the forward declarations.
+     * The future reports the download progress and can be canceled. It has no
+     * result if the schema could not be parsed. This parser is not modified
+     * and can be destroyed before the future finishes.
+     * The failed downloads, as warnings, and the warnings and errors of parsing
+     * are reported to @p messageHandler, from the parsing thread. It must live
+     * until the future finished. Without one, they are printed as warnings.
+     */
+    QFuture<Types> parseAsync(const QUrl &url, MessageHandler *messageHandler = nullptr) const;
+
     QString targetNamespace() const;
 
     /**
@@ -89,8 +178,21 @@ public:
     static QString schemaUri();
 
 private:
+    enum ComponentKind {
+        ElementComponent,
+        TypeComponent,
+        AttributeComponent,
+        GroupComponent,
+        AttributeGroupComponent
+    };
+
     bool parse(ParserContext *context, QIODevice *sourceDevice);
 
+    // Indexes a global component in lazy mode, returns false if it has to be parsed now
+    bool addLazyComponent(ParserContext *context, const QDomElement &element);
+    // Parses the indexed component, returns false if there is none (anymore)
+    bool parseLazyComponent(ComponentKind kind, const QName &name);
+
     void parseImport(ParserContext *context, const QDomElement &);
     /**
      * @brief Parse include element.
@@ -139,10 +241,10 @@ private:
     bool importOrIncludeSchema(ParserContext *context, const QDomElement &element,
                                const QUrl &schemaLocation);
 
-    Element findElement(const QName &name) const;
-    Group findGroup(const QName &name) const;
-    Attribute findAttribute(const QName &name) const;
-    AttributeGroup findAttributeGroup(const QName &name) const;
+    Element findElement(const QName &name);
+    Group findGroup(const QName &name);
+    Attribute findAttribute(const QName &name);
+    AttributeGroup findAttributeGroup(const QName &name);
     void init(ParserContext *context);
     void clear();
 
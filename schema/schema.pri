@@ -2,28 +2,40 @@ QT += xml
 
 HEADERS += \
   $$PWD/annotation.h \
+  $$PWD/arena.h \
   $$PWD/attribute.h \
   $$PWD/attributegroup.h \
+  $$PWD/builtintypes.h \
   $$PWD/complextype.h \
   $$PWD/compositor.h \
   $$PWD/element.h \
   $$PWD/group.h \
+  $$PWD/instancevalidator.h \
+  $$PWD/memoryusage.h \
   $$PWD/parser.h \
   $$PWD/simpletype.h \
+  $$PWD/simpletypevalidator.h \
   $$PWD/types.h \
+  $$PWD/typesregistry.h \
   $$PWD/xmlelement.h \
   $$PWD/xsdtype.h
 
 SOURCES += \
   $$PWD/annotation.cpp \
+  $$PWD/arena.cpp \
   $$PWD/attribute.cpp \
   $$PWD/attributegroup.cpp \
+  $$PWD/builtintypes.cpp \
   $$PWD/complextype.cpp \
   $$PWD/compositor.cpp \
   $$PWD/element.cpp \
   $$PWD/group.cpp \
+  $$PWD/instancevalidator.cpp \
+  $$PWD/memoryusage.cpp \
   $$PWD/parser.cpp \
   $$PWD/simpletype.cpp \
+  $$PWD/simpletypevalidator.cpp \
   $$PWD/types.cpp \
+  $$PWD/typesregistry.cpp \
   $$PWD/xmlelement.cpp \
   $$PWD/xsdtype.cpp
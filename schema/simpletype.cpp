@@ -21,11 +21,12 @@
  */
 
 #include "simpletype.h"
+#include "arena.h"
 #include <QDebug>
 
 namespace XSD {
 
-class SimpleType::Private
+class SimpleType::Private : public ArenaAllocated
 {
 public:
     Private() : mFacetId(NONE), mAnonymous(false), mSubType(TypeRestriction) {}
@@ -53,6 +54,8 @@ public:
         {
             ValueRange() : maxinc(-1), mininc(-1), maxex(-1), minex(-1) {}
             int maxinc, mininc, maxex, minex;
+            // The values as written, the numbers above are truncated
+            QString maxincValue, minincValue, maxexValue, minexValue;
         } valRange;
         int tot;
         int frac;
@@ -201,12 +204,16 @@ void SimpleType::setFacetValue(FacetType ft, const QString &value)
 
         if (ft == MAXEX) {
             d->mFacetValue.valRange.maxex = number;
+            d->mFacetValue.valRange.maxexValue = value;
         } else if (ft == MAXINC) {
             d->mFacetValue.valRange.maxinc = number;
+            d->mFacetValue.valRange.maxincValue = value;
         } else if (ft == MININC) {
             d->mFacetValue.valRange.mininc = number;
+            d->mFacetValue.valRange.minincValue = value;
         } else if (ft == MINEX) {
             d->mFacetValue.valRange.minex = number;
+            d->mFacetValue.valRange.minexValue = value;
         } else if (ft == LENGTH) {
             d->mFacetValue.length = number;
         } else if (ft == MINLEN) {
@@ -271,6 +278,22 @@ int SimpleType::facetMaximumExclusive() const
     return d->mFacetValue.valRange.maxex;
 }
 
+QString SimpleType::facetRangeValue(FacetType ft) const
+{
+    switch (ft) {
+    case MAXINC:
+        return d->mFacetValue.valRange.maxincValue;
+    case MININC:
+        return d->mFacetValue.valRange.minincValue;
+    case MAXEX:
+        return d->mFacetValue.valRange.maxexValue;
+    case MINEX:
+        return d->mFacetValue.valRange.minexValue;
+    default:
+        return QString();
+    }
+}
+
 int SimpleType::facetTotalDigits() const
 {
     return d->mFacetValue.tot;
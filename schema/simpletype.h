@@ -97,6 +97,9 @@ public:
     int facetMaximumInclusive() const;
     int facetMinimumExclusive() const;
     int facetMaximumExclusive() const;
+    // The value of the range facet @p ft as written in the schema, the getters
+    // above truncate it to an int
+    QString facetRangeValue(FacetType ft) const;
     int facetTotalDigits() const;
     int facetFractionDigits() const;
     QString facetPattern() const;
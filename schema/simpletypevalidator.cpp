@@ -0,0 +1,541 @@
+/*
+    This file is part of KDE Schema Parser
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Library General Public
+    License as published by the Free Software Foundation; either
+    version 2 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Library General Public License for more details.
+
+    You should have received a copy of the GNU Library General Public License
+    along with this library; see the file COPYING.LIB.  If not, write to
+    the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+    Boston, MA 02110-1301, USA.
+ */
+
+#include "simpletypevalidator.h"
+#include "builtintypes.h"
+
+#include <QDebug>
+#include <QRegularExpression>
+#include <QSet>
+#include <QVector>
+
+#include <cmath>
+
+namespace XSD {
+
+static const QString XMLSchemaURI(QLatin1String("http://www.w3.org/2001/XMLSchema"));
+
+namespace {
+
+// A bound of a range facet, compared exactly for decimals and integers
+struct Bound
+{
+    QString lexical;
+    double number = 0; // for float and double
+};
+
+// The facets of one step of the derivation chain
+struct Facets
+{
+    int mask = SimpleType::NONE;
+    int length = 0;
+    int minLength = 0;
+    int maxLength = 0;
+    Bound minInclusive;
+    Bound maxInclusive;
+    Bound minExclusive;
+    Bound maxExclusive;
+    int totalDigits = 0;
+    int fractionDigits = 0;
+    QRegularExpression pattern;
+    QSet<QString> enums;
+};
+
+// The value space the range and digit facets are checked in
+enum NumberKind { NotNumeric, DecimalNumber, FloatingPoint };
+
+// Result of a comparison involving NaN
+const int incomparable = 2;
+
+NumberKind numberKind(BuiltinTypes::Type type)
+{
+    switch (type) {
+    case BuiltinTypes::Float:
+    case BuiltinTypes::Double:
+        return FloatingPoint;
+    case BuiltinTypes::Decimal:
+    case BuiltinTypes::Integer:
+    case BuiltinTypes::NonPositiveInteger:
+    case BuiltinTypes::NegativeInteger:
+    case BuiltinTypes::Long:
+    case BuiltinTypes::Int:
+    case BuiltinTypes::Short:
+    case BuiltinTypes::Byte:
+    case BuiltinTypes::NonNegativeInteger:
+    case BuiltinTypes::PositiveInteger:
+    case BuiltinTypes::UnsignedLong:
+    case BuiltinTypes::UnsignedInt:
+    case BuiltinTypes::UnsignedShort:
+    case BuiltinTypes::UnsignedByte:
+        return DecimalNumber;
+    default:
+        return NotNumeric;
+    }
+}
+
+// The significant digits of a valid decimal, without leading and trailing zeros
+struct DecimalDigits
+{
+    explicit DecimalDigits(const QString &value) : text(value)
+    {
+        int i = 0;
+        if (i < text.length() && (text.at(i) == QLatin1Char('-') || text.at(i) == QLatin1Char('+')))
+            negative = text.at(i++) == QLatin1Char('-');
+        while (i < text.length() && text.at(i) == QLatin1Char('0'))
+            ++i;
+        integerBegin = i;
+        while (i < text.length() && text.at(i) != QLatin1Char('.'))
+            ++i;
+        integerEnd = i;
+        fractionBegin = i + 1;
+        fractionEnd = text.length();
+        while (fractionEnd > fractionBegin && text.at(fractionEnd - 1) == QLatin1Char('0'))
+            --fractionEnd;
+        fractionEnd = qMax(fractionEnd, fractionBegin);
+        if (integerBegin == integerEnd && fractionBegin == fractionEnd)
+            negative = false; // -0
+    }
+
+    QChar fractionDigit(int index) const
+    {
+        return fractionBegin + index < fractionEnd ? text.at(fractionBegin + index)
+                                                   : QLatin1Char('0');
+    }
+
+    const QString &text;
+    bool negative = false;
+    int integerBegin = 0;
+    int integerEnd = 0;
+    int fractionBegin = 0;
+    int fractionEnd = 0;
+};
+
+// Compares two valid decimals without converting them to a binary number
+int compareDecimals(const QString &a, const QString &b)
+{
+    const DecimalDigits x(a);
+    const DecimalDigits y(b);
+    if (x.negative != y.negative)
+        return x.negative ? -1 : 1;
+    const int sign = x.negative ? -1 : 1;
+    const int xIntegerLength = x.integerEnd - x.integerBegin;
+    const int yIntegerLength = y.integerEnd - y.integerBegin;
+    if (xIntegerLength != yIntegerLength)
+        return xIntegerLength < yIntegerLength ? -sign : sign;
+    for (int i = 0; i < xIntegerLength; ++i) {
+        const QChar c = a.at(x.integerBegin + i);
+        const QChar d = b.at(y.integerBegin + i);
+        if (c != d)
+            return c < d ? -sign : sign;
+    }
+    const int fractionLength =
+            qMax(x.fractionEnd - x.fractionBegin, y.fractionEnd - y.fractionBegin);
+    for (int i = 0; i < fractionLength; ++i) {
+        const QChar c = x.fractionDigit(i);
+        const QChar d = y.fractionDigit(i);
+        if (c != d)
+            return c < d ? -sign : sign;
+    }
+    return 0;
+}
+
+// Number of octets a valid base64Binary value decodes to
+int base64Length(const QString &value)
+{
+    int characters = 0;
+    for (const QChar c : value) {
+        if (c != QLatin1Char(' ') && c != QLatin1Char('='))
+            ++characters;
+    }
+    return characters * 3 / 4;
+}
+
+int compareDoubles(double a, double b)
+{
+    if (std::isnan(a) || std::isnan(b))
+        return incomparable;
+    return a < b ? -1 : (a > b ? 1 : 0);
+}
+
+// Translates the XML schema specific escapes into Perl syntax and anchors the pattern.
+// Within a character class the name character escapes expand to their ranges, the
+// negated ones to the ranges of all other characters.
+QString compilePattern(const QString &pattern)
+{
+    QString result;
+    result.reserve(pattern.length() + 16);
+    int classDepth = 0;
+    for (int i = 0; i < pattern.length(); ++i) {
+        const QChar c = pattern.at(i);
+        if (c == QLatin1Char('\\') && i + 1 < pattern.length()) {
+            const QChar escaped = pattern.at(++i);
+            if (escaped == QLatin1Char('i'))
+                result += classDepth ? QLatin1String("_:A-Za-z") : QLatin1String("[_:A-Za-z]");
+            else if (escaped == QLatin1Char('I'))
+                result += classDepth ? QLatin1String("\\x{0}-\\x{39}\\x{3b}-\\x{40}\\x{5b}-\\x{5e}"
+                                                     "\\x{60}\\x{7b}-\\x{10ffff}")
+                                     : QLatin1String("[^_:A-Za-z]");
+            else if (escaped == QLatin1Char('c'))
+                result += classDepth ? QLatin1String("\\-._:A-Za-z0-9")
+                                     : QLatin1String("[-._:A-Za-z0-9]");
+            else if (escaped == QLatin1Char('C'))
+                result += classDepth ? QLatin1String("\\x{0}-\\x{2c}\\x{3b}-\\x{40}\\x{5b}-\\x{5e}"
+                                                     "\\x{60}\\x{7b}-\\x{10ffff}")
+                                     : QLatin1String("[^-._:A-Za-z0-9]");
+            else
+                result += QString(c) + escaped;
+        } else {
+            if (c == QLatin1Char('['))
+                ++classDepth;
+            else if (c == QLatin1Char(']') && classDepth > 0)
+                --classDepth;
+            result += c;
+        }
+    }
+    return QLatin1String("\\A(?:") + result + QLatin1String(")\\z");
+}
+
+// Counts the significant digits, and the ones after the decimal point
+void countDigits(const QString &value, int *totalDigits, int *fractionDigits)
+{
+    int total = 0;
+    int fraction = 0;
+    int trailingZeros = 0;
+    bool leading = true;
+    bool afterPoint = false;
+    for (const QChar c : value) {
+        if (c == QLatin1Char('.')) {
+            afterPoint = true;
+        } else if (c.isDigit()) {
+            if (leading && c == QLatin1Char('0') && !afterPoint)
+                continue;
+            leading = false;
+            ++total;
+            if (afterPoint) {
+                ++fraction;
+                trailingZeros = c == QLatin1Char('0') ? trailingZeros + 1 : 0;
+            }
+        }
+    }
+    *totalDigits = total - trailingZeros;
+    *fractionDigits = fraction - trailingZeros;
+}
+
+}
+
+class SimpleTypeValidator::Private
+{
+public:
+    QString normalized(const QString &value) const;
+    bool validateValue(const QString &value, QString *errorMessage) const;
+    int compare(const QString &value, double number, const Bound &bound) const;
+
+    QVector<Facets> mFacets; // most derived type first
+    SimpleType::WhiteSpaceType mWhiteSpace = SimpleType::PRESERVE;
+    QString mBuiltinType;
+    BuiltinTypes::Type mBuiltin = BuiltinTypes::Unknown;
+    NumberKind mNumberKind = NotNumeric;
+    bool mUnion = false;
+    bool mCountDigits = false;
+    std::shared_ptr<const SimpleTypeValidator> mItemValidator; // for lists
+};
+
+QString SimpleTypeValidator::Private::normalized(const QString &value) const
+{
+    if (mWhiteSpace == SimpleType::PRESERVE)
+        return value;
+    if (mWhiteSpace == SimpleType::COLLAPSE)
+        return value.simplified();
+    QString result = value;
+    for (QChar &c : result) {
+        if (c == QLatin1Char('\t') || c == QLatin1Char('\n') || c == QLatin1Char('\r'))
+            c = QLatin1Char(' ');
+    }
+    return result;
+}
+
+int SimpleTypeValidator::Private::compare(const QString &value, double number,
+                                          const Bound &bound) const
+{
+    if (mNumberKind == FloatingPoint)
+        return compareDoubles(number, bound.number);
+    return compareDecimals(value, bound.lexical);
+}
+
+static bool fail(QString *errorMessage, const QString &message)
+{
+    if (errorMessage)
+        *errorMessage = message;
+    return false;
+}
+
+bool SimpleTypeValidator::Private::validateValue(const QString &value,
+                                                 QString *errorMessage) const
+{
+    int length = value.length();
+    if (mItemValidator) {
+        length = 0;
+        int start = 0;
+        while (start < value.length()) {
+            int end = value.indexOf(QLatin1Char(' '), start);
+            if (end < 0)
+                end = value.length();
+            if (end > start) {
+                ++length;
+                if (!mItemValidator->validate(value.mid(start, end - start), errorMessage))
+                    return false;
+            }
+            start = end + 1;
+        }
+    } else if (!mUnion) {
+        if (!BuiltinTypes::isValid(mBuiltin, value)) {
+            return fail(errorMessage,
+                        QStringLiteral("'%1' is not a valid %2").arg(value, mBuiltinType));
+        }
+        if (mBuiltin == BuiltinTypes::HexBinary)
+            length = value.length() / 2;
+        else if (mBuiltin == BuiltinTypes::Base64Binary)
+            length = base64Length(value);
+    }
+
+    // The built-in type checked the lexical space and the bounds of the integer types
+    double number = 0;
+    if (mNumberKind == FloatingPoint)
+        BuiltinTypes::toDouble(value, &number);
+    int totalDigits = 0;
+    int fractionDigits = 0;
+    if (mCountDigits)
+        countDigits(value, &totalDigits, &fractionDigits);
+
+    for (const Facets &facets : mFacets) {
+        const int mask = facets.mask;
+        if ((mask & SimpleType::LENGTH) && length != facets.length)
+            return fail(errorMessage, QStringLiteral("length of '%1' is not %2")
+                                              .arg(value).arg(facets.length));
+        if ((mask & SimpleType::MINLEN) && length < facets.minLength)
+            return fail(errorMessage, QStringLiteral("'%1' is shorter than %2")
+                                              .arg(value).arg(facets.minLength));
+        if ((mask & SimpleType::MAXLEN) && length > facets.maxLength)
+            return fail(errorMessage, QStringLiteral("'%1' is longer than %2")
+                                              .arg(value).arg(facets.maxLength));
+        if ((mask & SimpleType::ENUM) && !facets.enums.contains(value))
+            return fail(errorMessage,
+                        QStringLiteral("'%1' is not one of the enumerated values").arg(value));
+        if ((mask & SimpleType::PATTERN) && !facets.pattern.match(value).hasMatch())
+            return fail(errorMessage, QStringLiteral("'%1' does not match the pattern %2")
+                                              .arg(value, facets.pattern.pattern()));
+        if (mask & SimpleType::MININC) {
+            const int result = compare(value, number, facets.minInclusive);
+            if (result != 0 && result != 1)
+                return fail(errorMessage, QStringLiteral("%1 is less than %2")
+                                                  .arg(value, facets.minInclusive.lexical));
+        }
+        if (mask & SimpleType::MAXINC) {
+            const int result = compare(value, number, facets.maxInclusive);
+            if (result != 0 && result != -1)
+                return fail(errorMessage, QStringLiteral("%1 is greater than %2")
+                                                  .arg(value, facets.maxInclusive.lexical));
+        }
+        if ((mask & SimpleType::MINEX) && compare(value, number, facets.minExclusive) != 1)
+            return fail(errorMessage, QStringLiteral("%1 is not greater than %2")
+                                              .arg(value, facets.minExclusive.lexical));
+        if ((mask & SimpleType::MAXEX) && compare(value, number, facets.maxExclusive) != -1)
+            return fail(errorMessage, QStringLiteral("%1 is not less than %2")
+                                              .arg(value, facets.maxExclusive.lexical));
+        if ((mask & SimpleType::TOT) && totalDigits > facets.totalDigits)
+            return fail(errorMessage, QStringLiteral("%1 has more than %2 digits")
+                                              .arg(value).arg(facets.totalDigits));
+        if ((mask & SimpleType::FRAC) && fractionDigits > facets.fractionDigits)
+            return fail(errorMessage, QStringLiteral("%1 has more than %2 fraction digits")
+                                              .arg(value).arg(facets.fractionDigits));
+    }
+    return true;
+}
+
+SimpleTypeValidator::SimpleTypeValidator() : d(new Private) {}
+
+SimpleTypeValidator::SimpleTypeValidator(const SimpleType &type, const Types &types)
+    : d(new Private)
+{
+    const int rangeFacets = SimpleType::MININC | SimpleType::MAXINC | SimpleType::MINEX
+            | SimpleType::MAXEX | SimpleType::TOT | SimpleType::FRAC;
+    bool whiteSpaceSet = false;
+
+    // Walk up the derivation chain, the types from the schemas are in types
+    SimpleType current = type;
+    for (int depth = 0; depth < 32; ++depth) {
+        if (current.subType() == SimpleType::TypeUnion) {
+            d->mUnion = true;
+        } else if (current.subType() == SimpleType::TypeList && !d->mItemValidator) {
+            const QName itemTypeName = current.listTypeName();
+            SimpleType itemType = types.simpleType(itemTypeName);
+            if (itemType.isNull()) {
+                itemType = SimpleType(itemTypeName.nameSpace());
+                itemType.setBaseTypeName(itemTypeName);
+            }
+            d->mItemValidator = std::make_shared<const SimpleTypeValidator>(itemType, types);
+        }
+
+        const int mask = current.facetType();
+        if (mask != SimpleType::NONE) {
+            Facets facets;
+            facets.mask = mask;
+            // Only the facets in the mask have a value
+            if (mask & SimpleType::LENGTH)
+                facets.length = current.facetLength();
+            if (mask & SimpleType::MINLEN)
+                facets.minLength = current.facetMinimumLength();
+            if (mask & SimpleType::MAXLEN)
+                facets.maxLength = current.facetMaximumLength();
+            if (mask & SimpleType::MININC)
+                facets.minInclusive.lexical = current.facetRangeValue(SimpleType::MININC);
+            if (mask & SimpleType::MAXINC)
+                facets.maxInclusive.lexical = current.facetRangeValue(SimpleType::MAXINC);
+            if (mask & SimpleType::MINEX)
+                facets.minExclusive.lexical = current.facetRangeValue(SimpleType::MINEX);
+            if (mask & SimpleType::MAXEX)
+                facets.maxExclusive.lexical = current.facetRangeValue(SimpleType::MAXEX);
+            if (mask & SimpleType::TOT)
+                facets.totalDigits = current.facetTotalDigits();
+            if (mask & SimpleType::FRAC)
+                facets.fractionDigits = current.facetFractionDigits();
+            if (mask & SimpleType::PATTERN) {
+                facets.pattern.setPattern(compilePattern(current.facetPattern()));
+                facets.pattern.optimize();
+                if (!facets.pattern.isValid()) {
+                    qWarning() << "Invalid pattern" << current.facetPattern() << "in"
+                               << current.qualifiedName().qname();
+                    facets.mask &= ~SimpleType::PATTERN;
+                }
+            }
+            if (mask & SimpleType::ENUM) {
+                const QStringList enums = current.facetEnums();
+                facets.enums.reserve(enums.count());
+                for (const QString &value : enums)
+                    facets.enums.insert(value);
+            }
+            // The most derived whitespace facet applies
+            if ((mask & SimpleType::WSP) && !whiteSpaceSet) {
+                d->mWhiteSpace = current.facetWhiteSpace();
+                whiteSpaceSet = true;
+            }
+            d->mFacets.append(facets);
+        }
+
+        // The member types of a union are not known, only the facets of the types
+        // derived from it are checked
+        if (d->mUnion)
+            break;
+
+        const QName baseTypeName = current.baseTypeName();
+        if (baseTypeName.isEmpty() || baseTypeName == current.qualifiedName())
+            break;
+        const SimpleType base = types.simpleType(baseTypeName);
+        if (base.isNull()) {
+            if (baseTypeName.nameSpace() == XMLSchemaURI)
+                d->mBuiltinType = baseTypeName.localName();
+            break;
+        }
+        current = base;
+    }
+
+    d->mBuiltin = BuiltinTypes::type(d->mBuiltinType);
+    // The range and digit facets are only checked for the numeric built-in types, their
+    // bounds must be in the value space of the type
+    d->mNumberKind = d->mItemValidator ? NotNumeric : numberKind(d->mBuiltin);
+    const BuiltinTypes::Type boundType =
+            d->mNumberKind == FloatingPoint ? BuiltinTypes::Double : BuiltinTypes::Decimal;
+    for (Facets &facets : d->mFacets) {
+        if (d->mNumberKind == NotNumeric)
+            facets.mask &= ~rangeFacets;
+        else if (d->mNumberKind == FloatingPoint)
+            facets.mask &= ~(SimpleType::TOT | SimpleType::FRAC);
+        const struct
+        {
+            SimpleType::FacetType facet;
+            Bound *bound;
+        } bounds[] = { { SimpleType::MININC, &facets.minInclusive },
+                       { SimpleType::MAXINC, &facets.maxInclusive },
+                       { SimpleType::MINEX, &facets.minExclusive },
+                       { SimpleType::MAXEX, &facets.maxExclusive } };
+        for (const auto &bound : bounds) {
+            if (!(facets.mask & bound.facet))
+                continue;
+            bound.bound->lexical = bound.bound->lexical.simplified();
+            if (!BuiltinTypes::isValid(boundType, bound.bound->lexical)) {
+                qWarning() << "Invalid bound" << bound.bound->lexical << "for"
+                           << d->mBuiltinType;
+                facets.mask &= ~bound.facet;
+            } else if (d->mNumberKind == FloatingPoint) {
+                BuiltinTypes::toDouble(bound.bound->lexical, &bound.bound->number);
+            }
+        }
+        if (facets.mask & (SimpleType::TOT | SimpleType::FRAC))
+            d->mCountDigits = true;
+    }
+    // Lists and all built-in types but strings collapse their whitespace
+    if (d->mItemValidator) {
+        d->mWhiteSpace = SimpleType::COLLAPSE;
+    } else if (!whiteSpaceSet) {
+        if (d->mBuiltinType.isEmpty() || d->mBuiltinType == QLatin1String("string"))
+            d->mWhiteSpace = SimpleType::PRESERVE;
+        else if (d->mBuiltinType == QLatin1String("normalizedString"))
+            d->mWhiteSpace = SimpleType::REPLACE;
+        else
+            d->mWhiteSpace = SimpleType::COLLAPSE;
+    }
+}
+
+SimpleTypeValidator::SimpleTypeValidator(const SimpleTypeValidator &other) : d(new Private)
+{
+    *d = *other.d;
+}
+
+SimpleTypeValidator::SimpleTypeValidator(SimpleTypeValidator &&other) = default;
+
+SimpleTypeValidator::~SimpleTypeValidator() = default;
+
+SimpleTypeValidator &SimpleTypeValidator::operator=(const SimpleTypeValidator &other)
+{
+    if (this == &other) {
+        return *this;
+    }
+
+    // A moved-from validator has no private data
+    if (d)
+        *d = *other.d;
+    else
+        d.reset(new Private(*other.d));
+
+    return *this;
+}
+
+SimpleTypeValidator &SimpleTypeValidator::operator=(SimpleTypeValidator &&other) noexcept = default;
+
+QString SimpleTypeValidator::builtinType() const
+{
+    return d->mBuiltinType;
+}
+
+bool SimpleTypeValidator::validate(const QString &value, QString *errorMessage) const
+{
+    return d->validateValue(d->normalized(value), errorMessage);
+}
+
+}
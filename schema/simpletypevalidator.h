@@ -0,0 +1,66 @@
+/*
+    This file is part of KDE Schema Parser
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Library General Public
+    License as published by the Free Software Foundation; either
+    version 2 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Library General Public License for more details.
+
+    You should have received a copy of the GNU Library General Public License
+    along with this library; see the file COPYING.LIB.  If not, write to
+    the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+    Boston, MA 02110-1301, USA.
+ */
+
+#ifndef SCHEMA_SIMPLETYPEVALIDATOR_H
+#define SCHEMA_SIMPLETYPEVALIDATOR_H
+
+#include "simpletype.h"
+#include "types.h"
+#include <kode_export.h>
+
+#include <memory>
+
+namespace XSD {
+
+// Checks lexical values against the facets of a simple type and of its base
+// types. The facets are compiled once: patterns into regular expressions,
+// enumerations into hash sets. Range and digit facets apply to the numeric
+// built-in types only; decimal and integer bounds are compared exactly.
+// Lists are validated item by item. The member types of unions are not known, so
+// only the facets of the types derived from a union are checked.
+// A validator can be used by several threads at once. A moved-from validator can
+// only be assigned to or destroyed.
+class SCHEMA_EXPORT SimpleTypeValidator
+{
+public:
+    SimpleTypeValidator();
+    // Compiles the facets of @p type and of the base types and list item type
+    // which are defined in @p types, and checks the built-in base type
+    explicit SimpleTypeValidator(const SimpleType &type, const Types &types = Types());
+    SimpleTypeValidator(const SimpleTypeValidator &other);
+    SimpleTypeValidator(SimpleTypeValidator &&other);
+    ~SimpleTypeValidator();
+
+    SimpleTypeValidator &operator=(const SimpleTypeValidator &other);
+    SimpleTypeValidator &operator=(SimpleTypeValidator &&other) noexcept;
+
+    // Name of the built-in XML schema type the type is derived from, if known
+    QString builtinType() const;
+
+    // Returns whether @p value is valid, or sets @p errorMessage and returns false
+    bool validate(const QString &value, QString *errorMessage = nullptr) const;
+
+private:
+    class Private;
+    std::unique_ptr<Private> d;
+};
+
+}
+
+#endif
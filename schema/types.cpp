@@ -22,9 +22,102 @@
 #include "types.h"
 
 #include <QDebug>
+#include <QHash>
+#include <QMultiHash>
+#include <QVector>
+
+#include <memory>
 
 namespace XSD {
 
+/**
+ * The derivation hierarchy of the complex types, built once on demand.
+ * Types are identified by their position in the list of complex types.
+ */
+class TypeHierarchy
+{
+public:
+    explicit TypeHierarchy(const ComplexType::List &complexTypes,
+                           const QHash<QName, int> &complexTypeIndex);
+
+    QVector<int> mParent; // base type or -1
+    QVector<int> mDepth;
+    QVector<int> mPolymorphicRoot; // nearest polymorphic base class, or -1
+    QVector<QVector<int>> mChildren;
+    // Position in depth-first order; the types derived from a type are
+    // mOrder[mFirst[id] + 1] up to mOrder[mEnd[id] - 1]
+    QVector<int> mFirst;
+    QVector<int> mEnd;
+    QVector<int> mOrder;
+};
+
+TypeHierarchy::TypeHierarchy(const ComplexType::List &complexTypes,
+                             const QHash<QName, int> &complexTypeIndex)
+{
+    const int count = complexTypes.count();
+    mParent.fill(-1, count);
+    mDepth.fill(0, count);
+    mPolymorphicRoot.fill(-1, count);
+    mChildren.resize(count);
+    mFirst.fill(-1, count);
+    mEnd.fill(-1, count);
+    mOrder.reserve(count);
+
+    for (int id = 0; id < count; ++id) {
+        const QName baseTypeName = complexTypes.at(id).baseTypeName();
+        if (baseTypeName.isEmpty())
+            continue;
+        const int parent = complexTypeIndex.value(baseTypeName, -1);
+        if (parent >= 0 && parent != id) {
+            mParent[id] = parent;
+            mChildren[parent].append(id);
+        }
+    }
+
+    // Depth-first traversal from the roots. Types which are only reachable through
+    // a derivation cycle (invalid schema) are cut loose and treated as roots.
+    // The walk up to the root marks the types with the start of the walk, so the
+    // marks never need to be cleared; every walk ends in a tree visited right after.
+    QVector<QPair<int, int>> stack; // type and index of its next child
+    QVector<int> walk(count, -1);
+    for (int start = 0; start < count; ++start) {
+        if (mFirst.at(start) >= 0)
+            continue;
+        int root = start;
+        while (mParent.at(root) >= 0 && walk.at(mParent.at(root)) != start) {
+            walk[root] = start;
+            root = mParent.at(root);
+        }
+        if (mParent.at(root) >= 0) {
+            mChildren[mParent.at(root)].removeOne(root);
+            mParent[root] = -1;
+        }
+
+        mFirst[root] = mOrder.count();
+        mOrder.append(root);
+        mDepth[root] = 0;
+        mPolymorphicRoot[root] = complexTypes.at(root).isPolymorphicBaseClass() ? root : -1;
+        stack.append(qMakePair(root, 0));
+        while (!stack.isEmpty()) {
+            const int id = stack.last().first;
+            const int childIndex = stack.last().second++;
+            if (childIndex >= mChildren.at(id).count()) {
+                mEnd[id] = mOrder.count();
+                stack.removeLast();
+                continue;
+            }
+            const int child = mChildren.at(id).at(childIndex);
+            mFirst[child] = mOrder.count();
+            mOrder.append(child);
+            mDepth[child] = mDepth.at(id) + 1;
+            mPolymorphicRoot[child] = complexTypes.at(child).isPolymorphicBaseClass()
+                    ? child
+                    : mPolymorphicRoot.at(id);
+            stack.append(qMakePair(child, 0));
+        }
+    }
+}
+
 class Types::Private
 {
 public:
@@ -32,17 +125,72 @@ public:
     ComplexType::List mComplexTypes;
     Element::List mElements;
     Attribute::List mAttributes;
+
+    // Index of the first simple type of each name, and of each name and element name
+    QHash<QName, int> mSimpleTypeIndex;
+    QHash<QPair<QName, QString>, int> mSimpleTypeElementIndex;
+
+    void indexSimpleTypes(int from);
+
+    // Index of the first complex type of each name
+    QHash<QName, int> mComplexTypeIndex;
+    // Shared between copies, as it is immutable
+    mutable std::shared_ptr<const TypeHierarchy> mHierarchy;
+
+    void indexComplexTypes(int from);
+    const TypeHierarchy &hierarchy() const;
+
+    bool mFrozen = false;
 #if 0
     AttributeGroup::List mAttributeGroups;
     Group::List mGroups;
 #endif
 };
 
+void Types::Private::indexSimpleTypes(int from)
+{
+    if (from == 0) {
+        mSimpleTypeIndex.clear();
+        mSimpleTypeElementIndex.clear();
+    }
+
+    for (int i = from; i < mSimpleTypes.count(); ++i) {
+        const SimpleType &type = mSimpleTypes.at(i);
+        const QName name = type.qualifiedName();
+        if (!mSimpleTypeIndex.contains(name))
+            mSimpleTypeIndex.insert(name, i);
+        const QPair<QName, QString> key(name, type.elementName());
+        if (!mSimpleTypeElementIndex.contains(key))
+            mSimpleTypeElementIndex.insert(key, i);
+    }
+}
+
+void Types::Private::indexComplexTypes(int from)
+{
+    if (from == 0)
+        mComplexTypeIndex.clear();
+
+    for (int i = from; i < mComplexTypes.count(); ++i) {
+        const QName name = mComplexTypes.at(i).qualifiedName();
+        if (!mComplexTypeIndex.contains(name))
+            mComplexTypeIndex.insert(name, i);
+    }
+    mHierarchy.reset();
+}
+
+const TypeHierarchy &Types::Private::hierarchy() const
+{
+    if (!mHierarchy)
+        mHierarchy = std::make_shared<const TypeHierarchy>(mComplexTypes, mComplexTypeIndex);
+    return *mHierarchy;
+}
+
 Types::Types() : d(new Private) {}
 
 Types::Types(const Types &other) : d(new Private)
 {
     *d = *other.d;
+    d->mFrozen = false;
 }
 
 Types::Types(Types &&other) : d(std::move(other.d)) {}
@@ -55,7 +203,9 @@ Types &Types::operator=(const Types &other)
         return *this;
     }
 
+    Q_ASSERT_X(!d->mFrozen, "Types", "frozen types must not be modified");
     *d = *other.d;
+    d->mFrozen = false;
 
     return *this;
 }
@@ -67,9 +217,14 @@ Types &Types::operator+=(const Types &other)
     if (this == &other) {
         return *this;
     }
+    Q_ASSERT_X(!d->mFrozen, "Types", "frozen types must not be modified");
 
+    const int simpleTypeCount = d->mSimpleTypes.count();
     d->mSimpleTypes += other.d->mSimpleTypes;
+    d->indexSimpleTypes(simpleTypeCount);
+    const int complexTypeCount = d->mComplexTypes.count();
     d->mComplexTypes += other.d->mComplexTypes;
+    d->indexComplexTypes(complexTypeCount);
     d->mElements += other.d->mElements;
     d->mAttributes += other.d->mAttributes;
     // unused d->mAttributeGroups += other.d->mAttributeGroups;
@@ -80,7 +235,9 @@ Types &Types::operator+=(const Types &other)
 
 void Types::setSimpleTypes(const SimpleType::List &simpleTypes)
 {
+    Q_ASSERT_X(!d->mFrozen, "Types", "frozen types must not be modified");
     d->mSimpleTypes = simpleTypes;
+    d->indexSimpleTypes(0);
 }
 
 SimpleType::List Types::simpleTypes() const
@@ -90,7 +247,9 @@ SimpleType::List Types::simpleTypes() const
 
 void Types::setComplexTypes(const ComplexType::List &complexTypes)
 {
+    Q_ASSERT_X(!d->mFrozen, "Types", "frozen types must not be modified");
     d->mComplexTypes = complexTypes;
+    d->indexComplexTypes(0);
 }
 
 ComplexType::List Types::complexTypes() const
@@ -100,6 +259,7 @@ ComplexType::List Types::complexTypes() const
 
 void Types::setElements(const Element::List &elements)
 {
+    Q_ASSERT_X(!d->mFrozen, "Types", "frozen types must not be modified");
     d->mElements = elements;
 }
 
@@ -110,6 +270,7 @@ Element::List Types::elements() const
 
 void Types::setAttributes(const Attribute::List &attributes)
 {
+    Q_ASSERT_X(!d->mFrozen, "Types", "frozen types must not be modified");
     d->mAttributes = attributes;
 }
 
@@ -147,7 +308,10 @@ ComplexType Types::complexType(const Element &element) const
 
 ComplexType Types::complexType(const QName &typeName) const
 {
-    return d->mComplexTypes.complexType(typeName);
+    const auto it = d->mComplexTypeIndex.constFind(typeName);
+    if (it == d->mComplexTypeIndex.constEnd())
+        return ComplexType();
+    return d->mComplexTypes.at(it.value());
 }
 
 ComplexType Types::polymorphicBaseClass(const ComplexType &derivedType) const
@@ -155,24 +319,229 @@ ComplexType Types::polymorphicBaseClass(const ComplexType &derivedType) const
     if (derivedType.isPolymorphicBaseClass()) {
         return derivedType;
     }
-    ComplexType base = complexType(derivedType.baseTypeName());
-    if (!base.isNull()) {
-        return polymorphicBaseClass(base); // recurse
+    const int base = d->mComplexTypeIndex.value(derivedType.baseTypeName(), -1);
+    if (base >= 0) {
+        const int root = d->hierarchy().mPolymorphicRoot.at(base);
+        if (root >= 0)
+            return d->mComplexTypes.at(root);
     }
     return ComplexType();
 }
 
-SimpleType Types::simpleType(const QName &simpleTypeName, const QString &elementFilter) const
+QName::List Types::derivedTypes(const QName &baseTypeName, bool transitive) const
 {
-    if (elementFilter.isEmpty())
-        return d->mSimpleTypes.simpleType(simpleTypeName);
+    QName::List result;
+    const int base = d->mComplexTypeIndex.value(baseTypeName, -1);
+    if (base < 0)
+        return result;
+
+    const TypeHierarchy &hierarchy = d->hierarchy();
+    if (transitive) {
+        for (int i = hierarchy.mFirst.at(base) + 1; i < hierarchy.mEnd.at(base); ++i)
+            result.append(d->mComplexTypes.at(hierarchy.mOrder.at(i)).qualifiedName());
+    } else {
+        for (int child : hierarchy.mChildren.at(base))
+            result.append(d->mComplexTypes.at(child).qualifiedName());
+    }
+    return result;
+}
+
+bool Types::isDerivedFrom(const QName &typeName, const QName &baseTypeName) const
+{
+    const int type = d->mComplexTypeIndex.value(typeName, -1);
+    const int base = d->mComplexTypeIndex.value(baseTypeName, -1);
+    if (type < 0 || base < 0 || type == base)
+        return false;
+
+    const TypeHierarchy &hierarchy = d->hierarchy();
+    const int position = hierarchy.mFirst.at(type);
+    return position > hierarchy.mFirst.at(base) && position < hierarchy.mEnd.at(base);
+}
+
+int Types::derivationDepth(const QName &typeName) const
+{
+    const int type = d->mComplexTypeIndex.value(typeName, -1);
+    if (type < 0)
+        return -1;
+    return d->hierarchy().mDepth.at(type);
+}
+
+Types Types::reachableFrom(const QName::List &roots) const
+{
+    QMultiHash<QName, int> simpleTypesByName;
+    for (int i = 0; i < d->mSimpleTypes.count(); ++i)
+        simpleTypesByName.insert(d->mSimpleTypes.at(i).qualifiedName(), i);
+    QMultiHash<QName, int> complexTypesByName;
+    for (int i = 0; i < d->mComplexTypes.count(); ++i)
+        complexTypesByName.insert(d->mComplexTypes.at(i).qualifiedName(), i);
+    QMultiHash<QName, int> elementsByName;
+    for (int i = 0; i < d->mElements.count(); ++i)
+        elementsByName.insert(d->mElements.at(i).qualifiedName(), i);
+    QMultiHash<QName, int> attributesByName;
+    for (int i = 0; i < d->mAttributes.count(); ++i)
+        attributesByName.insert(d->mAttributes.at(i).qualifiedName(), i);
+
+    QVector<bool> simpleTypeUsed(d->mSimpleTypes.count(), false);
+    QVector<bool> complexTypeUsed(d->mComplexTypes.count(), false);
+    QVector<bool> elementUsed(d->mElements.count(), false);
+    QVector<bool> attributeUsed(d->mAttributes.count(), false);
+    QVector<int> simpleTypeQueue;
+    QVector<int> complexTypeQueue;
+
+    auto useType = [&](const QName &name) {
+        if (name.isEmpty())
+            return;
+        for (auto it = complexTypesByName.constFind(name);
+             it != complexTypesByName.constEnd() && it.key() == name; ++it) {
+            if (!complexTypeUsed.at(it.value())) {
+                complexTypeUsed[it.value()] = true;
+                complexTypeQueue.append(it.value());
+            }
+        }
+        for (auto it = simpleTypesByName.constFind(name);
+             it != simpleTypesByName.constEnd() && it.key() == name; ++it) {
+            if (!simpleTypeUsed.at(it.value())) {
+                simpleTypeUsed[it.value()] = true;
+                simpleTypeQueue.append(it.value());
+            }
+        }
+    };
+    auto useElement = [&](const QName &name) {
+        for (auto it = elementsByName.constFind(name);
+             it != elementsByName.constEnd() && it.key() == name; ++it) {
+            if (!elementUsed.at(it.value())) {
+                elementUsed[it.value()] = true;
+                useType(d->mElements.at(it.value()).type());
+            }
+        }
+    };
+    auto useAttribute = [&](const QName &name) {
+        for (auto it = attributesByName.constFind(name);
+             it != attributesByName.constEnd() && it.key() == name; ++it) {
+            if (!attributeUsed.at(it.value())) {
+                attributeUsed[it.value()] = true;
+                useType(d->mAttributes.at(it.value()).type());
+            }
+        }
+    };
+    auto useElements = [&](const Element::List &elements) {
+        for (const Element &element : elements) {
+            if (!element.reference().isEmpty())
+                useElement(element.reference());
+            useType(element.type());
+        }
+    };
+    auto useAttributes = [&](const Attribute::List &attributes) {
+        for (const Attribute &attribute : attributes) {
+            if (!attribute.reference().isEmpty())
+                useAttribute(attribute.reference());
+            useType(attribute.type());
+        }
+    };
+
+    for (const QName &root : roots) {
+        useElement(root);
+        useType(root);
+    }
+
+    // Derived types are used because instances of them can appear wherever the base
+    // type is expected; the elements substituting a head element are found via them.
+    const TypeHierarchy &hierarchy = d->hierarchy();
+    while (!complexTypeQueue.isEmpty() || !simpleTypeQueue.isEmpty()) {
+        if (!complexTypeQueue.isEmpty()) {
+            const int id = complexTypeQueue.takeLast();
+            const ComplexType &type = d->mComplexTypes.at(id);
+            useType(type.baseTypeName());
+            useType(type.arrayType());
+            useElements(type.elements());
+            for (const Group &group : type.groups())
+                useElements(group.elements());
+            useAttributes(type.attributes());
+            for (const AttributeGroup &group : type.attributeGroups())
+                useAttributes(group.attributes());
+            if (!type.substitutionElementName().isEmpty())
+                useElement(type.substitutionElementName());
+            for (int child : hierarchy.mChildren.at(id)) {
+                if (!complexTypeUsed.at(child)) {
+                    complexTypeUsed[child] = true;
+                    complexTypeQueue.append(child);
+                }
+            }
+        } else {
+            const SimpleType &type = d->mSimpleTypes.at(simpleTypeQueue.takeLast());
+            useType(type.baseTypeName());
+            useType(type.listTypeName());
+            if (!type.substitutionElementName().isEmpty())
+                useElement(type.substitutionElementName());
+        }
+    }
 
-    for (auto type : std::as_const(d->mSimpleTypes)) {
-        if (type.qualifiedName() == simpleTypeName && elementFilter == type.elementName())
-            return type;
+    SimpleType::List simpleTypes;
+    for (int i = 0; i < d->mSimpleTypes.count(); ++i) {
+        if (simpleTypeUsed.at(i))
+            simpleTypes.append(d->mSimpleTypes.at(i));
     }
+    ComplexType::List complexTypes;
+    for (int i = 0; i < d->mComplexTypes.count(); ++i) {
+        if (complexTypeUsed.at(i))
+            complexTypes.append(d->mComplexTypes.at(i));
+    }
+    Element::List elements;
+    for (int i = 0; i < d->mElements.count(); ++i) {
+        if (elementUsed.at(i))
+            elements.append(d->mElements.at(i));
+    }
+    Attribute::List attributes;
+    for (int i = 0; i < d->mAttributes.count(); ++i) {
+        if (attributeUsed.at(i))
+            attributes.append(d->mAttributes.at(i));
+    }
+
+    Types result;
+    result.setSimpleTypes(simpleTypes);
+    result.setComplexTypes(complexTypes);
+    result.setElements(elements);
+    result.setAttributes(attributes);
+    return result;
+}
+
+MemoryUsage Types::memoryUsage() const
+{
+    MemoryUsage usage;
+    usage.addTypes(*this);
+    return usage;
+}
+
+void Types::freeze()
+{
+    d->hierarchy();
+    // Fill the caches of the types in the list, not of copies
+    for (const ComplexType &type : std::as_const(d->mComplexTypes))
+        type.structuralHash();
+    d->mFrozen = true;
+}
+
+bool Types::isFrozen() const
+{
+    return d->mFrozen;
+}
+
+const SimpleType &Types::simpleType(const QName &simpleTypeName,
+                                    const QString &elementFilter) const
+{
+    static const SimpleType nullType;
+
+    if (elementFilter.isEmpty()) {
+        const auto it = d->mSimpleTypeIndex.constFind(simpleTypeName);
+        return it == d->mSimpleTypeIndex.constEnd() ? nullType : d->mSimpleTypes.at(it.value());
+    }
+
+    const auto it =
+            d->mSimpleTypeElementIndex.constFind(qMakePair(simpleTypeName, elementFilter));
+    if (it != d->mSimpleTypeElementIndex.constEnd())
+        return d->mSimpleTypes.at(it.value());
     qDebug() << "Simple type not found";
-    return SimpleType();
+    return nullType;
 }
 
 } // namespace XSD
@@ -24,6 +24,7 @@
 
 #include "complextype.h"
 #include "element.h"
+#include "memoryusage.h"
 #include "simpletype.h"
 #include <kode_export.h>
 
@@ -66,8 +67,35 @@ public:
     // i.e. the type for which isPolymorphicBaseClass() returns true
     ComplexType polymorphicBaseClass(const ComplexType &derivedType) const;
 
-    SimpleType simpleType(const QName &simpleTypeName,
-                          const QString &elementFilter = QString()) const;
+    // Returns the complex types derived from @p baseTypeName, in depth-first order.
+    // Only the direct children unless @p transitive is true.
+    QName::List derivedTypes(const QName &baseTypeName, bool transitive = true) const;
+
+    // Returns true if @p typeName is derived from @p baseTypeName, directly or indirectly
+    bool isDerivedFrom(const QName &typeName, const QName &baseTypeName) const;
+
+    // Returns the number of base types above @p typeName, or -1 if it is not a complex type
+    int derivationDepth(const QName &typeName) const;
+
+    // Returns only the types, elements and attributes used by the elements or types
+    // named in @p roots, following element and attribute types and references, base,
+    // array and list types, derived types and substitution groups.
+    Types reachableFrom(const QName::List &roots) const;
+
+    // Returns an estimate of the memory held by the types
+    MemoryUsage memoryUsage() const;
+
+    // Builds all lookup caches up front. Afterwards the const functions don't
+    // modify anything, so frozen types can be read by several threads at once.
+    // Frozen types must not be modified; copies of them are not frozen.
+    void freeze();
+    bool isFrozen() const;
+
+    // Returns the first simple type with the given name, and if @p elementFilter
+    // is set, for that element. Returns a null type if there is none.
+    // The reference is valid until the types are modified.
+    const SimpleType &simpleType(const QName &simpleTypeName,
+                                 const QString &elementFilter = QString()) const;
 
 private:
     class Private;
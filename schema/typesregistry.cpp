@@ -0,0 +1,56 @@
+/*
+    This file is part of KDE Schema Parser
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Library General Public
+    License as published by the Free Software Foundation; either
+    version 2 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Library General Public License for more details.
+
+    You should have received a copy of the GNU Library General Public License
+    along with this library; see the file COPYING.LIB.  If not, write to
+    the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+    Boston, MA 02110-1301, USA.
+ */
+
+#include "typesregistry.h"
+
+#include <atomic>
+
+namespace XSD {
+
+class TypesRegistry::Private
+{
+public:
+    // Only accessed with std::atomic_load() and std::atomic_store()
+    Snapshot mSnapshot;
+    std::atomic<quint64> mGeneration{ 0 };
+};
+
+TypesRegistry::TypesRegistry() : d(new Private) {}
+
+TypesRegistry::~TypesRegistry() = default;
+
+void TypesRegistry::publish(Types types)
+{
+    types.freeze();
+    Snapshot snapshot = std::make_shared<const Types>(std::move(types));
+    std::atomic_store(&d->mSnapshot, std::move(snapshot));
+    d->mGeneration.fetch_add(1, std::memory_order_release);
+}
+
+TypesRegistry::Snapshot TypesRegistry::acquire() const
+{
+    return std::atomic_load(&d->mSnapshot);
+}
+
+quint64 TypesRegistry::generation() const
+{
+    return d->mGeneration.load(std::memory_order_acquire);
+}
+
+}
@@ -0,0 +1,60 @@
+/*
+    This file is part of KDE Schema Parser
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Library General Public
+    License as published by the Free Software Foundation; either
+    version 2 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Library General Public License for more details.
+
+    You should have received a copy of the GNU Library General Public License
+    along with this library; see the file COPYING.LIB.  If not, write to
+    the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+    Boston, MA 02110-1301, USA.
+ */
+
+#ifndef SCHEMA_TYPESREGISTRY_H
+#define SCHEMA_TYPESREGISTRY_H
+
+#include "types.h"
+#include <kode_export.h>
+
+#include <memory>
+
+namespace XSD {
+
+// Holds the current snapshot of a set of types, which can be replaced while
+// other threads read it. Readers keep using the snapshot they acquired until
+// they drop it, so a reload never blocks them and never changes types under
+// their feet. Publishing and acquiring are lock-free where the platform
+// supports atomic shared pointers.
+class SCHEMA_EXPORT TypesRegistry
+{
+public:
+    typedef std::shared_ptr<const Types> Snapshot;
+
+    TypesRegistry();
+    ~TypesRegistry();
+
+    // Freezes @p types and makes them the current snapshot
+    void publish(Types types);
+
+    // Returns the current snapshot, which is null before the first publish()
+    Snapshot acquire() const;
+
+    // Number of snapshots published so far
+    quint64 generation() const;
+
+private:
+    Q_DISABLE_COPY(TypesRegistry)
+    class Private;
+    std::unique_ptr<Private> d;
+};
+
+}
+
+#endif
@@ -20,10 +20,11 @@
  */
 
 #include "xmlelement.h"
+#include "arena.h"
 
 namespace XSD {
 
-class XmlElement::Private
+class XmlElement::Private : public ArenaAllocated
 {
 public:
     QString mName;
@@ -21,10 +21,11 @@
  */
 
 #include "xsdtype.h"
+#include "arena.h"
 
 namespace XSD {
 
-class XSDType::Private
+class XSDType::Private : public ArenaAllocated
 {
 public:
     Private() : mContentModel(SIMPLE), mSubstitutionElementName() {}